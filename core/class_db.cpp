@@ -526,6 +526,15 @@ void ClassDB::add_compatibility_class(const StringName &p_class, const StringNam
 
 Object *ClassDB::instance(const StringName &p_class) {
 
+	CreationFunc creation_func = get_creation_func(p_class);
+	if (!creation_func)
+		return NULL;
+
+	return creation_func();
+}
+
+ClassDB::CreationFunc ClassDB::get_creation_func(const StringName &p_class) {
+
 	ClassInfo *ti;
 	{
 		OBJTYPE_RLOCK;
@@ -545,7 +554,7 @@ Object *ClassDB::instance(const StringName &p_class) {
 		return NULL;
 	}
 #endif
-	return ti->creation_func();
+	return ti->creation_func;
 }
 bool ClassDB::can_instance(const StringName &p_class) {
 
@@ -972,6 +981,10 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
 	psg.index = p_index;
 	psg.type = p_pinfo.type;
 
+	// lets Object::call() journal setter calls made by name
+	if (mb_set && p_index < 0)
+		mb_set->set_setter_property(p_pinfo.name);
+
 	type->property_setget[p_pinfo.name] = psg;
 }
 
@@ -1020,6 +1033,10 @@ bool ClassDB::set_property(Object *p_object, const StringName &p_property, const
 				return true; //return true but do nothing
 			}
 
+			// scripts assign native members through here, bypassing Object::set
+			if (unlikely(p_object->is_change_tracking()))
+				p_object->mark_property_changed(p_property);
+
 			Variant::CallError ce;
 
 			if (psg->index >= 0) {
@@ -220,8 +220,11 @@ public:
 	static StringName get_parent_class(const StringName &p_class);
 	static bool class_exists(const StringName &p_class);
 	static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
+	typedef Object *(*CreationFunc)();
+
 	static bool can_instance(const StringName &p_class);
 	static Object *instance(const StringName &p_class);
+	static CreationFunc get_creation_func(const StringName &p_class);
 	static APIType get_api_type(const StringName &p_class);
 
 	static uint64_t get_api_hash(APIType p_api);
@@ -0,0 +1,515 @@
+/*************************************************************************/
+/*  compact_hash_map.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef COMPACT_HASH_MAP_H
+#define COMPACT_HASH_MAP_H
+
+#include "core/hashfuncs.h"
+#include "core/os/copymem.h"
+#include "core/os/memory.h"
+
+/**
+ * An insertion-ordered HashMap with open addressing, laid out like the
+ * compact dict of CPython.
+ *
+ * Entries (cached hash, key and value) are stored in a dense array in the
+ * order they were inserted, iterating is a linear walk over it. The hash
+ * table itself is a power of two sized array of 32 bit indices into the
+ * entries, so probing touches a few bytes per slot and only the entries
+ * whose cached hash matches are compared. Adding an element costs no
+ * allocation unless the arrays have to grow.
+ *
+ * Erasing an element destructs it and leaves a hole in the entries, which
+ * iteration skips. Holes are squeezed out the next time the entries array
+ * is full, keeping the order of the remaining elements.
+ *
+ * Keys and values are relocated bitwise when the arrays grow, like in
+ * CowData, so Elements and pointers to values are invalidated by inserting.
+ */
+template <class TKey, class TValue,
+		class Hasher = HashMapHasherDefault,
+		class Comparator = HashMapComparatorDefault<TKey> >
+class CompactHashMap {
+
+	struct Entry {
+		uint32_t hash; // ERASED_HASH once the entry was erased
+		TKey key;
+		TValue value;
+	};
+
+	static const uint32_t ERASED_HASH = 0;
+	static const uint32_t EMPTY_INDEX = 0xFFFFFFFF;
+	static const uint32_t DUMMY_INDEX = 0xFFFFFFFE; // slot of an erased entry, keeps probe chains intact
+	static const uint32_t MIN_INDEX_CAPACITY = 8;
+
+	Entry *entries;
+	uint32_t *indices;
+
+	uint32_t num_entries; // used entries, holes included
+	uint32_t entry_capacity;
+	uint32_t index_mask;
+	uint32_t num_elements;
+
+	_FORCE_INLINE_ static uint32_t _usable(uint32_t p_index_capacity) {
+		// keep the table at most two thirds full, so probe chains stay short
+		return (p_index_capacity << 1) / 3;
+	}
+
+	_FORCE_INLINE_ static uint32_t _hash(const TKey &p_key) {
+		uint32_t hash = Hasher::hash(p_key);
+		return hash == ERASED_HASH ? ERASED_HASH + 1 : hash;
+	}
+
+	_FORCE_INLINE_ static uint32_t _next_slot(uint32_t p_slot, uint32_t &r_perturb, uint32_t p_mask) {
+		// same recurrence as CPython, all bits of the hash end up in the probe sequence
+		r_perturb >>= 5;
+		return (p_slot * 5 + r_perturb + 1) & p_mask;
+	}
+
+	// Returns the index slot holding p_key, or the one to store it in.
+	uint32_t _lookup_slot(const TKey &p_key, uint32_t p_hash, bool &r_found) const {
+
+		uint32_t slot = p_hash & index_mask;
+		uint32_t perturb = p_hash;
+		uint32_t free_slot = EMPTY_INDEX;
+
+		while (true) {
+			uint32_t index = indices[slot];
+			if (index == EMPTY_INDEX) {
+				r_found = false;
+				return free_slot != EMPTY_INDEX ? free_slot : slot;
+			}
+			if (index == DUMMY_INDEX) {
+				if (free_slot == EMPTY_INDEX)
+					free_slot = slot;
+			} else if (entries[index].hash == p_hash && Comparator::compare(entries[index].key, p_key)) {
+				r_found = true;
+				return slot;
+			}
+			slot = _next_slot(slot, perturb, index_mask);
+		}
+	}
+
+	_FORCE_INLINE_ int32_t _find_entry(const TKey &p_key) const {
+
+		if (!num_elements)
+			return -1;
+
+		bool found;
+		uint32_t slot = _lookup_slot(p_key, _hash(p_key), found);
+		return found ? (int32_t)indices[slot] : -1;
+	}
+
+	void _build_indices() {
+
+		for (uint32_t i = 0; i <= index_mask; i++) {
+			indices[i] = EMPTY_INDEX;
+		}
+		for (uint32_t i = 0; i < num_entries; i++) {
+			uint32_t slot = entries[i].hash & index_mask;
+			uint32_t perturb = entries[i].hash;
+			while (indices[slot] != EMPTY_INDEX) {
+				slot = _next_slot(slot, perturb, index_mask);
+			}
+			indices[slot] = i;
+		}
+	}
+
+	// Squeezes out the holes and resizes both arrays to hold at least p_min_elements.
+	void _rebuild(uint32_t p_min_elements) {
+
+		uint32_t index_capacity = MIN_INDEX_CAPACITY;
+		while (_usable(index_capacity) < p_min_elements) {
+			index_capacity <<= 1;
+		}
+
+		uint32_t new_capacity = _usable(index_capacity);
+		Entry *new_entries = static_cast<Entry *>(Memory::alloc_static(sizeof(Entry) * new_capacity));
+
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < num_entries; i++) {
+			if (entries[i].hash == ERASED_HASH)
+				continue;
+			// entries are relocated bitwise, as CowData does with its elements
+			copymem((void *)&new_entries[count], (const void *)&entries[i], sizeof(Entry));
+			count++;
+		}
+
+		if (entries)
+			Memory::free_static(entries);
+		if (indices && index_mask + 1 != index_capacity) {
+			Memory::free_static(indices);
+			indices = NULL;
+		}
+		if (!indices)
+			indices = static_cast<uint32_t *>(Memory::alloc_static(sizeof(uint32_t) * index_capacity));
+
+		entries = new_entries;
+		entry_capacity = new_capacity;
+		index_mask = index_capacity - 1;
+		num_entries = count;
+
+		_build_indices();
+	}
+
+	uint32_t _insert(const TKey &p_key, const TValue &p_value) {
+
+		uint32_t hash = _hash(p_key);
+		bool found = false;
+		uint32_t slot = 0;
+		if (indices) {
+			slot = _lookup_slot(p_key, hash, found);
+			if (found) {
+				uint32_t index = indices[slot];
+				entries[index].value = p_value;
+				return index;
+			}
+		}
+
+		if (num_entries == entry_capacity) {
+			// grow when mostly full of live elements, otherwise just drop the holes
+			_rebuild(MAX(num_elements * 2, num_elements + 1));
+			slot = _lookup_slot(p_key, hash, found);
+		}
+
+		uint32_t index = num_entries++;
+		Entry &entry = entries[index];
+		entry.hash = hash;
+		memnew_placement(&entry.key, TKey(p_key));
+		memnew_placement(&entry.value, TValue(p_value));
+		indices[slot] = index;
+		num_elements++;
+
+		return index;
+	}
+
+	void _erase_slot(uint32_t p_slot) {
+
+		Entry &entry = entries[indices[p_slot]];
+		entry.hash = ERASED_HASH;
+		entry.key.~TKey();
+		entry.value.~TValue();
+		indices[p_slot] = DUMMY_INDEX;
+		num_elements--;
+	}
+
+	_FORCE_INLINE_ int32_t _next_entry(int32_t p_index) const {
+
+		for (uint32_t i = p_index + 1; i < num_entries; i++) {
+			if (entries[i].hash != ERASED_HASH)
+				return i;
+		}
+		return -1;
+	}
+
+	_FORCE_INLINE_ int32_t _prev_entry(int32_t p_index) const {
+
+		for (int32_t i = p_index - 1; i >= 0; i--) {
+			if (entries[i].hash != ERASED_HASH)
+				return i;
+		}
+		return -1;
+	}
+
+	int32_t _entry_at(int p_position) const {
+
+		if (p_position < 0 || (uint32_t)p_position >= num_elements)
+			return -1;
+		if (num_entries == num_elements)
+			return p_position; // no holes
+		int32_t index = _next_entry(-1);
+		for (int i = 0; i < p_position; i++) {
+			index = _next_entry(index);
+		}
+		return index;
+	}
+
+	void _copy_from(const CompactHashMap &p_map) {
+
+		if (!p_map.num_elements)
+			return;
+		_rebuild(p_map.num_elements);
+		for (uint32_t i = 0; i < p_map.num_entries; i++) {
+			const Entry &from = p_map.entries[i];
+			if (from.hash == ERASED_HASH)
+				continue;
+			Entry &entry = entries[num_entries++];
+			entry.hash = from.hash;
+			memnew_placement(&entry.key, TKey(from.key));
+			memnew_placement(&entry.value, TValue(from.value));
+		}
+		num_elements = num_entries;
+		_build_indices();
+	}
+
+public:
+	class Element {
+		friend class CompactHashMap<TKey, TValue, Hasher, Comparator>;
+
+		CompactHashMap *map;
+		int32_t index;
+
+		Element(CompactHashMap *p_map, int32_t p_index) :
+				map(p_index < 0 ? NULL : p_map),
+				index(p_index) {}
+
+	public:
+		_FORCE_INLINE_ Element() :
+				map(NULL),
+				index(-1) {}
+
+		Element next() const { return Element(map, map ? map->_next_entry(index) : -1); }
+		Element prev() const { return Element(map, map ? map->_prev_entry(index) : -1); }
+
+		_FORCE_INLINE_ bool operator==(const Element &p_other) const { return map == p_other.map && index == p_other.index; }
+		_FORCE_INLINE_ bool operator!=(const Element &p_other) const { return !(*this == p_other); }
+		operator bool() const { return map != NULL; }
+
+		const TKey &key() const {
+			CRASH_COND(!map);
+			return map->entries[index].key;
+		}
+
+		TValue &value() {
+			CRASH_COND(!map);
+			return map->entries[index].value;
+		}
+
+		const TValue &value() const {
+			CRASH_COND(!map);
+			return map->entries[index].value;
+		}
+
+		TValue &get() {
+			CRASH_COND(!map);
+			return map->entries[index].value;
+		}
+
+		const TValue &get() const {
+			CRASH_COND(!map);
+			return map->entries[index].value;
+		}
+	};
+
+	class ConstElement {
+		friend class CompactHashMap<TKey, TValue, Hasher, Comparator>;
+
+		const CompactHashMap *map;
+		int32_t index;
+
+		ConstElement(const CompactHashMap *p_map, int32_t p_index) :
+				map(p_index < 0 ? NULL : p_map),
+				index(p_index) {}
+
+	public:
+		_FORCE_INLINE_ ConstElement() :
+				map(NULL),
+				index(-1) {}
+
+		ConstElement(const Element &p_element) :
+				map(p_element.map),
+				index(p_element.index) {}
+
+		ConstElement next() const { return ConstElement(map, map ? map->_next_entry(index) : -1); }
+		ConstElement prev() const { return ConstElement(map, map ? map->_prev_entry(index) : -1); }
+
+		_FORCE_INLINE_ bool operator==(const ConstElement &p_other) const { return map == p_other.map && index == p_other.index; }
+		_FORCE_INLINE_ bool operator!=(const ConstElement &p_other) const { return !(*this == p_other); }
+		operator bool() const { return map != NULL; }
+
+		const TKey &key() const {
+			CRASH_COND(!map);
+			return map->entries[index].key;
+		}
+
+		const TValue &value() const {
+			CRASH_COND(!map);
+			return map->entries[index].value;
+		}
+
+		const TValue &get() const {
+			CRASH_COND(!map);
+			return map->entries[index].value;
+		}
+	};
+
+	Element find(const TKey &p_key) {
+		return Element(this, _find_entry(p_key));
+	}
+
+	ConstElement find(const TKey &p_key) const {
+		return ConstElement(this, _find_entry(p_key));
+	}
+
+	TValue *getptr(const TKey &p_key) {
+		int32_t index = _find_entry(p_key);
+		return index < 0 ? NULL : &entries[index].value;
+	}
+
+	const TValue *getptr(const TKey &p_key) const {
+		int32_t index = _find_entry(p_key);
+		return index < 0 ? NULL : &entries[index].value;
+	}
+
+	_FORCE_INLINE_ bool has(const TKey &p_key) const {
+		return _find_entry(p_key) >= 0;
+	}
+
+	Element insert(const TKey &p_key, const TValue &p_value) {
+		return Element(this, _insert(p_key, p_value));
+	}
+
+	bool erase(const TKey &p_key) {
+
+		if (!num_elements)
+			return false;
+
+		bool found;
+		uint32_t slot = _lookup_slot(p_key, _hash(p_key), found);
+		if (!found)
+			return false;
+
+		_erase_slot(slot);
+		return true;
+	}
+
+	void erase(Element &p_element) {
+
+		ERR_FAIL_COND(p_element.map != this);
+
+		bool found;
+		const Entry &entry = entries[p_element.index];
+		uint32_t slot = _lookup_slot(entry.key, entry.hash, found);
+		ERR_FAIL_COND(!found);
+
+		_erase_slot(slot);
+		p_element.map = NULL;
+		p_element.index = -1;
+	}
+
+	const TValue &operator[](const TKey &p_key) const {
+		int32_t index = _find_entry(p_key);
+		CRASH_COND(index < 0);
+		return entries[index].value;
+	}
+
+	TValue &operator[](const TKey &p_key) {
+		int32_t index = _find_entry(p_key);
+		if (index < 0) {
+			// consistent with Map behaviour
+			index = _insert(p_key, TValue());
+		}
+		return entries[index].value;
+	}
+
+	// Element at the given position in insertion order, constant time unless elements were erased.
+	Element get_element(int p_position) {
+		return Element(this, _entry_at(p_position));
+	}
+
+	ConstElement get_element(int p_position) const {
+		return ConstElement(this, _entry_at(p_position));
+	}
+
+	_FORCE_INLINE_ Element front() { return Element(this, _next_entry(-1)); }
+	_FORCE_INLINE_ Element back() { return Element(this, _prev_entry(num_entries)); }
+	_FORCE_INLINE_ ConstElement front() const { return ConstElement(this, _next_entry(-1)); }
+	_FORCE_INLINE_ ConstElement back() const { return ConstElement(this, _prev_entry(num_entries)); }
+
+	_FORCE_INLINE_ bool empty() const { return num_elements == 0; }
+	_FORCE_INLINE_ int size() const { return num_elements; }
+
+	const void *id() const {
+		return this;
+	}
+
+	void reserve(uint32_t p_elements) {
+
+		if (p_elements > entry_capacity)
+			_rebuild(p_elements);
+	}
+
+	void clear() {
+
+		for (uint32_t i = 0; i < num_entries; i++) {
+			if (entries[i].hash == ERASED_HASH)
+				continue;
+			entries[i].key.~TKey();
+			entries[i].value.~TValue();
+		}
+		if (indices) {
+			for (uint32_t i = 0; i <= index_mask; i++) {
+				indices[i] = EMPTY_INDEX;
+			}
+		}
+		num_entries = 0;
+		num_elements = 0;
+	}
+
+	void operator=(const CompactHashMap &p_map) {
+
+		if (&p_map == this)
+			return;
+		clear();
+		_copy_from(p_map);
+	}
+
+	CompactHashMap(const CompactHashMap &p_map) :
+			entries(NULL),
+			indices(NULL),
+			num_entries(0),
+			entry_capacity(0),
+			index_mask(0),
+			num_elements(0) {
+
+		_copy_from(p_map);
+	}
+
+	_FORCE_INLINE_ CompactHashMap() :
+			entries(NULL),
+			indices(NULL),
+			num_entries(0),
+			entry_capacity(0),
+			index_mask(0),
+			num_elements(0) {
+	}
+
+	~CompactHashMap() {
+
+		clear();
+		if (entries)
+			Memory::free_static(entries);
+		if (indices)
+			Memory::free_static(indices);
+	}
+};
+
+#endif // COMPACT_HASH_MAP_H
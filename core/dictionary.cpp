@@ -30,14 +30,16 @@
 
 #include "dictionary.h"
 
-#include "core/ordered_hash_map.h"
+#include "core/compact_hash_map.h"
 #include "core/safe_refcount.h"
 #include "core/variant.h"
 
+typedef CompactHashMap<Variant, Variant, VariantHasher, VariantComparator> VariantMap;
+
 struct DictionaryPrivate {
 
 	SafeRefCount refcount;
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> variant_map;
+	VariantMap variant_map;
 };
 
 void Dictionary::get_key_list(List<Variant> *p_keys) const {
@@ -45,35 +47,27 @@ void Dictionary::get_key_list(List<Variant> *p_keys) const {
 	if (_p->variant_map.empty())
 		return;
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (VariantMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		p_keys->push_back(E.key());
 	}
 }
 
 Variant Dictionary::get_key_at_index(int p_index) const {
 
-	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		if (index == p_index) {
-			return E.key();
-		}
-		index++;
-	}
+	VariantMap::ConstElement E = ((const VariantMap *)&_p->variant_map)->get_element(p_index);
 
-	return Variant();
+	if (!E)
+		return Variant();
+	return E.key();
 }
 
 Variant Dictionary::get_value_at_index(int p_index) const {
 
-	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		if (index == p_index) {
-			return E.value();
-		}
-		index++;
-	}
+	VariantMap::ConstElement E = ((const VariantMap *)&_p->variant_map)->get_element(p_index);
 
-	return Variant();
+	if (!E)
+		return Variant();
+	return E.value();
 }
 
 Variant &Dictionary::operator[](const Variant &p_key) {
@@ -87,7 +81,7 @@ const Variant &Dictionary::operator[](const Variant &p_key) const {
 }
 const Variant *Dictionary::getptr(const Variant &p_key) const {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
+	VariantMap::ConstElement E = ((const VariantMap *)&_p->variant_map)->find(p_key);
 
 	if (!E)
 		return NULL;
@@ -96,7 +90,7 @@ const Variant *Dictionary::getptr(const Variant &p_key) const {
 
 Variant *Dictionary::getptr(const Variant &p_key) {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(p_key);
+	VariantMap::Element E = _p->variant_map.find(p_key);
 
 	if (!E)
 		return NULL;
@@ -105,7 +99,7 @@ Variant *Dictionary::getptr(const Variant &p_key) {
 
 Variant Dictionary::get_valid(const Variant &p_key) const {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
+	VariantMap::ConstElement E = ((const VariantMap *)&_p->variant_map)->find(p_key);
 
 	if (!E)
 		return Variant();
@@ -192,7 +186,7 @@ uint32_t Dictionary::hash() const {
 
 	uint32_t h = hash_djb2_one_32(Variant::DICTIONARY);
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (VariantMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		h = hash_djb2_one_32(E.key().hash(), h);
 		h = hash_djb2_one_32(E.value().hash(), h);
 	}
@@ -209,7 +203,7 @@ Array Dictionary::keys() const {
 	varr.resize(size());
 
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (VariantMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		varr[i] = E.key();
 		i++;
 	}
@@ -226,7 +220,7 @@ Array Dictionary::values() const {
 	varr.resize(size());
 
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (VariantMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		varr[i] = E.get();
 		i++;
 	}
@@ -242,7 +236,7 @@ const Variant *Dictionary::next(const Variant *p_key) const {
 			return &_p->variant_map.front().key();
 		return NULL;
 	}
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(*p_key);
+	VariantMap::Element E = _p->variant_map.find(*p_key);
 
 	if (E && E.next())
 		return &E.next().key();
@@ -252,8 +246,9 @@ const Variant *Dictionary::next(const Variant *p_key) const {
 Dictionary Dictionary::duplicate(bool p_deep) const {
 
 	Dictionary n;
+	n._p->variant_map.reserve(_p->variant_map.size());
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (VariantMap::Element E = _p->variant_map.front(); E; E = E.next()) {
 		n[E.key()] = p_deep ? E.value().duplicate(true) : E.value();
 	}
 
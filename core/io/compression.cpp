@@ -187,6 +187,30 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
 	ERR_FAIL_V(-1);
 }
 
+int Compression::compress_zstd_dictionary(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const uint8_t *p_dict, int p_dict_size, int p_level) {
+
+	ZSTD_CCtx *cctx = ZSTD_createCCtx();
+	ERR_FAIL_COND_V(!cctx, -1);
+
+	size_t ret = ZSTD_compress_usingDict(cctx, p_dst, p_dst_max_size, p_src, p_src_size, p_dict, p_dict_size, p_level);
+	ZSTD_freeCCtx(cctx);
+
+	ERR_FAIL_COND_V(ZSTD_isError(ret), -1);
+	return ret;
+}
+
+int Compression::decompress_zstd_dictionary(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const uint8_t *p_dict, int p_dict_size) {
+
+	ZSTD_DCtx *dctx = ZSTD_createDCtx();
+	ERR_FAIL_COND_V(!dctx, -1);
+
+	size_t ret = ZSTD_decompress_usingDict(dctx, p_dst, p_dst_max_size, p_src, p_src_size, p_dict, p_dict_size);
+	ZSTD_freeDCtx(dctx);
+
+	ERR_FAIL_COND_V(ZSTD_isError(ret), -1);
+	return ret;
+}
+
 int Compression::zlib_level = Z_DEFAULT_COMPRESSION;
 int Compression::gzip_level = Z_DEFAULT_COMPRESSION;
 int Compression::zstd_level = 3;
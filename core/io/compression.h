@@ -53,6 +53,11 @@ public:
 	static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_ZSTD);
 	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
 
+	// Zstd primed with a raw content dictionary, usually an earlier buffer of
+	// the same kind of data. Decompression needs the same dictionary.
+	static int compress_zstd_dictionary(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const uint8_t *p_dict, int p_dict_size, int p_level);
+	static int decompress_zstd_dictionary(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const uint8_t *p_dict, int p_dict_size);
+
 	Compression();
 };
 
@@ -31,6 +31,7 @@
 #include "json.h"
 
 #include "core/print_string.h"
+#include "core/string_buffer.h"
 
 const char *JSON::tk_name[TK_MAX] = {
 	"'{'",
@@ -177,7 +178,19 @@ Error JSON::_get_token(const CharType *p_str, int &index, int p_len, Token &r_to
 			case '"': {
 
 				index++;
-				String str;
+
+				// strings without escapes are copied in one go
+				int end = index;
+				while (p_str[end] != '"' && p_str[end] != '\\' && p_str[end] != 0) {
+					if (p_str[end] == '\n')
+						line++;
+					end++;
+				}
+
+				StringBuffer<> str;
+				str.append(&p_str[index], end - index);
+				index = end;
+
 				while (true) {
 					if (p_str[index] == 0) {
 						r_err_str = "Unterminated String";
@@ -257,7 +270,7 @@ Error JSON::_get_token(const CharType *p_str, int &index, int p_len, Token &r_to
 				}
 
 				r_token.type = TK_STRING;
-				r_token.value = str;
+				r_token.value = str.as_string();
 				return OK;
 
 			} break;
@@ -279,16 +292,15 @@ Error JSON::_get_token(const CharType *p_str, int &index, int p_len, Token &r_to
 
 				} else if ((p_str[index] >= 'A' && p_str[index] <= 'Z') || (p_str[index] >= 'a' && p_str[index] <= 'z')) {
 
-					String id;
+					int from = index;
 
 					while ((p_str[index] >= 'A' && p_str[index] <= 'Z') || (p_str[index] >= 'a' && p_str[index] <= 'z')) {
 
-						id += p_str[index];
 						index++;
 					}
 
 					r_token.type = TK_IDENTIFIER;
-					r_token.value = id;
+					r_token.value = StringView(&p_str[from], index - from).as_string();
 					return OK;
 				} else {
 					r_err_str = "Unexpected character.";
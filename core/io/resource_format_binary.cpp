@@ -37,9 +37,9 @@
 #include "core/project_settings.h"
 #include "core/version.h"
 
-#include "core/io/file_access_memory.h"
 
 #include "modules/tich/TichInfo.h"
+#include "modules/tich/TichStateStore.h"
 
 //#define print_bl(m_what) print_line(m_what)
 #define print_bl(m_what) (void)(m_what)
@@ -999,10 +999,10 @@ Ref<ResourceInteractiveLoader> ResourceFormatLoaderBinary::load_interactive(cons
 	Error err;
 	FileAccess *f = NULL;
 
-	if (TichInfo::IsLoading())
+	if (TichInfo::IsLoading() && TichStateStore::get_singleton() && TichStateStore::get_singleton()->HasSlot(p_path))
 	{
-		FileAccessMemory *file = memnew(FileAccessMemory);
-		err = file->_open("data", FileAccess::READ);
+		FileAccessTichStore *file = memnew(FileAccessTichStore);
+		err = file->_open(p_path, FileAccess::READ);
 		f = file;
 	}
 	else
@@ -1779,10 +1779,10 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 
 	} else {
 
-		if (TichInfo::IsSaving())
+		if (TichInfo::IsWritingState())
 		{
-			FileAccessMemory *file = memnew(FileAccessMemory);
-			err = file->_open("data", FileAccess::WRITE);
+			FileAccessTichStore *file = memnew(FileAccessTichStore);
+			err = file->_open(p_path, FileAccess::WRITE);
 			f = file;
 		}
 		else
@@ -65,6 +65,12 @@ public:
 		T *instance=Object::cast_to<T>(p_object);
 		$ifret PtrToArg<R>::encode( $ (instance->*method)($arg, PtrToArg<P@>::convert(p_args[@-1])$) $ifret ,r_ret)$ ;
 	}
+	virtual int get_ptrcall_type(int p_arg) const {
+		$ifret if (p_arg==-1) return PtrToArgType<R>::TYPE;$
+		$arg if (p_arg==(@-1)) return PtrToArgType<P@>::TYPE;
+		$
+		return PTRCALL_TYPE_CONVERTED;
+	}
 #endif
 	MethodBind$argc$$ifret R$$ifconst C$ () {
 #ifdef DEBUG_METHODS_ENABLED
@@ -159,6 +165,12 @@ public:
 		__UnexistingClass *instance = (__UnexistingClass*)p_object;
 		$ifret PtrToArg<R>::encode( $ (instance->*method)($arg, PtrToArg<P@>::convert(p_args[@-1])$) $ifret ,r_ret) $ ;
 	}
+	virtual int get_ptrcall_type(int p_arg) const {
+		$ifret if (p_arg==-1) return PtrToArgType<R>::TYPE;$
+		$arg if (p_arg==(@-1)) return PtrToArgType<P@>::TYPE;
+		$
+		return PTRCALL_TYPE_CONVERTED;
+	}
 #endif
 	MethodBind$argc$$ifret R$$ifconst C$ () {
 #ifdef DEBUG_METHODS_ENABLED
@@ -256,6 +268,12 @@ public:
 		T *instance=Object::cast_to<T>(p_object);
 		$ifret PtrToArg<R>::encode( $ (method)(instance$ifargs , $$arg, PtrToArg<P@>::convert(p_args[@-1])$) $ifret ,r_ret)$ ;
 	}
+	virtual int get_ptrcall_type(int p_arg) const {
+		$ifret if (p_arg==-1) return PtrToArgType<R>::TYPE;$
+		$arg if (p_arg==(@-1)) return PtrToArgType<P@>::TYPE;
+		$
+		return PTRCALL_TYPE_CONVERTED;
+	}
 #endif
 	FunctionBind$argc$$ifret R$$ifconst C$ () {
 #ifdef DEBUG_METHODS_ENABLED
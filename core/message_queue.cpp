@@ -34,19 +34,139 @@
 #include "core/script_language.h"
 
 MessageQueue *MessageQueue::singleton = NULL;
+thread_local MessageQueue::ThreadBufferRef MessageQueue::thread_buffer;
 
 MessageQueue *MessageQueue::get_singleton() {
 
 	return singleton;
 }
 
+MessageQueue::ThreadBufferRef::~ThreadBufferRef() {
+
+	// flush frees the buffer once it is drained
+	if (buffer && queue == singleton)
+		buffer->abandoned.store(true, std::memory_order_release);
+}
+
+MessageQueue::Chunk *MessageQueue::_create_chunk(uint32_t p_size) {
+
+	Chunk *chunk = memnew_placement(memalloc(sizeof(Chunk) + p_size), Chunk);
+	chunk->committed.store(0, std::memory_order_relaxed);
+	chunk->next.store(NULL, std::memory_order_relaxed);
+	chunk->size = p_size;
+	chunk->write_pos = 0;
+	chunk->read_pos = 0;
+	return chunk;
+}
+
+MessageQueue::ThreadBuffer *MessageQueue::_get_thread_buffer() {
+
+	ThreadBufferRef &ref = thread_buffer;
+	if (likely(ref.queue == this))
+		return ref.buffer;
+
+	ThreadBuffer *buffer = memnew(ThreadBuffer);
+	buffer->head = buffer->tail = _create_chunk(CHUNK_SIZE);
+	buffer->used.store(0, std::memory_order_relaxed);
+	buffer->abandoned.store(false, std::memory_order_relaxed);
+	buffer->thread = Thread::get_caller_id();
+
+	buffers_mutex->lock();
+	buffer->next = buffers;
+	buffers = buffer;
+	buffers_version.fetch_add(1, std::memory_order_release);
+	buffers_mutex->unlock();
+
+	ref.queue = this;
+	ref.buffer = buffer;
+	return buffer;
+}
+
+uint8_t *MessageQueue::_allocate(ThreadBuffer *p_buffer, uint32_t p_size) {
+
+	Chunk *chunk = p_buffer->tail;
+	if (chunk->write_pos + p_size > chunk->size) {
+		Chunk *next = _create_chunk(MAX((uint32_t)CHUNK_SIZE, p_size));
+		chunk->next.store(next, std::memory_order_release);
+		p_buffer->tail = chunk = next;
+	}
+
+	return chunk->get_data() + chunk->write_pos;
+}
+
+void MessageQueue::_commit(ThreadBuffer *p_buffer, Message *p_message, uint32_t p_size) {
+
+	p_message->order = next_order.fetch_add(1, std::memory_order_relaxed);
+
+	Chunk *chunk = p_buffer->tail;
+	chunk->write_pos += p_size;
+	p_buffer->used.fetch_add(p_size, std::memory_order_relaxed);
+	chunk->committed.store(chunk->write_pos, std::memory_order_release);
+}
+
+// The oldest message of the buffer that was committed, freeing the chunks
+// it is done with. Called by the flushing thread only.
+MessageQueue::Message *MessageQueue::_peek(ThreadBuffer *p_buffer) {
+
+	Chunk *chunk = p_buffer->head;
+	while (true) {
+
+		if (chunk->read_pos < chunk->committed.load(std::memory_order_acquire))
+			return (Message *)(chunk->get_data() + chunk->read_pos);
+
+		Chunk *next = chunk->next.load(std::memory_order_acquire);
+		if (!next)
+			return NULL;
+
+		// the producer commits its last message to a chunk before linking
+		// the next one, check again in case it was that one
+		if (chunk->read_pos < chunk->committed.load(std::memory_order_acquire))
+			continue;
+
+		memfree(chunk);
+		p_buffer->head = chunk = next;
+	}
+}
+
+uint32_t MessageQueue::_get_message_size(const Message *p_message) {
+
+	uint32_t size = sizeof(Message);
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION)
+		size += sizeof(Variant) * p_message->args;
+	return size;
+}
+
+void MessageQueue::_destroy_message(Message *p_message) {
+
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
+
+	p_message->~Message();
+}
+
+void MessageQueue::_free_buffer(ThreadBuffer *p_buffer) {
+
+	Message *message;
+	while ((message = _peek(p_buffer))) {
+		p_buffer->head->read_pos += _get_message_size(message);
+		_destroy_message(message);
+	}
+
+	memfree(p_buffer->head);
+	memdelete(p_buffer);
+}
+
 Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
 
-	_THREAD_SAFE_METHOD_
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
 
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	ThreadBuffer *buffer = _get_thread_buffer();
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	if ((buffer->used.load(std::memory_order_relaxed) + room_needed) >= buffer_size) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
@@ -55,7 +175,7 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const V
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(_allocate(buffer, room_needed), Message);
 	msg->args = p_argcount;
 	msg->instance_id = p_id;
 	msg->target = p_method;
@@ -63,15 +183,14 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const V
 	if (p_show_error)
 		msg->type |= FLAG_SHOW_ERROR;
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
 
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
-		*v = *p_args[i];
+		memnew_placement(&args[i], Variant(*p_args[i]));
 	}
 
+	_commit(buffer, msg, room_needed);
+
 	return OK;
 }
 
@@ -92,11 +211,11 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
 
-	_THREAD_SAFE_METHOD_
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant);
 
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
+	ThreadBuffer *buffer = _get_thread_buffer();
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	if ((buffer->used.load(std::memory_order_relaxed) + room_needed) >= buffer_size) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
@@ -105,43 +224,41 @@ Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Vari
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(_allocate(buffer, room_needed), Message);
 	msg->args = 1;
 	msg->instance_id = p_id;
 	msg->target = p_prop;
 	msg->type = TYPE_SET;
 
-	buffer_end += sizeof(Message);
+	memnew_placement(msg + 1, Variant(p_value));
 
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
-	*v = p_value;
+	_commit(buffer, msg, room_needed);
 
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
 
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
+	uint32_t room_needed = sizeof(Message);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	ThreadBuffer *buffer = _get_thread_buffer();
+
+	if ((buffer->used.load(std::memory_order_relaxed) + room_needed) >= buffer_size) {
 		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
 		statistics();
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(_allocate(buffer, room_needed), Message);
 
 	msg->type = TYPE_NOTIFICATION;
 	msg->instance_id = p_id;
 	//msg->target;
 	msg->notification = p_notification;
 
-	buffer_end += sizeof(Message);
+	_commit(buffer, msg, room_needed);
 
 	return OK;
 }
@@ -166,56 +283,76 @@ void MessageQueue::statistics() {
 	Map<int, int> notify_count;
 	Map<StringName, int> call_count;
 	int null_count = 0;
+	uint32_t total = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	// pending messages are only safe to read on the thread that flushes
+	bool list_messages = Thread::get_caller_id() == Thread::get_main_id();
 
-		Object *target = ObjectDB::get_instance(message->instance_id);
+	buffers_mutex->lock();
 
-		if (target != NULL) {
+	for (ThreadBuffer *buffer = buffers; buffer; buffer = buffer->next) {
 
-			switch (message->type & FLAG_MASK) {
+		uint32_t used = buffer->used.load(std::memory_order_relaxed);
+		print_line("THREAD " + itos(buffer->thread) + " BYTES: " + itos(used));
+		total += used;
 
-				case TYPE_CALL: {
+		if (!list_messages)
+			continue;
 
-					if (!call_count.has(message->target))
-						call_count[message->target] = 0;
+		for (Chunk *chunk = buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
 
-					call_count[message->target]++;
+			uint32_t read_pos = chunk->read_pos;
+			uint32_t committed = chunk->committed.load(std::memory_order_acquire);
+			while (read_pos < committed) {
+				Message *message = (Message *)(chunk->get_data() + read_pos);
 
-				} break;
-				case TYPE_NOTIFICATION: {
+				Object *target = ObjectDB::get_instance(message->instance_id);
 
-					if (!notify_count.has(message->notification))
-						notify_count[message->notification] = 0;
+				if (target != NULL) {
 
-					notify_count[message->notification]++;
+					switch (message->type & FLAG_MASK) {
 
-				} break;
-				case TYPE_SET: {
+						case TYPE_CALL: {
 
-					if (!set_count.has(message->target))
-						set_count[message->target] = 0;
+							if (!call_count.has(message->target))
+								call_count[message->target] = 0;
 
-					set_count[message->target]++;
+							call_count[message->target]++;
 
-				} break;
-			}
+						} break;
+						case TYPE_NOTIFICATION: {
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+							if (!notify_count.has(message->notification))
+								notify_count[message->notification] = 0;
 
-			null_count++;
-		}
+							notify_count[message->notification]++;
+
+						} break;
+						case TYPE_SET: {
+
+							if (!set_count.has(message->target))
+								set_count[message->target] = 0;
+
+							set_count[message->target]++;
+
+						} break;
+					}
+
+				} else {
+					//object was deleted
+					print_line("Object was deleted while awaiting a callback");
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+					null_count++;
+				}
+
+				read_pos += _get_message_size(message);
+			}
+		}
 	}
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	buffers_mutex->unlock();
+
+	print_line("TOTAL BYTES: " + itos(total));
 	print_line("NULL count: " + itos(null_count));
 
 	for (Map<StringName, int>::Element *E = set_count.front(); E; E = E->next()) {
@@ -256,32 +393,56 @@ void MessageQueue::_call_function(Object *p_target, const StringName &p_func, co
 
 void MessageQueue::flush() {
 
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
-	}
-
-	uint32_t read_pos = 0;
-
-	//using reverse locking strategy
-	_THREAD_SAFE_LOCK_
-
 	ERR_FAIL_COND(flushing); //already flushing, you did something odd
 	flushing = true;
 
-	while (read_pos < buffer_end) {
+	uint32_t snapshot_version = buffers_version.load(std::memory_order_acquire) - 1;
+	uint32_t used = 0;
 
-		//lock on each iteration, so a call can re-add itself to the message queue
+	while (true) {
 
-		Message *message = (Message *)&buffer[read_pos];
+		// threads that push for the first time add their buffer
+		if (snapshot_version != buffers_version.load(std::memory_order_acquire)) {
+			buffers_mutex->lock();
+			snapshot_version = buffers_version.load(std::memory_order_relaxed);
+			flush_buffers.clear();
+			used = 0;
+			for (ThreadBuffer *buffer = buffers; buffer; buffer = buffer->next) {
+				flush_buffers.push_back(buffer);
+				used += buffer->used.load(std::memory_order_relaxed);
+			}
+			buffers_mutex->unlock();
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			advance += sizeof(Variant) * message->args;
+			if (used > buffer_max_used)
+				buffer_max_used = used;
+		}
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+		// Each thread's messages go in the order that thread pushed them.
+		// Across threads, the committed message with the lowest order goes
+		// first; the passes repeat until no buffer offers a lower one. A
+		// producer can still take a lower order number and commit after this
+		// choice, its message then goes after the one chosen here.
+		ThreadBuffer *buffer = NULL;
+		Message *message = NULL;
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (int i = 0; i < flush_buffers.size(); i++) {
+				Message *m = _peek(flush_buffers[i]);
+				if (m && (!message || m->order < message->order)) {
+					buffer = flush_buffers[i];
+					message = m;
+					changed = true;
+				}
+			}
+		}
+
+		if (!message)
+			break;
 
-		_THREAD_SAFE_UNLOCK_
+		//pre-advance so this function is reentrant
+		uint32_t size = _get_message_size(message);
+		buffer->head->read_pos += size;
 
 		Object *target = ObjectDB::get_instance(message->instance_id);
 
@@ -313,21 +474,26 @@ void MessageQueue::flush() {
 			}
 		}
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
-			}
-		}
-
-		message->~Message();
+		_destroy_message(message);
+		buffer->used.fetch_sub(size, std::memory_order_relaxed);
+	}
 
-		_THREAD_SAFE_LOCK_
+	// free the buffers of threads that exited, once they are drained
+	buffers_mutex->lock();
+	ThreadBuffer **prev = &buffers;
+	while (*prev) {
+		ThreadBuffer *buffer = *prev;
+		if (buffer->abandoned.load(std::memory_order_acquire) && !_peek(buffer)) {
+			*prev = buffer->next;
+			_free_buffer(buffer);
+			buffers_version.fetch_add(1, std::memory_order_release);
+		} else {
+			prev = &buffer->next;
+		}
 	}
+	buffers_mutex->unlock();
 
-	buffer_end = 0; // reset buffer
 	flushing = false;
-	_THREAD_SAFE_UNLOCK_
 }
 
 bool MessageQueue::is_flushing() const {
@@ -341,34 +507,31 @@ MessageQueue::MessageQueue() {
 	singleton = this;
 	flushing = false;
 
-	buffer_end = 0;
+	buffers_mutex = Mutex::create();
+	buffers = NULL;
+	buffers_version.store(0, std::memory_order_relaxed);
+	next_order.store(0, std::memory_order_relaxed);
+
 	buffer_max_used = 0;
 	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater"));
 	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
 }
 
 MessageQueue::~MessageQueue() {
 
-	uint32_t read_pos = 0;
-
-	while (read_pos < buffer_end) {
-
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++)
-				args[i].~Variant();
-		}
-		message->~Message();
+	while (buffers) {
+		ThreadBuffer *buffer = buffers;
+		buffers = buffer->next;
+		_free_buffer(buffer);
+	}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+	if (thread_buffer.queue == this) {
+		thread_buffer.queue = NULL;
+		thread_buffer.buffer = NULL;
 	}
 
+	memdelete(buffers_mutex);
+
 	singleton = NULL;
-	memdelete_arr(buffer);
 }
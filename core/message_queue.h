@@ -32,15 +32,20 @@
 #define MESSAGE_QUEUE_H
 
 #include "core/object.h"
-#include "core/os/thread_safe.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
 
-class MessageQueue {
+#include <atomic>
 
-	_THREAD_SAFE_CLASS_
+// Every thread pushes to a buffer of its own without locking. Messages are
+// numbered as they are pushed, and flush() runs the messages of all buffers
+// in that order.
+class MessageQueue {
 
 	enum {
 
-		DEFAULT_QUEUE_SIZE_KB = 1024
+		DEFAULT_QUEUE_SIZE_KB = 1024,
+		CHUNK_SIZE = 64 * 1024
 	};
 
 	enum {
@@ -61,13 +66,62 @@ class MessageQueue {
 			int16_t notification;
 			int16_t args;
 		};
+		uint64_t order;
+	};
+
+	// the data follows the header, the producer publishes what it wrote by
+	// raising `committed` and links a new chunk once a message does not fit
+	struct Chunk {
+		std::atomic<uint32_t> committed;
+		std::atomic<Chunk *> next;
+		uint32_t size;
+		uint32_t write_pos; // producer only
+		uint32_t read_pos; // flush only
+
+		_FORCE_INLINE_ uint8_t *get_data() { return (uint8_t *)(this + 1); }
+	};
+
+	struct ThreadBuffer {
+		Chunk *head; // flush only
+		Chunk *tail; // producer only
+		std::atomic<uint32_t> used;
+		std::atomic<bool> abandoned; // its thread exited
+		Thread::ID thread;
+		ThreadBuffer *next;
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end;
+	struct ThreadBufferRef {
+		MessageQueue *queue;
+		ThreadBuffer *buffer;
+
+		ThreadBufferRef() {
+			queue = NULL;
+			buffer = NULL;
+		}
+		~ThreadBufferRef();
+	};
+
+	static thread_local ThreadBufferRef thread_buffer;
+
+	Mutex *buffers_mutex;
+	ThreadBuffer *buffers;
+	std::atomic<uint32_t> buffers_version;
+	Vector<ThreadBuffer *> flush_buffers; // flush only
+
+	std::atomic<uint64_t> next_order;
+
 	uint32_t buffer_max_used;
 	uint32_t buffer_size;
 
+	static Chunk *_create_chunk(uint32_t p_size);
+	ThreadBuffer *_get_thread_buffer();
+	uint8_t *_allocate(ThreadBuffer *p_buffer, uint32_t p_size);
+	void _commit(ThreadBuffer *p_buffer, Message *p_message, uint32_t p_size);
+	static Message *_peek(ThreadBuffer *p_buffer);
+	static uint32_t _get_message_size(const Message *p_message);
+	static void _destroy_message(Message *p_message);
+	void _free_buffer(ThreadBuffer *p_buffer);
+
 	void _call_function(Object *p_target, const StringName &p_func, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	static MessageQueue *singleton;
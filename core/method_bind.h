@@ -106,6 +106,10 @@ struct VariantCaster<const T &> {
 		_FORCE_INLINE_ static void encode(m_enum p_val, const void *p_ptr) { \
 			*(int *)p_ptr = p_val;                                           \
 		}                                                                    \
+	};                                                                       \
+	template <>                                                              \
+	struct PtrToArgType<m_enum> {                                            \
+		enum { TYPE = PTRCALL_TYPE_ENUM };                                   \
 	};
 
 #else
@@ -209,6 +213,7 @@ class MethodBind {
 	int method_id;
 	uint32_t hint_flags;
 	StringName name;
+	StringName setter_property;
 	Vector<Variant> default_arguments;
 	int default_argument_count;
 	int argument_count;
@@ -282,10 +287,15 @@ public:
 
 #ifdef PTRCALL_ENABLED
 	virtual void ptrcall(Object *p_object, const void **p_args, void *r_ret) = 0;
+	// PtrToArgType of an argument, or of the return value for -1.
+	virtual int get_ptrcall_type(int p_arg) const { return PTRCALL_TYPE_CONVERTED; }
 #endif
 
 	StringName get_name() const;
 	void set_name(const StringName &p_name);
+	// The property this method is the non-indexed setter of, if any.
+	_FORCE_INLINE_ const StringName &get_setter_property() const { return setter_property; }
+	void set_setter_property(const StringName &p_property) { setter_property = p_property; }
 	_FORCE_INLINE_ int get_method_id() const { return method_id; }
 	_FORCE_INLINE_ bool is_const() const { return _const; }
 	_FORCE_INLINE_ bool has_return() const { return _returns; }
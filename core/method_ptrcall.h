@@ -137,6 +137,69 @@ MAKE_PTRARG(PoolVector3Array);
 MAKE_PTRARG(PoolColorArray);
 MAKE_PTRARG_BY_REFERENCE(Variant);
 
+// How a type travels through ptrcall, for callers that pass Variant payloads
+// directly: the Variant::Type whose payload PtrToArg reads and writes (NIL for
+// Variant itself, OBJECT for object pointers), PTRCALL_TYPE_REFERENCE for Ref<T>,
+// PTRCALL_TYPE_ENUM for enums, or PTRCALL_TYPE_CONVERTED when the value needs the
+// conversions of Variant.
+
+enum PtrCallType {
+	PTRCALL_TYPE_REFERENCE = Variant::VARIANT_MAX, // returned as a Ref<Reference>
+	PTRCALL_TYPE_ENUM, // an int, not the int64_t payload of Variant::INT
+	PTRCALL_TYPE_CONVERTED,
+};
+
+template <class T>
+struct PtrToArgType {
+	enum { TYPE = PTRCALL_TYPE_CONVERTED };
+};
+
+#define MAKE_PTRARG_TYPE(m_type, m_variant_type) \
+	template <>                                  \
+	struct PtrToArgType<m_type> {                \
+		enum { TYPE = m_variant_type };          \
+	};                                           \
+	template <>                                  \
+	struct PtrToArgType<const m_type &> {        \
+		enum { TYPE = m_variant_type };          \
+	}
+
+MAKE_PTRARG_TYPE(bool, Variant::BOOL);
+MAKE_PTRARG_TYPE(uint8_t, Variant::INT);
+MAKE_PTRARG_TYPE(int8_t, Variant::INT);
+MAKE_PTRARG_TYPE(uint16_t, Variant::INT);
+MAKE_PTRARG_TYPE(int16_t, Variant::INT);
+MAKE_PTRARG_TYPE(uint32_t, Variant::INT);
+MAKE_PTRARG_TYPE(int32_t, Variant::INT);
+MAKE_PTRARG_TYPE(int64_t, Variant::INT);
+MAKE_PTRARG_TYPE(uint64_t, Variant::INT);
+MAKE_PTRARG_TYPE(float, Variant::REAL);
+MAKE_PTRARG_TYPE(double, Variant::REAL);
+
+MAKE_PTRARG_TYPE(String, Variant::STRING);
+MAKE_PTRARG_TYPE(Vector2, Variant::VECTOR2);
+MAKE_PTRARG_TYPE(Rect2, Variant::RECT2);
+MAKE_PTRARG_TYPE(Vector3, Variant::VECTOR3);
+MAKE_PTRARG_TYPE(Transform2D, Variant::TRANSFORM2D);
+MAKE_PTRARG_TYPE(Plane, Variant::PLANE);
+MAKE_PTRARG_TYPE(Quat, Variant::QUAT);
+MAKE_PTRARG_TYPE(AABB, Variant::AABB);
+MAKE_PTRARG_TYPE(Basis, Variant::BASIS);
+MAKE_PTRARG_TYPE(Transform, Variant::TRANSFORM);
+MAKE_PTRARG_TYPE(Color, Variant::COLOR);
+MAKE_PTRARG_TYPE(NodePath, Variant::NODE_PATH);
+MAKE_PTRARG_TYPE(RID, Variant::_RID);
+MAKE_PTRARG_TYPE(Dictionary, Variant::DICTIONARY);
+MAKE_PTRARG_TYPE(Array, Variant::ARRAY);
+MAKE_PTRARG_TYPE(PoolByteArray, Variant::POOL_BYTE_ARRAY);
+MAKE_PTRARG_TYPE(PoolIntArray, Variant::POOL_INT_ARRAY);
+MAKE_PTRARG_TYPE(PoolRealArray, Variant::POOL_REAL_ARRAY);
+MAKE_PTRARG_TYPE(PoolStringArray, Variant::POOL_STRING_ARRAY);
+MAKE_PTRARG_TYPE(PoolVector2Array, Variant::POOL_VECTOR2_ARRAY);
+MAKE_PTRARG_TYPE(PoolVector3Array, Variant::POOL_VECTOR3_ARRAY);
+MAKE_PTRARG_TYPE(PoolColorArray, Variant::POOL_COLOR_ARRAY);
+MAKE_PTRARG_TYPE(Variant, Variant::NIL);
+
 //this is for Object
 
 template <class T>
@@ -167,6 +230,16 @@ struct PtrToArg<const T *> {
 	}
 };
 
+template <class T>
+struct PtrToArgType<T *> {
+	enum { TYPE = Variant::OBJECT };
+};
+
+template <class T>
+struct PtrToArgType<const T *> {
+	enum { TYPE = Variant::OBJECT };
+};
+
 //this is for the special cases used by Variant
 
 #define MAKE_VECARG(m_type)                                                                      \
@@ -400,6 +473,8 @@ MAKE_DVECARR(Plane);
 
 MAKE_STRINGCONV(StringName);
 MAKE_STRINGCONV_BY_REFERENCE(IP_Address);
+MAKE_PTRARG_TYPE(StringName, Variant::STRING);
+MAKE_PTRARG_TYPE(IP_Address, Variant::STRING);
 
 template <>
 struct PtrToArg<PoolVector<Face3> > {
@@ -354,39 +354,40 @@ NodePath::NodePath(const String &p_path) {
 	if (p_path.length() == 0)
 		return;
 
-	String path = p_path;
+	// names are interned straight from the path, without a String for each
+	const CharType *path = p_path.ptr();
+	int path_len = p_path.length();
 	Vector<StringName> subpath;
 
 	bool absolute = (path[0] == '/');
 	bool last_is_slash = true;
 	bool has_slashes = false;
 	int slices = 0;
-	int subpath_pos = path.find(":");
+	int subpath_pos = StringView(p_path).find(':');
 
 	if (subpath_pos != -1) {
 
 		int from = subpath_pos + 1;
 
-		for (int i = from; i <= path.length(); i++) {
+		for (int i = from; i <= path_len; i++) {
 
 			if (path[i] == ':' || path[i] == 0) {
 
-				String str = path.substr(from, i - from);
-				if (str == "") {
+				if (i == from) {
 					if (path[i] == 0) continue; // Allow end-of-path :
 
 					ERR_FAIL_MSG("Invalid NodePath '" + p_path + "'.");
 				}
-				subpath.push_back(str);
+				subpath.push_back(StringName(StringView(path + from, i - from)));
 
 				from = i + 1;
 			}
 		}
 
-		path = path.substr(0, subpath_pos);
+		path_len = subpath_pos;
 	}
 
-	for (int i = (int)absolute; i < path.length(); i++) {
+	for (int i = (int)absolute; i < path_len; i++) {
 
 		if (path[i] == '/') {
 
@@ -418,15 +419,14 @@ NodePath::NodePath(const String &p_path) {
 	int from = (int)absolute;
 	int slice = 0;
 
-	for (int i = (int)absolute; i < path.length() + 1; i++) {
+	for (int i = (int)absolute; i < path_len + 1; i++) {
 
-		if (path[i] == '/' || path[i] == 0) {
+		if (i == path_len || path[i] == '/') {
 
 			if (!last_is_slash) {
 
-				String name = path.substr(from, i - from);
 				ERR_FAIL_INDEX(slice, data->path.size());
-				data->path.write[slice++] = name;
+				data->path.write[slice++] = StringName(StringView(path + from, i - from));
 			}
 			from = i + 1;
 			last_is_slash = true;
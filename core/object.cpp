@@ -411,6 +411,9 @@ void Object::set(const StringName &p_name, const Variant &p_value, bool *r_valid
 	_edited = true;
 #endif
 
+	if (unlikely(change_journal))
+		mark_property_changed(p_name);
+
 	if (script_instance) {
 
 		if (script_instance->set(p_name, p_value)) {
@@ -921,6 +924,9 @@ Variant Object::call(const StringName &p_method, const Variant **p_args, int p_a
 
 	if (method) {
 
+		if (unlikely(change_journal) && method->get_setter_property() != StringName())
+			mark_property_changed(method->get_setter_property());
+
 		ret = method->call(this, p_args, p_argcount, r_error);
 	} else {
 		r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
@@ -1615,6 +1621,51 @@ Variant Object::_get_indexed_bind(const NodePath &p_name) const {
 	return get_indexed(p_name.get_as_property_path().get_subnames());
 }
 
+void Object::set_change_tracking(bool p_enable) {
+
+	if (p_enable == (change_journal != NULL))
+		return;
+
+	if (p_enable) {
+		change_journal = memnew(ChangeJournal);
+		change_journal->version = 1;
+	} else {
+		memdelete(change_journal);
+		change_journal = NULL;
+	}
+}
+
+void Object::mark_property_changed(const StringName &p_property) {
+
+	ERR_FAIL_COND_MSG(!change_journal, "Change tracking is not enabled on this object.");
+
+	change_journal->version++;
+	change_journal->changes[p_property] = change_journal->version;
+}
+
+void Object::get_changed_properties(uint64_t p_since_version, List<StringName> *r_properties) const {
+
+	if (!change_journal)
+		return;
+
+	const StringName *K = NULL;
+	while ((K = change_journal->changes.next(K))) {
+		if (change_journal->changes[*K] > p_since_version)
+			r_properties->push_back(*K);
+	}
+}
+
+PoolStringArray Object::_get_changed_properties_bind(uint64_t p_since_version) const {
+
+	List<StringName> changed;
+	get_changed_properties(p_since_version, &changed);
+
+	PoolStringArray ret;
+	for (List<StringName>::Element *E = changed.front(); E; E = E->next())
+		ret.push_back(E->get());
+	return ret;
+}
+
 void Object::initialize_class() {
 
 	static bool initialized = false;
@@ -1730,6 +1781,12 @@ void Object::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("has_meta", "name"), &Object::has_meta);
 	ClassDB::bind_method(D_METHOD("get_meta_list"), &Object::_get_meta_list_bind);
 
+	ClassDB::bind_method(D_METHOD("set_change_tracking", "enable"), &Object::set_change_tracking);
+	ClassDB::bind_method(D_METHOD("is_change_tracking"), &Object::is_change_tracking);
+	ClassDB::bind_method(D_METHOD("mark_property_changed", "property"), &Object::mark_property_changed);
+	ClassDB::bind_method(D_METHOD("get_change_version"), &Object::get_change_version);
+	ClassDB::bind_method(D_METHOD("get_changed_properties", "since_version"), &Object::_get_changed_properties_bind);
+
 	ClassDB::bind_method(D_METHOD("add_user_signal", "signal", "arguments"), &Object::_add_user_signal, DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("has_user_signal", "signal"), &Object::_has_user_signal);
 
@@ -1981,6 +2038,7 @@ Object::Object() {
 	instance_binding_count = 0;
 	memset(_script_instance_bindings, 0, sizeof(void *) * MAX_SCRIPT_INSTANCE_BINDINGS);
 	script_instance = NULL;
+	change_journal = NULL;
 #ifdef DEBUG_ENABLED
 	_rc.store(nullptr, std::memory_order_release);
 #endif
@@ -2010,6 +2068,10 @@ Object::~Object() {
 		memdelete(script_instance);
 	script_instance = NULL;
 
+	if (change_journal)
+		memdelete(change_journal);
+	change_journal = NULL;
+
 	const StringName *S = NULL;
 
 	if (_emitting) {
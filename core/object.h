@@ -502,6 +502,13 @@ private:
 	mutable StringName _class_name;
 	mutable const StringName *_class_ptr;
 
+	struct ChangeJournal {
+		uint64_t version;
+		HashMap<StringName, uint64_t> changes; // version of the last change of each property
+	};
+
+	ChangeJournal *change_journal;
+
 	void _add_user_signal(const String &p_name, const Array &p_args = Array());
 	bool _has_user_signal(const StringName &p_name) const;
 	Variant _emit_signal(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
@@ -512,6 +519,7 @@ private:
 	Variant _get_bind(const String &p_name) const;
 	void _set_indexed_bind(const NodePath &p_name, const Variant &p_value);
 	Variant _get_indexed_bind(const NodePath &p_name) const;
+	PoolStringArray _get_changed_properties_bind(uint64_t p_since_version) const;
 
 	void property_list_changed_notify();
 
@@ -713,6 +721,17 @@ public:
 	void set_script_instance(ScriptInstance *p_instance);
 	_FORCE_INLINE_ ScriptInstance *get_script_instance() const { return script_instance; }
 
+	// Opt-in journal of the properties changed through set(), property
+	// setters and setter calls. Changes made by engine code that bypasses
+	// those, like physics moving a body, are not recorded, enable it only
+	// on objects whose state changes through them. GDScript records the
+	// writes to its own members too, not in place changes of their values.
+	void set_change_tracking(bool p_enable);
+	_FORCE_INLINE_ bool is_change_tracking() const { return change_journal != NULL; }
+	void mark_property_changed(const StringName &p_property);
+	_FORCE_INLINE_ uint64_t get_change_version() const { return change_journal ? change_journal->version : 0; }
+	void get_changed_properties(uint64_t p_since_version, List<StringName> *r_properties) const;
+
 	void set_script_and_instance(const RefPtr &p_script, ScriptInstance *p_instance); //some script languages can't control instance creation, so this function eases the process
 
 	void add_user_signal(const MethodInfo &p_signal);
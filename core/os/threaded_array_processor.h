@@ -31,16 +31,10 @@
 #ifndef THREADED_ARRAY_PROCESSOR_H
 #define THREADED_ARRAY_PROCESSOR_H
 
-#include "core/os/mutex.h"
-#include "core/os/os.h"
-#include "core/os/thread.h"
-#include "core/os/thread_safe.h"
-#include "core/safe_refcount.h"
+#include "core/os/worker_thread_pool.h"
 
 template <class C, class U>
 struct ThreadArrayProcessData {
-	uint32_t elements;
-	uint32_t index;
 	C *instance;
 	U userdata;
 	void (C::*method)(uint32_t, U);
@@ -50,61 +44,31 @@ struct ThreadArrayProcessData {
 	}
 };
 
-#ifndef NO_THREADS
-
 template <class T>
-void process_array_thread(void *ud) {
+void process_array_range(void *ud, uint32_t p_begin, uint32_t p_end) {
 
 	T &data = *(T *)ud;
-	while (true) {
-		uint32_t index = atomic_increment(&data.index);
-		if (index >= data.elements)
-			break;
-		data.process(index);
+	for (uint32_t i = p_begin; i < p_end; i++) {
+		data.process(i);
 	}
 }
 
+// Runs on the worker thread pool, with the calling thread taking part. Small
+// elements should use a bigger grain, so threads fetch them in batches.
 template <class C, class M, class U>
-void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata, uint32_t p_grain = 1) {
 
 	ThreadArrayProcessData<C, U> data;
 	data.method = p_method;
 	data.instance = p_instance;
 	data.userdata = p_userdata;
-	data.index = 0;
-	data.elements = p_elements;
-	data.process(data.index); //process first, let threads increment for next
-
-	Vector<Thread *> threads;
-
-	threads.resize(OS::get_singleton()->get_processor_count());
-
-	for (int i = 0; i < threads.size(); i++) {
-		threads.write[i] = Thread::create(process_array_thread<ThreadArrayProcessData<C, U> >, &data);
-	}
-
-	for (int i = 0; i < threads.size(); i++) {
-		Thread::wait_to_finish(threads[i]);
-		memdelete(threads[i]);
-	}
-}
 
-#else
-
-template <class C, class M, class U>
-void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-
-	ThreadArrayProcessData<C, U> data;
-	data.method = p_method;
-	data.instance = p_instance;
-	data.userdata = p_userdata;
-	data.index = 0;
-	data.elements = p_elements;
-	for (uint32_t i = 0; i < p_elements; i++) {
-		data.process(i);
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool) {
+		pool->parallel_for(p_elements, p_grain, process_array_range<ThreadArrayProcessData<C, U> >, &data);
+	} else {
+		process_array_range<ThreadArrayProcessData<C, U> >(&data, 0, p_elements);
 	}
 }
 
-#endif
-
 #endif // THREADED_ARRAY_PROCESSOR_H
@@ -0,0 +1,301 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/safe_refcount.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = NULL;
+thread_local int WorkerThreadPool::worker_index = -1;
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+
+	WorkerThreadPool *pool = singleton;
+	worker_index = (intptr_t)p_user;
+
+	while (true) {
+
+		pool->work_semaphore->wait();
+		if (pool->exit_threads)
+			break;
+
+		Task *task;
+		while ((task = pool->_pop_task()))
+			pool->_run_task(task);
+	}
+}
+
+void WorkerThreadPool::_push_task(Task *p_task) {
+
+	// workers queue their own subtasks, so they are likely to run them
+	// while the data they share is still in cache
+	int queue;
+	if (worker_index >= 0) {
+		queue = worker_index;
+	} else {
+		queue = atomic_increment(&next_queue) % queue_count;
+	}
+
+	queues[queue].mutex->lock();
+	queues[queue].tasks.push_back(p_task);
+	queues[queue].mutex->unlock();
+
+	if (work_semaphore)
+		work_semaphore->post();
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_pop_task() {
+
+	Task *task = NULL;
+
+	if (worker_index >= 0) {
+		Queue &own = queues[worker_index];
+		own.mutex->lock();
+		if (own.tasks.size()) {
+			task = own.tasks.back()->get();
+			own.tasks.pop_back();
+		}
+		own.mutex->unlock();
+
+		if (task)
+			return task;
+	}
+
+	int start = worker_index >= 0 ? worker_index + 1 : 0;
+	for (int i = 0; i < queue_count && !task; i++) {
+		Queue &victim = queues[(start + i) % queue_count];
+		victim.mutex->lock();
+		if (victim.tasks.size()) {
+			task = victim.tasks.front()->get();
+			victim.tasks.pop_front();
+		}
+		victim.mutex->unlock();
+	}
+
+	return task;
+}
+
+void WorkerThreadPool::_run_task(Task *p_task) {
+
+	p_task->func(p_task->userdata);
+
+	Vector<Task *> ready;
+
+	task_mutex->lock();
+	p_task->completed = true;
+	for (int i = 0; i < p_task->dependents.size(); i++) {
+		Task *dependent = p_task->dependents[i];
+		if (--dependent->pending_dependencies == 0)
+			ready.push_back(dependent);
+	}
+	p_task->dependents.clear();
+	if (p_task->waiter)
+		p_task->waiter->post();
+	task_mutex->unlock();
+
+	for (int i = 0; i < ready.size(); i++)
+		_push_task(ready[i]);
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_task(TaskFunc p_func, void *p_userdata, const TaskID *p_dependencies, int p_dependency_count) {
+
+	ERR_FAIL_COND_V(!p_func, INVALID_TASK_ID);
+
+	Task *task = memnew(Task);
+	task->func = p_func;
+	task->userdata = p_userdata;
+	task->pending_dependencies = 0;
+	task->completed = false;
+	task->waiter = NULL;
+
+	task_mutex->lock();
+	task->id = ++last_task_id;
+	tasks[task->id] = task;
+
+	// dependencies that were already waited for are complete
+	for (int i = 0; i < p_dependency_count; i++) {
+		Task **dependency = tasks.getptr(p_dependencies[i]);
+		if (dependency && !(*dependency)->completed) {
+			(*dependency)->dependents.push_back(task);
+			task->pending_dependencies++;
+		}
+	}
+	bool ready = task->pending_dependencies == 0;
+	task_mutex->unlock();
+
+	if (ready)
+		_push_task(task);
+
+	return task->id;
+}
+
+void WorkerThreadPool::wait_for_task(TaskID p_task) {
+
+	task_mutex->lock();
+	Task **found = tasks.getptr(p_task);
+	Task *task = found ? *found : NULL;
+	task_mutex->unlock();
+
+	ERR_FAIL_COND_MSG(!task, "Invalid task ID, or the task was already waited for.");
+
+	while (!task->completed) {
+
+		Task *other = _pop_task();
+		if (other) {
+			_run_task(other);
+			continue;
+		}
+
+		// nothing to help with, the task is running on another thread or
+		// waits for one that is
+		task_mutex->lock();
+		if (task->completed) {
+			task_mutex->unlock();
+			break;
+		}
+		if (!task->waiter)
+			task->waiter = Semaphore::create();
+		task_mutex->unlock();
+
+		ERR_FAIL_COND_MSG(!task->waiter, "Task can't complete without worker threads.");
+		task->waiter->wait();
+	}
+
+	task_mutex->lock();
+	tasks.erase(p_task);
+	task_mutex->unlock();
+
+	if (task->waiter)
+		memdelete(task->waiter);
+	memdelete(task);
+}
+
+void WorkerThreadPool::_range_task(void *p_userdata) {
+
+	RangeData &data = *(RangeData *)p_userdata;
+
+	while (true) {
+		uint32_t end = atomic_add(&data.next, data.grain);
+		uint32_t begin = end - data.grain;
+		if (begin >= data.elements)
+			break;
+		data.func(data.userdata, begin, MIN(end, data.elements));
+	}
+}
+
+void WorkerThreadPool::parallel_for(uint32_t p_elements, uint32_t p_grain, RangeFunc p_func, void *p_userdata) {
+
+	if (p_grain == 0)
+		p_grain = 1;
+
+	uint32_t ranges = (p_elements + p_grain - 1) / p_grain;
+	int helpers = MIN((int)ranges - 1, threads.size());
+
+	if (helpers <= 0) {
+		if (p_elements)
+			p_func(p_userdata, 0, p_elements);
+		return;
+	}
+
+	RangeData data;
+	data.func = p_func;
+	data.userdata = p_userdata;
+	data.elements = p_elements;
+	data.grain = p_grain;
+	data.next = 0;
+
+	Vector<TaskID> helper_tasks;
+	helper_tasks.resize(helpers);
+	for (int i = 0; i < helpers; i++)
+		helper_tasks.write[i] = add_task(_range_task, &data);
+
+	_range_task(&data);
+
+	for (int i = 0; i < helpers; i++)
+		wait_for_task(helper_tasks[i]);
+}
+
+WorkerThreadPool::WorkerThreadPool(int p_thread_count) {
+
+	singleton = this;
+
+	exit_threads = false;
+	next_queue = 0;
+	last_task_id = INVALID_TASK_ID;
+	task_mutex = Mutex::create();
+	work_semaphore = NULL;
+
+#ifndef NO_THREADS
+	// the threads waiting for tasks make up for the core left free
+	if (p_thread_count < 0)
+		p_thread_count = OS::get_singleton()->get_processor_count() - 1;
+#else
+	p_thread_count = 0;
+#endif
+
+	// the calling threads use the queues too, so there is at least one
+	queue_count = MAX(p_thread_count, 1);
+	queues = memnew_arr(Queue, queue_count);
+	for (int i = 0; i < queue_count; i++)
+		queues[i].mutex = Mutex::create();
+
+	if (p_thread_count > 0) {
+		work_semaphore = Semaphore::create();
+		threads.resize(p_thread_count);
+		for (int i = 0; i < p_thread_count; i++)
+			threads.write[i] = Thread::create(_thread_function, (void *)(intptr_t)i);
+	}
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+
+	exit_threads = true;
+	for (int i = 0; i < threads.size(); i++)
+		work_semaphore->post();
+
+	for (int i = 0; i < threads.size(); i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	if (tasks.size())
+		ERR_PRINT("Tasks were added to the worker thread pool and never waited for.");
+
+	for (int i = 0; i < queue_count; i++)
+		memdelete(queues[i].mutex);
+	memdelete_arr(queues);
+	if (work_semaphore)
+		memdelete(work_semaphore);
+	memdelete(task_mutex);
+
+	if (singleton == this)
+		singleton = NULL;
+}
@@ -0,0 +1,118 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/hash_map.h"
+#include "core/list.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/vector.h"
+
+// Persistent worker threads, started once with the core types. Each worker
+// runs the tasks of its own queue newest first and steals the oldest task
+// of another queue when its own is empty. Threads waiting for a task run
+// queued tasks meanwhile, so tasks may wait for other tasks.
+class WorkerThreadPool {
+public:
+	typedef uint64_t TaskID;
+	typedef void (*TaskFunc)(void *p_userdata);
+	typedef void (*RangeFunc)(void *p_userdata, uint32_t p_begin, uint32_t p_end);
+
+	enum {
+		INVALID_TASK_ID = 0
+	};
+
+private:
+	struct Task {
+		TaskID id;
+		TaskFunc func;
+		void *userdata;
+		uint32_t pending_dependencies;
+		Vector<Task *> dependents;
+		volatile bool completed;
+		Semaphore *waiter;
+	};
+
+	struct Queue {
+		Mutex *mutex;
+		List<Task *> tasks;
+	};
+
+	struct RangeData {
+		RangeFunc func;
+		void *userdata;
+		uint32_t elements;
+		uint32_t grain;
+		volatile uint32_t next;
+	};
+
+	static WorkerThreadPool *singleton;
+	static thread_local int worker_index;
+
+	Vector<Thread *> threads;
+	Queue *queues;
+	int queue_count;
+	Semaphore *work_semaphore;
+	bool exit_threads;
+	uint32_t next_queue;
+
+	Mutex *task_mutex;
+	HashMap<TaskID, Task *> tasks;
+	TaskID last_task_id;
+
+	static void _thread_function(void *p_user);
+	static void _range_task(void *p_userdata);
+
+	void _push_task(Task *p_task);
+	Task *_pop_task();
+	void _run_task(Task *p_task);
+
+public:
+	// Every task has to be waited for exactly once, that releases it.
+	TaskID add_task(TaskFunc p_func, void *p_userdata, const TaskID *p_dependencies = NULL, int p_dependency_count = 0);
+	void wait_for_task(TaskID p_task);
+
+	// Calls p_func for consecutive ranges of at most p_grain elements, with
+	// the calling thread taking part, and returns when all are processed.
+	void parallel_for(uint32_t p_elements, uint32_t p_grain, RangeFunc p_func, void *p_userdata);
+
+	int get_thread_count() const { return threads.size(); }
+	bool is_worker_thread() const { return worker_index >= 0; }
+
+	static WorkerThreadPool *get_singleton() { return singleton; }
+
+	WorkerThreadPool(int p_thread_count = -1);
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
@@ -366,6 +366,18 @@ struct PtrToArg<const RefPtr &> {
 	}
 };
 
+template <class T>
+struct PtrToArgType<Ref<T> > {
+	enum { TYPE = PTRCALL_TYPE_REFERENCE };
+};
+
+template <class T>
+struct PtrToArgType<const Ref<T> &> {
+	enum { TYPE = PTRCALL_TYPE_REFERENCE };
+};
+
+MAKE_PTRARG_TYPE(RefPtr, PTRCALL_TYPE_REFERENCE);
+
 #endif // PTRCALL_ENABLED
 
 #ifdef DEBUG_METHODS_ENABLED
@@ -64,6 +64,7 @@
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
@@ -88,6 +89,8 @@ static _JSON *_json = NULL;
 
 static IP *ip = NULL;
 
+static WorkerThreadPool *worker_thread_pool = NULL;
+
 static _Geometry *_geometry = NULL;
 
 extern Mutex *_global_mutex;
@@ -105,6 +108,8 @@ void register_core_types() {
 
 	_global_mutex = Mutex::create();
 
+	worker_thread_pool = memnew(WorkerThreadPool);
+
 	StringName::setup();
 	ResourceLoader::initialize();
 
@@ -305,6 +310,8 @@ void unregister_core_types() {
 	if (ip)
 		memdelete(ip);
 
+	memdelete(worker_thread_pool);
+
 	ResourceLoader::finalize();
 
 	ClassDB::cleanup_defaults();
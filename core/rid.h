@@ -43,9 +43,6 @@ class RID_Data {
 
 	friend class RID_OwnerBase;
 
-#ifndef DEBUG_ENABLED
-	RID_OwnerBase *_owner;
-#endif
 	uint32_t _id;
 
 public:
@@ -54,67 +51,68 @@ public:
 	virtual ~RID_Data();
 };
 
+// A handle into the table of the owner that made it, the slot index in the
+// low 32 bits and the RID's unique id in the high ones. Ids are never
+// reused, so handles to freed objects stay invalid when the slot is reused.
 class RID {
 	friend class RID_OwnerBase;
 
-	mutable RID_Data *_data;
+	uint64_t _handle;
 
 public:
-	_FORCE_INLINE_ RID_Data *get_data() const { return _data; }
-
 	_FORCE_INLINE_ bool operator==(const RID &p_rid) const {
 
-		return _data == p_rid._data;
+		return _handle == p_rid._handle;
 	}
 	_FORCE_INLINE_ bool operator<(const RID &p_rid) const {
 
-		return _data < p_rid._data;
+		return _handle < p_rid._handle;
 	}
 	_FORCE_INLINE_ bool operator<=(const RID &p_rid) const {
 
-		return _data <= p_rid._data;
+		return _handle <= p_rid._handle;
 	}
 	_FORCE_INLINE_ bool operator>(const RID &p_rid) const {
 
-		return _data > p_rid._data;
+		return _handle > p_rid._handle;
 	}
 	_FORCE_INLINE_ bool operator!=(const RID &p_rid) const {
 
-		return _data != p_rid._data;
+		return _handle != p_rid._handle;
 	}
-	_FORCE_INLINE_ bool is_valid() const { return _data != NULL; }
+	_FORCE_INLINE_ bool is_valid() const { return _handle != 0; }
 
-	_FORCE_INLINE_ uint32_t get_id() const { return _data ? _data->get_id() : 0; }
+	_FORCE_INLINE_ uint32_t get_id() const { return _handle >> 32; }
 
 	_FORCE_INLINE_ RID() {
-		_data = NULL;
+		_handle = 0;
 	}
 };
 
 class RID_OwnerBase {
 protected:
 	static SafeRefCount refcount;
-	_FORCE_INLINE_ void _set_data(RID &p_rid, RID_Data *p_data) {
-		p_rid._data = p_data;
-		refcount.ref();
-		p_data->_id = refcount.get();
-#ifndef DEBUG_ENABLED
-		p_data->_owner = this;
-#endif
-	}
 
-#ifndef DEBUG_ENABLED
+	_FORCE_INLINE_ static RID _make_rid(uint32_t p_index, RID_Data *p_data) {
 
-	_FORCE_INLINE_ bool _is_owner(const RID &p_rid) const {
+		p_data->_id = refcount.refval();
 
-		return this == p_rid._data->_owner;
+		RID rid;
+		rid._handle = ((uint64_t)p_data->_id << 32) | p_index;
+		return rid;
 	}
 
-	_FORCE_INLINE_ void _remove_owner(RID &p_rid) {
+	_FORCE_INLINE_ static RID _get_rid(uint32_t p_index, uint32_t p_id) {
 
-		p_rid._data->_owner = NULL;
+		RID rid;
+		rid._handle = ((uint64_t)p_id << 32) | p_index;
+		return rid;
+	}
+
+	_FORCE_INLINE_ static uint32_t _get_index(const RID &p_rid) {
+
+		return p_rid._handle & 0xFFFFFFFF;
 	}
-#endif
 
 public:
 	virtual void get_owned_list(List<RID> *p_owned) = 0;
@@ -123,81 +121,180 @@ public:
 	virtual ~RID_OwnerBase() {}
 };
 
+// Validating a RID is an index and an id comparison, and the owned objects
+// can be walked in one pass over the table. The slots live in fixed size
+// chunks that never move, so lookups from other threads stay valid while the
+// table grows. Making and freeing RIDs is only meant for one thread at a time.
 template <class T>
 class RID_Owner : public RID_OwnerBase {
-public:
-#ifdef DEBUG_ENABLED
-	mutable Set<RID_Data *> id_map;
-#endif
+
+	struct Slot {
+		T *data;
+		uint32_t id; // 0 while the slot is free
+		uint32_t next_free;
+	};
+
+	enum {
+		NO_FREE_SLOT = 0xFFFFFFFF,
+		CHUNK_SHIFT = 8,
+		CHUNK_SIZE = 1 << CHUNK_SHIFT,
+		CHUNK_MASK = CHUNK_SIZE - 1
+	};
+
+	Slot **chunks;
+	uint32_t chunk_count;
+	uint32_t chunk_capacity;
+	// directories outgrown by chunks, a lookup may still be reading one
+	List<Slot **> retired_chunks;
+	uint32_t slot_count;
+	uint32_t first_free;
+	uint32_t rid_count;
+
+	_FORCE_INLINE_ Slot &_get_slot_at(uint32_t p_index) const {
+
+		return chunks[p_index >> CHUNK_SHIFT][p_index & CHUNK_MASK];
+	}
+
+	_FORCE_INLINE_ const Slot *_get_slot(const RID &p_rid) const {
+
+		uint32_t index = _get_index(p_rid);
+		if (index >= slot_count)
+			return NULL;
+
+		const Slot &slot = _get_slot_at(index);
+		if (slot.id == 0 || slot.id != p_rid.get_id())
+			return NULL;
+
+		return &slot;
+	}
+
+	void _add_chunk() {
+
+		if (chunk_count == chunk_capacity) {
+			uint32_t capacity = chunk_capacity ? chunk_capacity * 2 : 4;
+			Slot **grown = (Slot **)memalloc(capacity * sizeof(Slot *));
+			for (uint32_t i = 0; i < chunk_count; i++)
+				grown[i] = chunks[i];
+			if (chunks)
+				retired_chunks.push_back(chunks);
+			chunks = grown;
+			chunk_capacity = capacity;
+		}
+
+		chunks[chunk_count++] = (Slot *)memalloc(CHUNK_SIZE * sizeof(Slot));
+	}
+
 public:
 	_FORCE_INLINE_ RID make_rid(T *p_data) {
 
-		RID rid;
-		_set_data(rid, p_data);
+		uint32_t index;
+		if (first_free != NO_FREE_SLOT) {
+			index = first_free;
+			first_free = _get_slot_at(index).next_free;
+		} else {
+			if (slot_count == chunk_count << CHUNK_SHIFT)
+				_add_chunk();
+			index = slot_count;
+		}
 
-#ifdef DEBUG_ENABLED
-		id_map.insert(p_data);
-#endif
+		RID rid = _make_rid(index, p_data);
+
+		Slot &slot = _get_slot_at(index);
+		slot.data = p_data;
+		slot.id = rid.get_id();
+		slot.next_free = NO_FREE_SLOT;
+		if (index == slot_count)
+			slot_count++; // after the slot is set, lookups bounded by the count only see set slots
+		rid_count++;
 
 		return rid;
 	}
 
 	_FORCE_INLINE_ T *get(const RID &p_rid) {
 
+		const Slot *slot = _get_slot(p_rid);
 #ifdef DEBUG_ENABLED
 
 		ERR_FAIL_COND_V(!p_rid.is_valid(), NULL);
-		ERR_FAIL_COND_V(!id_map.has(p_rid.get_data()), NULL);
+		ERR_FAIL_COND_V(!slot, NULL);
 #endif
-		return static_cast<T *>(p_rid.get_data());
+		return slot ? slot->data : NULL;
 	}
 
 	_FORCE_INLINE_ T *getornull(const RID &p_rid) {
 
+		const Slot *slot = _get_slot(p_rid);
 #ifdef DEBUG_ENABLED
 
-		if (p_rid.get_data()) {
-			ERR_FAIL_COND_V(!id_map.has(p_rid.get_data()), NULL);
+		if (p_rid.is_valid()) {
+			ERR_FAIL_COND_V(!slot, NULL);
 		}
 #endif
-		return static_cast<T *>(p_rid.get_data());
+		return slot ? slot->data : NULL;
 	}
 
 	_FORCE_INLINE_ T *getptr(const RID &p_rid) {
 
-		return static_cast<T *>(p_rid.get_data());
+		const Slot *slot = _get_slot(p_rid);
+		return slot ? slot->data : NULL;
 	}
 
 	_FORCE_INLINE_ bool owns(const RID &p_rid) const {
 
-		if (p_rid.get_data() == NULL)
-			return false;
-#ifdef DEBUG_ENABLED
-		return id_map.has(p_rid.get_data());
-#else
-		return _is_owner(p_rid);
-#endif
+		return _get_slot(p_rid) != NULL;
 	}
 
 	void free(RID p_rid) {
 
-#ifdef DEBUG_ENABLED
-		id_map.erase(p_rid.get_data());
-#else
-		_remove_owner(p_rid);
-#endif
+		if (!_get_slot(p_rid))
+			return;
+
+		uint32_t index = _get_index(p_rid);
+		Slot &slot = _get_slot_at(index);
+		slot.data = NULL;
+		slot.id = 0;
+		slot.next_free = first_free;
+		first_free = index;
+		rid_count--;
 	}
 
-	void get_owned_list(List<RID> *p_owned) {
+	_FORCE_INLINE_ uint32_t get_rid_count() const { return rid_count; }
 
-#ifdef DEBUG_ENABLED
+	// p_buffer needs room for get_rid_count() RIDs
+	void fill_owned_buffer(RID *p_buffer) const {
 
-		for (typename Set<RID_Data *>::Element *E = id_map.front(); E; E = E->next()) {
-			RID r;
-			_set_data(r, static_cast<T *>(E->get()));
-			p_owned->push_back(r);
+		for (uint32_t i = 0; i < slot_count; i++) {
+			const Slot &slot = _get_slot_at(i);
+			if (slot.id)
+				*p_buffer++ = _get_rid(i, slot.id);
 		}
-#endif
+	}
+
+	void get_owned_list(List<RID> *p_owned) {
+
+		for (uint32_t i = 0; i < slot_count; i++) {
+			const Slot &slot = _get_slot_at(i);
+			if (slot.id)
+				p_owned->push_back(_get_rid(i, slot.id));
+		}
+	}
+
+	RID_Owner() {
+		chunks = NULL;
+		chunk_count = 0;
+		chunk_capacity = 0;
+		slot_count = 0;
+		first_free = NO_FREE_SLOT;
+		rid_count = 0;
+	}
+
+	~RID_Owner() {
+		for (uint32_t i = 0; i < chunk_count; i++)
+			memfree(chunks[i]);
+		if (chunks)
+			memfree(chunks);
+		for (typename List<Slot **>::Element *E = retired_chunks.front(); E; E = E->next())
+			memfree(E->get());
 	}
 };
 
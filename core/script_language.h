@@ -339,6 +339,8 @@ public:
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const = 0;
+	// Called with the autoloads before they are loaded, so their scripts can be compiled ahead (e.g. in parallel).
+	virtual void precompile_scripts(const Vector<String> &p_paths) {}
 	virtual void get_public_functions(List<MethodInfo> *p_functions) const = 0;
 	virtual void get_public_constants(List<Pair<String, Variant> > *p_constants) const = 0;
 
@@ -47,23 +47,27 @@ StringName _scs_create(const char *p_chr) {
 }
 
 bool StringName::configured = false;
-Mutex *StringName::lock = NULL;
+RWLock *StringName::shard_locks[SHARD_COUNT];
+thread_local StringName::_ThreadCache StringName::thread_cache;
 
 void StringName::setup() {
 
-	lock = Mutex::create();
-
 	ERR_FAIL_COND(configured);
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
 		_table[i] = NULL;
 	}
+	for (int i = 0; i < SHARD_COUNT; i++) {
+
+		shard_locks[i] = RWLock::create();
+	}
 	configured = true;
 }
 
 void StringName::cleanup() {
 
-	lock->lock();
+	// the names other threads cached were released when they exited
+	thread_cache.flush();
 
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
@@ -87,9 +91,190 @@ void StringName::cleanup() {
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
-	lock->unlock();
 
-	memdelete(lock);
+	for (int i = 0; i < SHARD_COUNT; i++) {
+
+		memdelete(shard_locks[i]);
+		shard_locks[i] = NULL;
+	}
+}
+
+bool StringName::_Data::equals(const char *p_name) const {
+
+	if (cname)
+		return strcmp(cname, p_name) == 0;
+	return name == p_name;
+}
+
+bool StringName::_Data::equals(const CharType *p_name) const {
+
+	if (!cname)
+		return name == p_name;
+
+	const char *c = cname;
+	while (*c && (CharType)(uint8_t)*c == *p_name) {
+		c++;
+		p_name++;
+	}
+	return *c == 0 && *p_name == 0;
+}
+
+bool StringName::_Data::equals(const String &p_name) const {
+
+	if (cname)
+		return p_name == cname;
+	return name == p_name;
+}
+
+bool StringName::_Data::equals(const StringView &p_name) const {
+
+	if (!cname)
+		return StringView(name) == p_name;
+
+	int i = 0;
+	for (; i < p_name.length(); i++) {
+		if (!cname[i] || (CharType)(uint8_t)cname[i] != p_name[i])
+			return false;
+	}
+	return cname[i] == 0;
+}
+
+static _FORCE_INLINE_ String _get_name_string(const String &p_name) {
+
+	return p_name;
+}
+
+static _FORCE_INLINE_ String _get_name_string(const char *p_name) {
+
+	return p_name;
+}
+
+static _FORCE_INLINE_ String _get_name_string(const StringView &p_name) {
+
+	return p_name.as_string();
+}
+
+StringName::_ThreadCache::_ThreadCache() {
+
+	for (int i = 0; i < THREAD_CACHE_SIZE; i++) {
+
+		entries[i] = NULL;
+	}
+}
+
+StringName::_ThreadCache::~_ThreadCache() {
+
+	// threads exiting after cleanup have nothing left to release
+	if (shard_locks[0])
+		flush();
+}
+
+void StringName::_ThreadCache::flush() {
+
+	for (int i = 0; i < THREAD_CACHE_SIZE; i++) {
+
+		if (entries[i]) {
+			StringName release(entries[i]);
+			entries[i] = NULL;
+		}
+	}
+}
+
+// Returns a new reference to the entry, the caller holds the shard lock.
+template <class T>
+StringName::_Data *StringName::_find(uint32_t p_idx, uint32_t p_hash, const T &p_name) {
+
+	for (_Data *d = _table[p_idx]; d; d = d->next) {
+
+		// compare hash first, and skip entries whose last reference is being
+		// released, they are removed as soon as that thread gets the lock
+		if (d->hash == p_hash && d->equals(p_name) && d->refcount.ref())
+			return d;
+	}
+
+	return NULL;
+}
+
+template <class T>
+StringName::_Data *StringName::_find_cached(uint32_t p_hash, const T &p_name) {
+
+	_Data *d = thread_cache.entries[p_hash & THREAD_CACHE_MASK];
+	if (d && d->hash == p_hash && d->equals(p_name) && d->refcount.ref())
+		return d;
+
+	return NULL;
+}
+
+void StringName::_cache(_Data *p_data) {
+
+	_Data *&entry = thread_cache.entries[p_data->hash & THREAD_CACHE_MASK];
+	if (entry == p_data || !p_data->refcount.ref())
+		return;
+
+	if (entry) {
+		StringName release(entry);
+	}
+	entry = p_data;
+}
+
+template <class T>
+StringName::_Data *StringName::_intern(uint32_t p_hash, const T &p_name, const char *p_static_name) {
+
+	_Data *data = _find_cached(p_hash, p_name);
+	if (data)
+		return data;
+
+	uint32_t idx = p_hash & STRING_TABLE_MASK;
+	RWLock *shard = shard_locks[idx & SHARD_MASK];
+
+	shard->read_lock();
+	data = _find(idx, p_hash, p_name);
+	shard->read_unlock();
+
+	if (!data) {
+
+		shard->write_lock();
+
+		// another thread may have added it meanwhile
+		data = _find(idx, p_hash, p_name);
+		if (!data) {
+			data = memnew(_Data);
+			if (p_static_name)
+				data->cname = p_static_name;
+			else
+				data->name = _get_name_string(p_name);
+			data->refcount.init();
+			data->hash = p_hash;
+			data->idx = idx;
+			data->next = _table[idx];
+			data->prev = NULL;
+			if (_table[idx])
+				_table[idx]->prev = data;
+			_table[idx] = data;
+		}
+
+		shard->write_unlock();
+	}
+
+	_cache(data);
+	return data;
+}
+
+template <class T>
+StringName StringName::_search(uint32_t p_hash, const T &p_name) {
+
+	_Data *data = _find_cached(p_hash, p_name);
+	if (data)
+		return StringName(data);
+
+	uint32_t idx = p_hash & STRING_TABLE_MASK;
+	RWLock *shard = shard_locks[idx & SHARD_MASK];
+
+	shard->read_lock();
+	data = _find(idx, p_hash, p_name);
+	shard->read_unlock();
+
+	return StringName(data); //empty if it does not exist
 }
 
 void StringName::unref() {
@@ -98,7 +283,8 @@ void StringName::unref() {
 
 	if (_data && _data->refcount.unref()) {
 
-		lock->lock();
+		RWLock *shard = shard_locks[_data->idx & SHARD_MASK];
+		shard->write_lock();
 
 		if (_data->prev) {
 			_data->prev->next = _data->next;
@@ -113,7 +299,7 @@ void StringName::unref() {
 			_data->next->prev = _data->prev;
 		}
 		memdelete(_data);
-		lock->unlock();
+		shard->write_unlock();
 	}
 
 	_data = NULL;
@@ -126,7 +312,7 @@ bool StringName::operator==(const String &p_name) const {
 		return (p_name.length() == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _data->equals(p_name);
 }
 
 bool StringName::operator==(const char *p_name) const {
@@ -136,7 +322,7 @@ bool StringName::operator==(const char *p_name) const {
 		return (p_name[0] == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _data->equals(p_name);
 }
 
 bool StringName::operator!=(const String &p_name) const {
@@ -184,43 +370,7 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(String::hash(p_name), p_name, NULL);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -231,43 +381,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(String::hash(p_static_string.ptr), p_static_string.ptr, p_static_string.ptr);
 }
 
 StringName::StringName(const String &p_name) {
@@ -279,42 +393,19 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
+	_data = _intern(p_name.hash(), p_name, NULL);
+}
 
-	while (_data) {
+StringName::StringName(const StringView &p_name) {
 
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
+	_data = NULL;
 
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
+	ERR_FAIL_COND(!configured);
 
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
+	if (p_name.empty())
+		return;
 
-	lock->unlock();
+	_data = _intern(p_name.hash(), p_name, NULL);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -325,30 +416,7 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-
-		return StringName(_data);
-	}
-
-	lock->unlock();
-	return StringName(); //does not exist
+	return _search(String::hash(p_name), p_name);
 }
 
 StringName StringName::search(const CharType *p_name) {
@@ -359,57 +427,13 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
-	}
-
-	lock->unlock();
-	return StringName(); //does not exist
+	return _search(String::hash(p_name), p_name);
 }
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
-	}
-
-	lock->unlock();
-	return StringName(); //does not exist
+	return _search(p_name.hash(), p_name);
 }
 
 StringName::StringName() {
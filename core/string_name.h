@@ -31,7 +31,7 @@
 #ifndef STRING_NAME_H
 #define STRING_NAME_H
 
-#include "core/os/mutex.h"
+#include "core/os/rw_lock.h"
 #include "core/safe_refcount.h"
 #include "core/ustring.h"
 
@@ -47,7 +47,17 @@ class StringName {
 
 		STRING_TABLE_BITS = 12,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+
+		// buckets are locked in shards, threads interning different names
+		// rarely wait for each other
+		SHARD_BITS = 6,
+		SHARD_COUNT = 1 << SHARD_BITS,
+		SHARD_MASK = SHARD_COUNT - 1,
+
+		THREAD_CACHE_BITS = 8,
+		THREAD_CACHE_SIZE = 1 << THREAD_CACHE_BITS,
+		THREAD_CACHE_MASK = THREAD_CACHE_SIZE - 1
 	};
 
 	struct _Data {
@@ -56,6 +66,10 @@ class StringName {
 		String name;
 
 		String get_name() const { return cname ? String(cname) : name; }
+		bool equals(const char *p_name) const;
+		bool equals(const CharType *p_name) const;
+		bool equals(const String &p_name) const;
+		bool equals(const StringView &p_name) const;
 		int idx;
 		uint32_t hash;
 		_Data *prev;
@@ -70,6 +84,28 @@ class StringName {
 
 	static _Data *_table[STRING_TABLE_LEN];
 
+	// names the thread interned recently, each holding a reference, so
+	// interning them again does not lock
+	struct _ThreadCache {
+		_Data *entries[THREAD_CACHE_SIZE];
+
+		void flush();
+		_ThreadCache();
+		~_ThreadCache();
+	};
+
+	static thread_local _ThreadCache thread_cache;
+
+	template <class T>
+	static _Data *_find(uint32_t p_idx, uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_find_cached(uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_intern(uint32_t p_hash, const T &p_name, const char *p_static_name);
+	template <class T>
+	static StringName _search(uint32_t p_hash, const T &p_name);
+	static void _cache(_Data *p_data);
+
 	_Data *_data;
 
 	union _HashUnion {
@@ -82,7 +118,7 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex *lock;
+	static RWLock *shard_locks[SHARD_COUNT];
 	static void setup();
 	static void cleanup();
 	static bool configured;
@@ -159,6 +195,7 @@ public:
 	StringName(const char *p_name);
 	StringName(const StringName &p_name);
 	StringName(const String &p_name);
+	StringName(const StringView &p_name);
 	StringName(const StaticCString &p_static_string);
 	StringName();
 	~StringName();
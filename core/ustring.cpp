@@ -4435,3 +4435,58 @@ String RTR(const String &p_text) {
 
 	return p_text;
 }
+
+StringView StringView::substr(int p_from, int p_chars) const {
+
+	if (p_from < 0 || p_from >= _length)
+		return StringView();
+	if (p_chars < 0 || p_from + p_chars > _length)
+		p_chars = _length - p_from;
+
+	return StringView(_ptr + p_from, p_chars);
+}
+
+int StringView::find(CharType p_char, int p_from) const {
+
+	for (int i = MAX(p_from, 0); i < _length; i++) {
+		if (_ptr[i] == p_char)
+			return i;
+	}
+
+	return -1;
+}
+
+bool StringView::begins_with(const char *p_str) const {
+
+	int i = 0;
+	for (; p_str[i]; i++) {
+		if (i >= _length || _ptr[i] != (CharType)(uint8_t)p_str[i])
+			return false;
+	}
+
+	return true;
+}
+
+bool StringView::operator==(const StringView &p_view) const {
+
+	if (_length != p_view._length)
+		return false;
+
+	for (int i = 0; i < _length; i++) {
+		if (_ptr[i] != p_view._ptr[i])
+			return false;
+	}
+
+	return true;
+}
+
+bool StringView::operator==(const char *p_str) const {
+
+	int i = 0;
+	for (; i < _length; i++) {
+		if (!p_str[i] || _ptr[i] != (CharType)(uint8_t)p_str[i])
+			return false;
+	}
+
+	return p_str[i] == 0;
+}
@@ -370,6 +370,51 @@ bool operator==(const char *p_chr, const String &p_str);
 String operator+(const char *p_chr, const String &p_str);
 String operator+(CharType p_chr, const String &p_str);
 
+// A range of characters of a String or buffer that is not copied, for
+// parsers to look at words and segments without allocating a String for
+// each. It is only valid as long as the characters it points to are.
+class StringView {
+
+	const CharType *_ptr;
+	int _length;
+
+public:
+	_FORCE_INLINE_ const CharType *ptr() const { return _ptr; }
+	_FORCE_INLINE_ int length() const { return _length; }
+	_FORCE_INLINE_ bool empty() const { return _length == 0; }
+
+	_FORCE_INLINE_ CharType operator[](int p_index) const {
+		CRASH_BAD_INDEX(p_index, _length);
+		return _ptr[p_index];
+	}
+
+	StringView substr(int p_from, int p_chars = -1) const;
+	int find(CharType p_char, int p_from = 0) const;
+	bool begins_with(const char *p_str) const;
+
+	bool operator==(const StringView &p_view) const;
+	bool operator==(const char *p_str) const;
+	_FORCE_INLINE_ bool operator!=(const StringView &p_view) const { return !(*this == p_view); }
+	_FORCE_INLINE_ bool operator!=(const char *p_str) const { return !(*this == p_str); }
+
+	_FORCE_INLINE_ uint32_t hash() const { return String::hash(_ptr, _length); }
+	_FORCE_INLINE_ int64_t to_int() const { return String::to_int(_ptr, _length); }
+	_FORCE_INLINE_ String as_string() const { return String(_ptr, _length); }
+
+	_FORCE_INLINE_ StringView() {
+		_ptr = NULL;
+		_length = 0;
+	}
+	_FORCE_INLINE_ StringView(const CharType *p_ptr, int p_length) {
+		_ptr = p_ptr;
+		_length = p_length;
+	}
+	_FORCE_INLINE_ StringView(const String &p_string) {
+		_ptr = p_string.ptr();
+		_length = p_string.length();
+	}
+};
+
 String itos(int64_t p_val);
 String uitos(uint64_t p_val);
 String rtos(double p_val);
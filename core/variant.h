@@ -130,6 +130,7 @@ public:
 
 private:
 	friend struct _VariantCall;
+	friend struct VariantInternal;
 	// Variant takes 20 bytes when real_t is float, and 36 if double
 	// it only allocates extra memory for aabb/matrix.
 
@@ -393,6 +394,11 @@ public:
 	static Vector<StringName> get_method_argument_names(Variant::Type p_type, const StringName &p_method);
 	static bool is_method_const(Variant::Type p_type, const StringName &p_method);
 
+	// Method of a built-in type without the name lookup and argument checks of call(),
+	// p_args must hold every argument with the expected types.
+	typedef void (*ValidatedMethod)(Variant &r_ret, Variant &p_self, const Variant **p_args);
+	static ValidatedMethod get_validated_method(Variant::Type p_type, const StringName &p_method);
+
 	void set_named(const StringName &p_index, const Variant &p_value, bool *r_valid = NULL);
 	Variant get_named(const StringName &p_index, bool *r_valid = NULL) const;
 
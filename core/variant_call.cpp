@@ -1356,6 +1356,18 @@ Variant::Type Variant::get_method_return_type(Variant::Type p_type, const String
 	return E->get().return_type;
 }
 
+Variant::ValidatedMethod Variant::get_validated_method(Variant::Type p_type, const StringName &p_method) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, NULL);
+	const _VariantCall::TypeFunc &tf = _VariantCall::type_funcs[p_type];
+
+	const Map<StringName, _VariantCall::FuncData>::Element *E = tf.functions.find(p_method);
+	if (!E)
+		return NULL;
+
+	return E->get().func;
+}
+
 Vector<Variant> Variant::get_method_default_arguments(Variant::Type p_type, const StringName &p_method) {
 
 	const _VariantCall::TypeFunc &tf = _VariantCall::type_funcs[p_type];
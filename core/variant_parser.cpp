@@ -208,7 +208,7 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 			};
 			case '"': {
 
-				String str;
+				StringBuffer<> str_buffer;
 				while (true) {
 
 					CharType ch = p_stream->get_char();
@@ -281,15 +281,16 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 							} break;
 						}
 
-						str += res;
+						str_buffer += res;
 
 					} else {
 						if (ch == '\n')
 							line++;
-						str += ch;
+						str_buffer += ch;
 					}
 				}
 
+				String str = str_buffer.as_string();
 				if (p_stream->is_utf8()) {
 					str.parse_utf8(str.ascii(true).get_data());
 				}
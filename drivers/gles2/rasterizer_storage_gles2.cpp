@@ -1078,12 +1078,13 @@ String RasterizerStorageGLES2::texture_get_path(RID p_texture) const {
 }
 
 void RasterizerStorageGLES2::texture_debug_usage(List<VS::TextureInfo> *r_info) {
-	List<RID> textures;
-	texture_owner.get_owned_list(&textures);
+	Vector<RID> textures;
+	textures.resize(texture_owner.get_rid_count());
+	texture_owner.fill_owned_buffer(textures.ptrw());
 
-	for (List<RID>::Element *E = textures.front(); E; E = E->next()) {
+	for (int i = 0; i < textures.size(); i++) {
 
-		Texture *t = texture_owner.getornull(E->get());
+		Texture *t = texture_owner.getornull(textures[i]);
 		if (!t)
 			continue;
 		VS::TextureInfo tinfo;
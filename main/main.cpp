@@ -70,6 +70,7 @@
 #include "servers/physics_server.h"
 #include "servers/register_server_types.h"
 
+#include "modules/tich/TichProfiler.h"
 #include "modules/tich/TichSystem.h"
 
 #ifdef TOOLS_ENABLED
@@ -291,6 +292,13 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  --print-fps                      Print the frames per second to the stdout.\n");
 	OS::get_singleton()->print("\n");
 
+	OS::get_singleton()->print("Tich benchmark options:\n");
+	OS::get_singleton()->print("  --tich-bench <scene>             Run the save/load benchmark on <scene>, write the results to data/ and quit.\n");
+	OS::get_singleton()->print("  --tich-mode <mode>               Benchmark mode: ga-save (default), ga-load, gs-save or gs-load.\n");
+	OS::get_singleton()->print("  --tich-samples <n>               Number of frames to sample (default 600).\n");
+	OS::get_singleton()->print("  --tich-interval <n>              Frames between two saves or loads (default 60).\n");
+	OS::get_singleton()->print("\n");
+
 	OS::get_singleton()->print("Standalone tools:\n");
 	OS::get_singleton()->print("  -s, --script <script>            Run a script.\n");
 	OS::get_singleton()->print("  --check-only                     Only parse for errors and quit (use with --script).\n");
@@ -1474,6 +1482,10 @@ bool Main::start() {
 	String script;
 	String test;
 	bool check_only = false;
+	String tich_bench;
+	String tich_mode = "ga-save";
+	int tich_samples = 600;
+	int tich_interval = 60;
 
 #ifdef TOOLS_ENABLED
 	bool doc_base = true;
@@ -1521,6 +1533,14 @@ bool Main::start() {
 				script = args[i + 1];
 			} else if (args[i] == "--test") {
 				test = args[i + 1];
+			} else if (args[i] == "--tich-bench") {
+				tich_bench = args[i + 1];
+			} else if (args[i] == "--tich-mode") {
+				tich_mode = args[i + 1];
+			} else if (args[i] == "--tich-samples") {
+				tich_samples = args[i + 1].to_int();
+			} else if (args[i] == "--tich-interval") {
+				tich_interval = args[i + 1].to_int();
 #ifdef TOOLS_ENABLED
 			} else if (args[i] == "--doctool") {
 				doc_tool = args[i + 1];
@@ -1620,6 +1640,14 @@ bool Main::start() {
 	}
 #endif
 
+	if (tich_bench != "") {
+		ERR_FAIL_COND_V_MSG(tich_samples <= 0 || tich_interval <= 0, false, "--tich-samples and --tich-interval must be positive.");
+
+		if (!TichProfiler::get_singleton()->SetupBenchmark(tich_bench, tich_mode, tich_samples, tich_interval))
+			return false;
+		game_path = tich_bench;
+	}
+
 	if (script == "" && game_path == "" && String(GLOBAL_DEF("application/run/main_scene", "")) != "") {
 		game_path = GLOBAL_DEF("application/run/main_scene", "");
 	}
@@ -1721,6 +1749,7 @@ bool Main::start() {
 				ProjectSettings::get_singleton()->get_property_list(&props);
 
 				//first pass, add the constants so they exist before any script is loaded
+				Vector<String> autoload_paths;
 				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
 
 					String s = E->get().name;
@@ -1731,7 +1760,9 @@ bool Main::start() {
 					bool global_var = false;
 					if (path.begins_with("*")) {
 						global_var = true;
+						path = path.substr(1, path.length() - 1);
 					}
+					autoload_paths.push_back(path);
 
 					if (global_var) {
 						for (int i = 0; i < ScriptServer::get_language_count(); i++) {
@@ -1740,6 +1771,11 @@ bool Main::start() {
 					}
 				}
 
+				//let the languages compile the autoloaded scripts ahead, they can use several threads
+				for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+					ScriptServer::get_language(i)->precompile_scripts(autoload_paths);
+				}
+
 				//second pass, load into global constants
 				List<Node *> to_add;
 				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
@@ -30,6 +30,7 @@
 
 #include "test_gdscript.h"
 
+#include "core/os/dir_access.h"
 #include "core/os/file_access.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
@@ -37,6 +38,7 @@
 #ifdef GDSCRIPT_ENABLED
 
 #include "modules/gdscript/gdscript.h"
+#include "modules/gdscript/gdscript_bytecode.h"
 #include "modules/gdscript/gdscript_compiler.h"
 #include "modules/gdscript/gdscript_parser.h"
 #include "modules/gdscript/gdscript_tokenizer.h"
@@ -557,8 +559,18 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 #define DADDR(m_ip) (_disassemble_addr(p_class, func, code[ip + m_ip]))
 
+		// without a debugger the lines are in a table instead of OPCODE_LINE
+		const Vector<Pair<int, int> > &line_table = func.get_line_table();
+		int line_index = 0;
+
 		for (int ip = 0; ip < codelen;) {
 
+			while (line_index < line_table.size() && line_table[line_index].first <= ip) {
+				int line = line_table[line_index++].second - 1;
+				if (line >= 0 && line < p_code.size())
+					print_line("\n" + itos(line + 1) + ": " + p_code[line] + "\n");
+			}
+
 			int incr = 0;
 			String txt = itos(ip) + " ";
 
@@ -578,6 +590,42 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += DADDR(3);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_REAL:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
+
+					static const char *types[] = { "int", "float", "Vector2", "Vector3" };
+					int op = code[ip + 1];
+					txt += String(" op-") + types[code[ip] - GDScriptFunction::OPCODE_OPERATOR_INT] + " ";
+
+					String opname = Variant::get_operator_name(Variant::Operator(op));
+
+					txt += DADDR(4);
+					txt += " = ";
+					txt += DADDR(2);
+					txt += " " + opname + " ";
+					txt += DADDR(3);
+					incr += 5;
+
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_JUMP_IF:
+				case GDScriptFunction::OPCODE_OPERATOR_JUMP_IF_NOT: {
+
+					// only the operator, the jump after it is listed on its own
+					int op = code[ip + 1];
+					txt += code[ip] == GDScriptFunction::OPCODE_OPERATOR_JUMP_IF ? " op-jump-if " : " op-jump-if-not ";
+
+					String opname = Variant::get_operator_name(Variant::Operator(op));
+
+					txt += DADDR(4);
+					txt += " = ";
+					txt += DADDR(2);
+					txt += " " + opname + " ";
+					txt += DADDR(3);
+					incr += 5;
+
 				} break;
 				case GDScriptFunction::OPCODE_SET: {
 
@@ -624,6 +672,29 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += "\"]";
 					incr += 4;
 
+				} break;
+				case GDScriptFunction::OPCODE_SET_COMPONENT: {
+
+					txt += " set_component ";
+					txt += DADDR(1);
+					txt += "[\"";
+					txt += func.get_global_name(code[ip + 2]);
+					txt += "\"]=";
+					txt += DADDR(5);
+					incr += 6;
+
+				} break;
+				case GDScriptFunction::OPCODE_GET_COMPONENT: {
+
+					txt += " get_component ";
+					txt += DADDR(5);
+					txt += "=";
+					txt += DADDR(1);
+					txt += "[\"";
+					txt += func.get_global_name(code[ip + 2]);
+					txt += "\"]";
+					incr += 6;
+
 				} break;
 				case GDScriptFunction::OPCODE_SET_MEMBER: {
 
@@ -635,9 +706,10 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					incr += 3;
 
 				} break;
-				case GDScriptFunction::OPCODE_GET_MEMBER: {
+				case GDScriptFunction::OPCODE_GET_MEMBER:
+				case GDScriptFunction::OPCODE_GET_MEMBER_OPERATOR: {
 
-					txt += " get_member ";
+					txt += code[ip] == GDScriptFunction::OPCODE_GET_MEMBER ? " get_member " : " get_member-op ";
 					txt += DADDR(2);
 					txt += "=";
 					txt += "[\"";
@@ -794,6 +866,55 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 					incr = 5 + argc;
 
+				} break;
+				case GDScriptFunction::OPCODE_CALL_VALIDATED: {
+
+					txt += " call-validated ";
+
+					int argc = code[ip + 1];
+					txt += DADDR(5 + argc) + "=";
+					txt += DADDR(2) + ".";
+					txt += String(func.get_global_name(code[ip + 3]));
+					txt += "(";
+
+					for (int i = 0; i < argc; i++) {
+						if (i > 0)
+							txt += ", ";
+						txt += DADDR(5 + i);
+					}
+					txt += ")";
+
+					incr = 6 + argc;
+
+				} break;
+				case GDScriptFunction::OPCODE_CALL_METHOD_BIND:
+				case GDScriptFunction::OPCODE_CALL_METHOD_BIND_RETURN: {
+
+					bool ret = code[ip] == GDScriptFunction::OPCODE_CALL_METHOD_BIND_RETURN;
+
+					if (ret)
+						txt += " call-method-bind-ret ";
+					else
+						txt += " call-method-bind ";
+
+					int argc = code[ip + 1];
+					if (ret) {
+						txt += DADDR(5 + argc) + "=";
+					}
+
+					txt += DADDR(2) + ".";
+					txt += String(func.get_global_name(code[ip + 3]));
+					txt += "(";
+
+					for (int i = 0; i < argc; i++) {
+						if (i > 0)
+							txt += ", ";
+						txt += DADDR(5 + i);
+					}
+					txt += ")";
+
+					incr = 6 + argc;
+
 				} break;
 				case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
 
@@ -905,6 +1026,30 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += " for-loop " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_RANGE: {
+
+					txt += " for-init-range " + DADDR(5) + " in " + DADDR(2) + " counter " + DADDR(1) + " step " + DADDR(3) + " end " + itos(code[ip + 4]);
+					incr += 6;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_RANGE: {
+
+					txt += " for-loop-range " + DADDR(5) + " to " + DADDR(2) + " counter " + DADDR(1) + " step " + DADDR(3) + " end " + itos(code[ip + 4]);
+					incr += 6;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_ARRAY: {
+
+					txt += " for-init-array " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					incr += 5;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_ARRAY: {
+
+					txt += " for-loop-array " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					incr += 5;
+
 				} break;
 				case GDScriptFunction::OPCODE_LINE: {
 
@@ -941,8 +1086,315 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+// Every benchmark has an untyped and a typed version of the same loop, the typed one is
+// where the compiler can emit the specialized opcodes.
+struct Benchmark {
+	const char *name;
+	const char *untyped;
+	const char *typed;
+};
+
+static const Benchmark benchmarks[] = {
+	{ "int arithmetic",
+			"func run():\n"
+			"\tvar n = 1000000\n"
+			"\tvar total = 0\n"
+			"\tfor i in n:\n"
+			"\t\ttotal = (total + i * 7) % 10007\n"
+			"\treturn total\n",
+			"func run():\n"
+			"\tvar total: int = 0\n"
+			"\tfor i in range(1000000):\n"
+			"\t\ttotal = (total + i * 7) % 10007\n"
+			"\treturn total\n" },
+	{ "float arithmetic",
+			"func run():\n"
+			"\tvar n = 1000000\n"
+			"\tvar x = 0.0\n"
+			"\tfor i in n:\n"
+			"\t\tx = x * 0.5 + i / 1000.0\n"
+			"\treturn x\n",
+			"func run():\n"
+			"\tvar x: float = 0.0\n"
+			"\tfor i in range(1000000):\n"
+			"\t\tx = x * 0.5 + i / 1000.0\n"
+			"\treturn x\n" },
+	{ "vector math",
+			"func run():\n"
+			"\tvar n = 1000000\n"
+			"\tvar p = Vector2()\n"
+			"\tvar v = Vector2(1.0, 0.5)\n"
+			"\tvar q = Vector3()\n"
+			"\tfor i in n:\n"
+			"\t\tp = p + v * 0.016\n"
+			"\t\tq = q - Vector3(0.5, 1.0, 2.0) / 4.0\n"
+			"\t\tif p.x > 100.0:\n"
+			"\t\t\tp.x = 0.0\n"
+			"\treturn p + Vector2(q.x, q.y)\n",
+			"func run():\n"
+			"\tvar p: Vector2 = Vector2()\n"
+			"\tvar v: Vector2 = Vector2(1.0, 0.5)\n"
+			"\tvar q: Vector3 = Vector3()\n"
+			"\tfor i in range(1000000):\n"
+			"\t\tp = p + v * 0.016\n"
+			"\t\tq = q - Vector3(0.5, 1.0, 2.0) / 4.0\n"
+			"\t\tif p.x > 100.0:\n"
+			"\t\t\tp.x = 0.0\n"
+			"\treturn p + Vector2(q.x, q.y)\n" },
+	{ "member access",
+			"var pos = Vector2()\n"
+			"var color = Color(0.1, 0.2, 0.3)\n"
+			"func run():\n"
+			"\tvar n = 1000000\n"
+			"\tvar dir = Vector2(3.0, 4.0)\n"
+			"\tfor i in n:\n"
+			"\t\tpos.x += dir.normalized().x\n"
+			"\t\tpos.y = pos.x * 0.5\n"
+			"\t\tcolor.a = color.r + color.g\n"
+			"\treturn pos.length() + color.a\n",
+			"var pos: Vector2 = Vector2()\n"
+			"var color: Color = Color(0.1, 0.2, 0.3)\n"
+			"func run():\n"
+			"\tvar dir: Vector2 = Vector2(3.0, 4.0)\n"
+			"\tfor i in range(1000000):\n"
+			"\t\tpos.x += dir.normalized().x\n"
+			"\t\tpos.y = pos.x * 0.5\n"
+			"\t\tcolor.a = color.r + color.g\n"
+			"\treturn pos.length() + color.a\n" },
+	{ "array iteration",
+			"func run():\n"
+			"\tvar values = []\n"
+			"\tfor i in 1000:\n"
+			"\t\tvalues.append(i)\n"
+			"\tvar total = 0\n"
+			"\tvar n = 1000\n"
+			"\tfor r in n:\n"
+			"\t\tfor v in values:\n"
+			"\t\t\ttotal += v\n"
+			"\treturn total\n",
+			"func run():\n"
+			"\tvar values: Array = []\n"
+			"\tfor i in range(1000):\n"
+			"\t\tvalues.append(i)\n"
+			"\tvar total: int = 0\n"
+			"\tfor r in range(1000):\n"
+			"\t\tfor v in values:\n"
+			"\t\t\ttotal += v\n"
+			"\treturn total\n" },
+	{ "branches",
+			"func run():\n"
+			"\tvar i = 0\n"
+			"\tvar count = 0\n"
+			"\twhile i < 1000000:\n"
+			"\t\tif i % 3 == 0 or i % 5 == 0:\n"
+			"\t\t\tcount += 1\n"
+			"\t\telif count > i:\n"
+			"\t\t\tcount = 0\n"
+			"\t\ti += 1\n"
+			"\treturn count\n",
+			"func run():\n"
+			"\tvar i: int = 0\n"
+			"\tvar count: int = 0\n"
+			"\twhile i < 1000000:\n"
+			"\t\tif i % 3 == 0 or i % 5 == 0:\n"
+			"\t\t\tcount += 1\n"
+			"\t\telif count > i:\n"
+			"\t\t\tcount = 0\n"
+			"\t\ti += 1\n"
+			"\treturn count\n" },
+	{ "native members",
+			"extends Node2D\n"
+			"func run():\n"
+			"\tvar n = 1000000\n"
+			"\tvar total = 0.0\n"
+			"\trotation = 0.25\n"
+			"\tfor i in n:\n"
+			"\t\tif rotation < 1.0:\n"
+			"\t\t\ttotal += rotation * 2.0\n"
+			"\t\ttotal -= z_index + 1\n"
+			"\treturn total\n",
+			"extends Node2D\n"
+			"func run():\n"
+			"\tvar total: float = 0.0\n"
+			"\trotation = 0.25\n"
+			"\tfor i in range(1000000):\n"
+			"\t\tif rotation < 1.0:\n"
+			"\t\t\ttotal += rotation * 2.0\n"
+			"\t\ttotal -= z_index + 1\n"
+			"\treturn total\n" },
+};
+
+static uint64_t _run_benchmark(const String &p_code, Variant &r_result) {
+
+	// benchmarks extend Reference unless they need another base
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(p_code.begins_with("extends ") ? p_code : "extends Reference\n" + p_code);
+	Error err = script->reload();
+	ERR_FAIL_COND_V_MSG(err != OK, 0, "Benchmark script failed to compile:\n" + p_code);
+
+	Object *instance = ClassDB::instance(script->get_instance_base_type());
+	ERR_FAIL_COND_V(!instance, 0);
+	Ref<Reference> reference = Object::cast_to<Reference>(instance);
+	instance->set_script(script.get_ref_ptr());
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	r_result = instance->call("run");
+	uint64_t time = OS::get_singleton()->get_ticks_usec() - begin;
+
+	if (reference.is_null()) {
+		memdelete(instance);
+	}
+	return time;
+}
+
+static void _run_benchmarks() {
+
+	for (unsigned int i = 0; i < sizeof(benchmarks) / sizeof(Benchmark); i++) {
+
+		Variant untyped_result;
+		Variant typed_result;
+		uint64_t untyped = _run_benchmark(benchmarks[i].untyped, untyped_result);
+		uint64_t typed = _run_benchmark(benchmarks[i].typed, typed_result);
+
+		// the same scripts compiled without superinstructions and with OPCODE_LINE
+		Variant untyped_plain_result;
+		Variant typed_plain_result;
+		GDScriptCompiler::set_superinstructions_enabled(false);
+		uint64_t untyped_plain = _run_benchmark(benchmarks[i].untyped, untyped_plain_result);
+		uint64_t typed_plain = _run_benchmark(benchmarks[i].typed, typed_plain_result);
+		GDScriptCompiler::set_superinstructions_enabled(true);
+
+		OS::get_singleton()->print("%s: untyped %d usec, typed %d usec (%.2fx), without superinstructions untyped %d usec, typed %d usec\n", benchmarks[i].name, (int)untyped, (int)typed, typed ? (double)untyped / typed : 0.0, (int)untyped_plain, (int)typed_plain);
+
+		if (untyped_result != typed_result) {
+			ERR_PRINT(String("Benchmark '") + benchmarks[i].name + "' returned " + String(untyped_result) + " untyped but " + String(typed_result) + " typed.");
+		}
+		if (untyped_plain_result != typed_plain_result) {
+			ERR_PRINT(String("Benchmark '") + benchmarks[i].name + "' returned " + String(untyped_plain_result) + " untyped but " + String(typed_plain_result) + " typed without superinstructions.");
+		}
+		if (untyped_plain_result != untyped_result || typed_plain_result != typed_result) {
+			ERR_PRINT(String("Benchmark '") + benchmarks[i].name + "' returned " + String(untyped_plain_result) + " untyped and " + String(typed_plain_result) + " typed without superinstructions but " + String(untyped_result) + " and " + String(typed_result) + " with them.");
+		}
+	}
+}
+
+// A script of the size found in larger projects, loaded the three ways an exported
+// game can ship it: as source, as tokens and as compiled bytecode.
+static String _make_startup_script() {
+
+	String code = "extends Reference\n\nsignal changed(value)\n\nconst SPEED = 4.5\n\n";
+	code += "class Inner:\n\tvar value = 0\n\tfunc add(p_x):\n\t\tvalue += p_x\n\t\treturn value\n\n";
+	code += "var counter: int = 0\nvar position := Vector2()\n\n";
+	const String function =
+			"func step_$N(a: int, b: float) -> float:\n"
+			"\tvar total := 0.0\n"
+			"\tfor i in range(a):\n"
+			"\t\tif i % 2 == 0:\n"
+			"\t\t\ttotal += b * i + SPEED\n"
+			"\t\telse:\n"
+			"\t\t\ttotal -= Vector2(i, b).length()\n"
+			"\tposition += Vector2(total, $N)\n"
+			"\tcounter += 1\n"
+			"\temit_signal(\"changed\", counter)\n"
+			"\treturn total + Inner.new().add($N)\n\n";
+	for (int i = 0; i < 200; i++) {
+		code += function.replace("$N", itos(i));
+	}
+	return code;
+}
+
+static bool _write_startup_file(const String &p_path, const Vector<uint8_t> &p_data) {
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
+	ERR_FAIL_COND_V_MSG(!f, false, "Cannot write '" + p_path + "'.");
+	f->store_buffer(p_data.ptr(), p_data.size());
+	f->close();
+	memdelete(f);
+	return true;
+}
+
+static void _run_startup_benchmark() {
+
+	const int loads = 20;
+	const char *modes[] = { "source", "tokens", "compiled" };
+
+	String code = _make_startup_script();
+	String dir = OS::get_singleton()->get_cache_path();
+	String paths[3] = {
+		dir.plus_file("gdscript_startup_benchmark.gd"),
+		dir.plus_file("gdscript_startup_benchmark.gdc"),
+		dir.plus_file("gdscript_startup_benchmark_compiled.gdc"),
+	};
+
+	CharString utf8 = code.utf8();
+	Vector<uint8_t> source;
+	source.resize(utf8.length());
+	copymem(source.ptrw(), utf8.get_data(), utf8.length());
+	Vector<uint8_t> tokens = GDScriptTokenizerBuffer::parse_code_string(code);
+	Vector<uint8_t> compiled = GDScriptBytecode::make_compiled_buffer(code, paths[0], tokens);
+	ERR_FAIL_COND_MSG(compiled.empty(), "Startup benchmark script could not be compiled.");
+
+	if (!_write_startup_file(paths[0], source) || !_write_startup_file(paths[1], tokens) || !_write_startup_file(paths[2], compiled)) {
+		return;
+	}
+
+	uint64_t times[3] = { 0, 0, 0 };
+	Variant results[3];
+
+	for (int mode = 0; mode < 3; mode++) {
+
+		Ref<GDScript> script;
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < loads; i++) {
+			script.instance();
+			script->set_script_path(paths[0]);
+			Error err;
+			if (mode == 0) {
+				err = script->load_source_code(paths[0]);
+				if (err == OK) {
+					err = script->reload();
+				}
+			} else {
+				err = script->load_byte_code(paths[mode]);
+			}
+			if (err != OK) {
+				ERR_PRINT(String("Startup benchmark failed to load the script from ") + modes[mode] + ".");
+				script.unref();
+				break;
+			}
+		}
+		times[mode] = (OS::get_singleton()->get_ticks_usec() - begin) / loads;
+
+		// the loaded scripts must behave the same
+		if (script.is_valid()) {
+			Ref<Reference> instance = memnew(Reference);
+			instance->set_script(script.get_ref_ptr());
+			results[mode] = instance->call("step_7", 10, 0.5);
+		}
+	}
+
+	OS::get_singleton()->print("startup (%d functions): source %d usec, tokens %d usec, compiled %d usec per script\n", 200, (int)times[0], (int)times[1], (int)times[2]);
+
+	for (int mode = 1; mode < 3; mode++) {
+		if (results[mode] != results[0]) {
+			ERR_PRINT(String("Startup benchmark returned ") + String(results[mode]) + " loaded from " + modes[mode] + " but " + String(results[0]) + " from source.");
+		}
+	}
+
+	for (int i = 0; i < 3; i++) {
+		DirAccess::remove_file_or_error(paths[i]);
+	}
+}
+
 MainLoop *test(TestType p_type) {
 
+	if (p_type == TEST_BENCHMARK) {
+		_run_benchmarks();
+		_run_startup_benchmark();
+		return NULL;
+	}
+
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
 	if (cmdlargs.empty()) {
@@ -39,6 +39,7 @@
 #include "test_gdscript.h"
 #include "test_gui.h"
 #include "test_math.h"
+#include "test_message_queue.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
@@ -46,6 +47,7 @@
 #include "test_render.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_string_name.h"
 
 const char **tests_get_names() {
 
@@ -63,8 +65,11 @@ const char **tests_get_names() {
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_benchmark",
 		"ordered_hash_map",
 		"astar",
+		"string_name",
+		"message_queue",
 		NULL
 	};
 
@@ -140,6 +145,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_benchmark") {
+
+		return TestGDScript::test(TestGDScript::TEST_BENCHMARK);
+	}
+
 	if (p_test == "ordered_hash_map") {
 
 		return TestOrderedHashMap::test();
@@ -150,6 +160,16 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "string_name") {
+
+		return TestStringName::test();
+	}
+
+	if (p_test == "message_queue") {
+
+		return TestMessageQueue::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
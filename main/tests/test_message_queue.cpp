@@ -0,0 +1,148 @@
+/*************************************************************************/
+/*  test_message_queue.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_message_queue.h"
+
+#include "core/message_queue.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/reference.h"
+
+namespace TestMessageQueue {
+
+// a call with one argument takes 56 bytes of its thread's buffer, this has
+// to stay within the default max_size_kb
+enum {
+	CALLS_PER_THREAD = 10000
+};
+
+class Counter : public Reference {
+
+	GDCLASS(Counter, Reference);
+
+public:
+	int calls;
+	int last_order;
+	bool ordered;
+
+	void count(int p_order) {
+		calls++;
+		// calls of one thread run in the order they were pushed
+		if (p_order % CALLS_PER_THREAD != 0 && p_order != last_order + 1)
+			ordered = false;
+		last_order = p_order;
+	}
+
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("count", "order"), &Counter::count);
+	}
+
+	Counter() {
+		calls = 0;
+		last_order = -1;
+		ordered = true;
+	}
+};
+
+struct ProducerData {
+	ObjectID target;
+	int first;
+};
+
+static void producer_thread(void *p_userdata) {
+
+	ProducerData &data = *(ProducerData *)p_userdata;
+	StringName method = "count";
+
+	for (int i = 0; i < CALLS_PER_THREAD; i++) {
+		MessageQueue::get_singleton()->push_call(data.target, method, data.first + i);
+	}
+}
+
+static void run(int p_threads) {
+
+	Vector<Ref<Counter> > counters;
+	Vector<ProducerData> data;
+	Vector<Thread *> threads;
+	counters.resize(p_threads);
+	data.resize(p_threads);
+	threads.resize(p_threads);
+
+	for (int i = 0; i < p_threads; i++) {
+		counters.write[i].instance();
+		data.write[i].target = counters[i]->get_instance_id();
+		data.write[i].first = i * CALLS_PER_THREAD;
+	}
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_threads; i++) {
+		threads.write[i] = Thread::create(producer_thread, &data.write[i]);
+	}
+	for (int i = 0; i < p_threads; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	uint64_t pushed = OS::get_singleton()->get_ticks_usec();
+
+	MessageQueue::get_singleton()->flush();
+
+	uint64_t flushed = OS::get_singleton()->get_ticks_usec();
+
+	bool ok = true;
+	for (int i = 0; i < p_threads; i++) {
+		if (counters[i]->calls != CALLS_PER_THREAD || !counters[i]->ordered)
+			ok = false;
+	}
+
+	int calls = p_threads * CALLS_PER_THREAD;
+	OS::get_singleton()->print("\t%d producer(s): %d calls, pushed in %d usec (%d calls/msec), flushed in %d usec (%d calls/msec): %s\n",
+			p_threads, calls,
+			(int)(pushed - begin), (int)(calls * 1000LL / MAX(pushed - begin, (uint64_t)1)),
+			(int)(flushed - pushed), (int)(calls * 1000LL / MAX(flushed - pushed, (uint64_t)1)),
+			ok ? "OK" : "FAIL");
+}
+
+MainLoop *test() {
+
+	ClassDB::register_class<Counter>();
+
+	OS::get_singleton()->print("\n\nTest 1: Deferred calls from several threads\n");
+
+	MessageQueue::get_singleton()->flush();
+
+	run(1);
+	run(4);
+	run(16);
+
+	return NULL;
+}
+} // namespace TestMessageQueue
@@ -30,45 +30,52 @@
 
 #include "test_ordered_hash_map.h"
 
+#include "core/compact_hash_map.h"
 #include "core/ordered_hash_map.h"
 #include "core/os/os.h"
 #include "core/pair.h"
+#include "core/variant.h"
 #include "core/vector.h"
 
 namespace TestOrderedHashMap {
 
+template <class M>
 bool test_insert() {
-	OrderedHashMap<int, int> map;
-	OrderedHashMap<int, int>::Element e = map.insert(42, 84);
+	M map;
+	typename M::Element e = map.insert(42, 84);
 
 	return e && e.key() == 42 && e.get() == 84 && e.value() == 84 && map[42] == 84 && map.has(42) && map.find(42);
 }
 
+template <class M>
 bool test_insert_overwrite() {
-	OrderedHashMap<int, int> map;
+	M map;
 	map.insert(42, 84);
 	map.insert(42, 1234);
 
 	return map[42] == 1234;
 }
 
+template <class M>
 bool test_erase_via_element() {
-	OrderedHashMap<int, int> map;
-	OrderedHashMap<int, int>::Element e = map.insert(42, 84);
+	M map;
+	typename M::Element e = map.insert(42, 84);
 
 	map.erase(e);
 	return !e && !map.has(42) && !map.find(42);
 }
 
+template <class M>
 bool test_erase_via_key() {
-	OrderedHashMap<int, int> map;
+	M map;
 	map.insert(42, 84);
 	map.erase(42);
 	return !map.has(42) && !map.find(42);
 }
 
+template <class M>
 bool test_size() {
-	OrderedHashMap<int, int> map;
+	M map;
 	map.insert(42, 84);
 	map.insert(123, 84);
 	map.insert(123, 84);
@@ -78,8 +85,9 @@ bool test_size() {
 	return map.size() == 4;
 }
 
+template <class M>
 bool test_iteration() {
-	OrderedHashMap<int, int> map;
+	M map;
 	map.insert(42, 84);
 	map.insert(123, 12385);
 	map.insert(0, 12934);
@@ -93,7 +101,7 @@ bool test_iteration() {
 	expected.push_back(Pair<int, int>(123485, 1238888));
 
 	int idx = 0;
-	for (OrderedHashMap<int, int>::Element E = map.front(); E; E = E.next()) {
+	for (typename M::Element E = map.front(); E; E = E.next()) {
 		if (expected[idx] != Pair<int, int>(E.key(), E.value())) {
 			return false;
 		}
@@ -102,7 +110,8 @@ bool test_iteration() {
 	return true;
 }
 
-bool test_const_iteration(const OrderedHashMap<int, int> &map) {
+template <class M>
+bool test_const_iteration(const M &map) {
 	Vector<Pair<int, int> > expected;
 	expected.push_back(Pair<int, int>(42, 84));
 	expected.push_back(Pair<int, int>(123, 111111));
@@ -110,7 +119,7 @@ bool test_const_iteration(const OrderedHashMap<int, int> &map) {
 	expected.push_back(Pair<int, int>(123485, 1238888));
 
 	int idx = 0;
-	for (OrderedHashMap<int, int>::ConstElement E = map.front(); E; E = E.next()) {
+	for (typename M::ConstElement E = map.front(); E; E = E.next()) {
 		if (expected[idx] != Pair<int, int>(E.key(), E.value())) {
 			return false;
 		}
@@ -119,28 +128,146 @@ bool test_const_iteration(const OrderedHashMap<int, int> &map) {
 	return true;
 }
 
+template <class M>
 bool test_const_iteration() {
-	OrderedHashMap<int, int> map;
+	M map;
 	map.insert(42, 84);
 	map.insert(123, 12385);
 	map.insert(0, 12934);
 	map.insert(123485, 1238888);
 	map.insert(123, 111111);
 
-	return test_const_iteration(map);
+	return test_const_iteration<M>(map);
+}
+
+template <class M>
+bool test_erase_keeps_order() {
+	M map;
+	for (int i = 0; i < 1000; i++) {
+		map.insert(i, i);
+	}
+	for (int i = 0; i < 1000; i += 2) {
+		map.erase(i);
+	}
+	// grows the map while it has holes
+	for (int i = 1000; i < 3000; i++) {
+		map.insert(i, i);
+	}
+
+	int expected = 1;
+	for (typename M::Element E = map.front(); E; E = E.next()) {
+		if (E.key() != expected || E.value() != expected) {
+			return false;
+		}
+		expected += expected < 999 ? 2 : 1;
+	}
+	return expected == 3000 && map.size() == 2500;
+}
+
+template <class M>
+static uint64_t benchmark_insert(M &r_map, const Vector<Variant> &p_keys) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_keys.size(); i++) {
+		r_map[p_keys[i]] = i;
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+template <class M>
+static uint64_t benchmark_lookup(const M &p_map, const Vector<Variant> &p_keys, int &r_found) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_keys.size(); i++) {
+		if (p_map.find(p_keys[i]))
+			r_found++;
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+template <class M>
+static uint64_t benchmark_iterate(const M &p_map, int &r_sum) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (typename M::ConstElement E = p_map.front(); E; E = E.next()) {
+		r_sum += (int)E.value();
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+template <class M>
+static uint64_t benchmark_erase(M &r_map, const Vector<Variant> &p_keys) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_keys.size(); i += 2) {
+		r_map.erase(p_keys[i]);
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+// Many small maps with the same keys, like dictionaries used as structs.
+template <class M>
+static uint64_t benchmark_small(const Vector<Variant> &p_keys, int p_maps) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_maps; i++) {
+		M map;
+		for (int j = 0; j < p_keys.size(); j++) {
+			map[p_keys[j]] = j;
+		}
+		for (int j = 0; j < p_keys.size(); j++) {
+			map[p_keys[j]] = (int)map[p_keys[j]] + i;
+		}
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+template <class M>
+static void benchmark(const char *p_name, const Vector<Variant> &p_keys, const Vector<Variant> &p_small_keys) {
+
+	M map;
+	int found = 0;
+	int sum = 0;
+
+	uint64_t insert = benchmark_insert(map, p_keys);
+	uint64_t lookup = benchmark_lookup(map, p_keys, found);
+	uint64_t iterate = benchmark_iterate(map, sum);
+	uint64_t erase = benchmark_erase(map, p_keys);
+	uint64_t iterate_erased = benchmark_iterate(map, sum);
+	uint64_t small = benchmark_small<M>(p_small_keys, 10000);
+
+	OS::get_singleton()->print("	%s: insert %d, lookup %d, iterate %d, erase half %d, iterate after erase %d, 10000 small maps %d usec (%d found)\n",
+			p_name, (int)insert, (int)lookup, (int)iterate, (int)erase, (int)iterate_erased, (int)small, found);
+}
+
+static void benchmark_keys(const char *p_title, const Vector<Variant> &p_keys, const Vector<Variant> &p_small_keys) {
+
+	OS::get_singleton()->print("\n%s, %d keys\n", p_title, p_keys.size());
+
+	benchmark<OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> >("OrderedHashMap", p_keys, p_small_keys);
+	benchmark<CompactHashMap<Variant, Variant, VariantHasher, VariantComparator> >("CompactHashMap", p_keys, p_small_keys);
 }
 
 typedef bool (*TestFunc)(void);
 
 TestFunc test_funcs[] = {
 
-	test_insert,
-	test_insert_overwrite,
-	test_erase_via_element,
-	test_erase_via_key,
-	test_size,
-	test_iteration,
-	test_const_iteration,
+	test_insert<OrderedHashMap<int, int> >,
+	test_insert_overwrite<OrderedHashMap<int, int> >,
+	test_erase_via_element<OrderedHashMap<int, int> >,
+	test_erase_via_key<OrderedHashMap<int, int> >,
+	test_size<OrderedHashMap<int, int> >,
+	test_iteration<OrderedHashMap<int, int> >,
+	test_const_iteration<OrderedHashMap<int, int> >,
+	test_insert<CompactHashMap<int, int> >,
+	test_insert_overwrite<CompactHashMap<int, int> >,
+	test_erase_via_element<CompactHashMap<int, int> >,
+	test_erase_via_key<CompactHashMap<int, int> >,
+	test_size<CompactHashMap<int, int> >,
+	test_iteration<CompactHashMap<int, int> >,
+	test_const_iteration<CompactHashMap<int, int> >,
+	test_erase_keeps_order<OrderedHashMap<int, int> >,
+	test_erase_keeps_order<CompactHashMap<int, int> >,
 	0
 
 };
@@ -168,6 +295,25 @@ MainLoop *test() {
 
 	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
 
+	const int key_count = 100000;
+	Vector<Variant> int_keys;
+	Vector<Variant> string_keys;
+	for (int i = 0; i < key_count; i++) {
+		int_keys.push_back(i * 7919);
+		string_keys.push_back("key_" + itos(i));
+	}
+
+	Vector<Variant> small_keys;
+	small_keys.push_back("name");
+	small_keys.push_back("position");
+	small_keys.push_back("health");
+	small_keys.push_back("speed");
+	small_keys.push_back("target");
+	small_keys.push_back("state");
+
+	benchmark_keys("Integer keys", int_keys, small_keys);
+	benchmark_keys("String keys", string_keys, small_keys);
+
 	return NULL;
 }
 } // namespace TestOrderedHashMap
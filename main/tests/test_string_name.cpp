@@ -0,0 +1,150 @@
+/*************************************************************************/
+/*  test_string_name.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_string_name.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_name.h"
+
+namespace TestStringName {
+
+enum {
+	NAME_COUNT = 4096,
+	ROUNDS = 64
+};
+
+struct InternData {
+	const Vector<String> *names;
+	int offset;
+	Vector<StringName> interned; // what the last round interned, by name index
+};
+
+// What resource loaders and scripts do with the names they parse: intern
+// them, compare them, and drop them again.
+static void intern_thread(void *p_userdata) {
+
+	InternData &data = *(InternData *)p_userdata;
+	const Vector<String> &names = *data.names;
+
+	for (int r = 0; r < ROUNDS - 1; r++) {
+		for (int i = 0; i < names.size(); i++) {
+			StringName name = names[(i + data.offset) % names.size()];
+		}
+	}
+
+	data.interned.resize(names.size());
+	for (int i = 0; i < names.size(); i++) {
+		int index = (i + data.offset) % names.size();
+		data.interned.write[index] = names[index];
+	}
+}
+
+// Every thread must have interned the same entry as the main thread for the
+// names it keeps alive, and the same entry as the first thread for the rest.
+static bool check(const Vector<InternData> &p_data, const Vector<StringName> &p_interned) {
+
+	for (int i = 0; i < p_data.size(); i++) {
+		const Vector<StringName> &names = p_data[i].interned;
+		for (int j = 0; j < names.size(); j++) {
+			const void *expected = (j % 2 == 0) ? p_interned[j / 2].data_unique_pointer() : p_data[0].interned[j].data_unique_pointer();
+			if (names[j].data_unique_pointer() != expected) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static uint64_t run(const Vector<String> &p_names, const Vector<StringName> &p_interned, int p_threads, bool &r_ok) {
+
+	Vector<InternData> data;
+	data.resize(p_threads);
+	Vector<Thread *> threads;
+	threads.resize(p_threads);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_threads; i++) {
+		data.write[i].names = &p_names;
+		data.write[i].offset = i * 997;
+		threads.write[i] = Thread::create(intern_thread, &data.write[i]);
+	}
+
+	for (int i = 0; i < p_threads; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+	r_ok = check(data, p_interned);
+	return usec;
+}
+
+MainLoop *test() {
+
+	OS::get_singleton()->print("\n\nTest 1: Interning from several threads\n");
+
+	Vector<String> names;
+	for (int i = 0; i < NAME_COUNT; i++) {
+		names.push_back("property_" + itos(i));
+	}
+
+	// names that live on, like the ones bound by ClassDB
+	Vector<StringName> interned;
+	for (int i = 0; i < NAME_COUNT; i += 2) {
+		interned.push_back(names[i]);
+	}
+
+	bool ok = true;
+	for (int i = 0; i < interned.size(); i++) {
+		if (StringName(names[i * 2]) != interned[i] || StringName::search(names[i * 2]) != interned[i]) {
+			ok = false;
+		}
+	}
+	OS::get_singleton()->print("\tSame names intern to the same entry: %s\n", ok ? "OK" : "FAIL");
+
+	int max_threads = MAX(OS::get_singleton()->get_processor_count(), 1);
+	for (int threads = 1;; threads = MIN(threads * 2, max_threads)) {
+
+		bool same = false;
+		uint64_t usec = run(names, interned, threads, same);
+		uint64_t lookups = (uint64_t)threads * ROUNDS * NAME_COUNT;
+		OS::get_singleton()->print("\t%d thread(s): %d lookups in %d usec, %d lookups/msec, same entries across threads: %s\n", threads, (int)lookups, (int)usec, (int)(lookups * 1000 / MAX(usec, (uint64_t)1)), same ? "OK" : "FAIL");
+
+		if (threads == max_threads) {
+			break;
+		}
+	}
+
+	return NULL;
+}
+} // namespace TestStringName
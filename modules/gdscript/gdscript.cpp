@@ -37,7 +37,10 @@
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "gdscript_bytecode.h"
 #include "gdscript_compiler.h"
+#include "gdscript_precompiler.h"
+#include "scene/resources/packed_scene.h"
 
 #include "modules/tich/TichInfo.h"
 
@@ -594,6 +597,8 @@ Error GDScript::reload(bool p_keep_state) {
 	}
 
 	valid = false;
+	SceneState::clear_property_cache();
+
 	GDScriptParser parser;
 	Error err = parser.parse(source, basedir, false, path);
 	if (err) {
@@ -799,6 +804,25 @@ Error GDScript::load_byte_code(const String &p_path) {
 		basedir = basedir.get_base_dir();
 
 	valid = false;
+
+	// compiled code skips the parser and the compiler, unless the debugger needs what they add
+	if (GDScriptBytecode::is_compiled_buffer(bytecode)) {
+		if (!ScriptDebugger::get_singleton() && GDScriptBytecode::load(bytecode, this) == OK) {
+
+			valid = true;
+
+			for (Map<StringName, Ref<GDScript> >::Element *E = subclasses.front(); E; E = E->next()) {
+
+				_set_subclass_path(E->get(), path);
+			}
+
+			return OK;
+		}
+
+		bytecode = GDScriptBytecode::get_tokens(bytecode);
+		ERR_FAIL_COND_V(bytecode.size() == 0, ERR_PARSE_ERROR);
+	}
+
 	GDScriptParser parser;
 	Error err = parser.parse_bytecode(bytecode, basedir, get_path());
 	if (err) {
@@ -862,6 +886,15 @@ const Map<StringName, GDScriptFunction *> &GDScript::debug_get_member_functions(
 	return member_functions;
 }
 
+void GDScript::_update_member_names() {
+
+	member_names.resize(member_indices.size());
+	for (const Map<StringName, MemberInfo>::Element *E = member_indices.front(); E; E = E->next()) {
+		ERR_CONTINUE(E->get().index < 0 || E->get().index >= member_names.size());
+		member_names.write[E->get().index] = E->key();
+	}
+}
+
 StringName GDScript::debug_get_member_by_index(int p_idx) const {
 
 	for (const Map<StringName, MemberInfo>::Element *E = member_indices.front(); E; E = E->next()) {
@@ -1009,12 +1042,23 @@ GDScript::~GDScript() {
 //         INSTANCE         //
 //////////////////////////////
 
+// Scripts write their members in place, the owner's change journal only
+// sees the writes through set().
+void GDScriptInstance::_mark_member_changed(int p_index) {
+
+	ERR_FAIL_INDEX(p_index, script->member_names.size());
+	owner->mark_property_changed(script->member_names[p_index]);
+}
+
 bool GDScriptInstance::set(const StringName &p_name, const Variant &p_value) {
 
 	//member
 	{
 		const Map<StringName, GDScript::MemberInfo>::Element *E = script->member_indices.find(p_name);
 		if (E) {
+			if (unlikely(owner->is_change_tracking()))
+				owner->mark_property_changed(p_name);
+
 			const GDScript::MemberInfo *member = &E->get();
 			if (member->setter && !TichInfo::IsLoading()) {
 				const Variant *val = &p_value;
@@ -1447,14 +1491,22 @@ String GDScriptLanguage::get_name() const {
 
 void GDScriptLanguage::_add_global(const StringName &p_name, const Variant &p_value) {
 
+	if (lock) {
+		lock->lock();
+	}
+
 	if (globals.has(p_name)) {
 		//overwrite existing
 		global_array.write[globals[p_name]] = p_value;
-		return;
+	} else {
+		globals[p_name] = global_array.size();
+		global_array.push_back(p_value);
+		_global_array = global_array.ptrw();
+	}
+
+	if (lock) {
+		lock->unlock();
 	}
-	globals[p_name] = global_array.size();
-	global_array.push_back(p_value);
-	_global_array = global_array.ptrw();
 }
 
 void GDScriptLanguage::add_global_constant(const StringName &p_variable, const Variant &p_value) {
@@ -1463,12 +1515,31 @@ void GDScriptLanguage::add_global_constant(const StringName &p_variable, const V
 }
 
 void GDScriptLanguage::add_named_global_constant(const StringName &p_name, const Variant &p_value) {
+
+	if (lock) {
+		lock->lock();
+	}
+
 	named_globals[p_name] = p_value;
+
+	if (lock) {
+		lock->unlock();
+	}
 }
 
 void GDScriptLanguage::remove_named_global_constant(const StringName &p_name) {
-	ERR_FAIL_COND(!named_globals.has(p_name));
-	named_globals.erase(p_name);
+
+	if (lock) {
+		lock->lock();
+	}
+
+	bool found = named_globals.erase(p_name);
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	ERR_FAIL_COND(!found);
 }
 
 void GDScriptLanguage::init() {
@@ -1828,6 +1899,11 @@ void GDScriptLanguage::frame() {
 
 	calls = 0;
 
+	// the autoloads reference the scripts they need by now
+	if (!precompiled_scripts.empty()) {
+		precompiled_scripts.clear();
+	}
+
 #ifdef DEBUG_ENABLED
 	if (profiling) {
 		if (lock) {
@@ -2205,6 +2281,7 @@ GDScriptWarning::Code GDScriptWarning::get_code_from_name(const String &p_name)
 GDScriptLanguage::GDScriptLanguage() {
 
 	calls = 0;
+	compile_generation = 0;
 	ERR_FAIL_COND(singleton);
 	singleton = this;
 	strings._init = StaticCString::create("_init");
@@ -2225,6 +2302,8 @@ GDScriptLanguage::GDScriptLanguage() {
 	script_frame_time = 0;
 
 	_debug_call_stack_pos = 0;
+	GLOBAL_DEF("gdscript/startup/parallel_precompile", true);
+
 	int dmcs = GLOBAL_DEF("debug/settings/gdscript/max_call_stack", 1024);
 	ProjectSettings::get_singleton()->set_custom_property_info("debug/settings/gdscript/max_call_stack", PropertyInfo(Variant::INT, "debug/settings/gdscript/max_call_stack", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater")); //minimum is 1024
 
@@ -2265,21 +2344,55 @@ GDScriptLanguage::~GDScriptLanguage() {
 }
 
 void GDScriptLanguage::add_orphan_subclass(const String &p_qualified_name, const ObjectID &p_subclass) {
+	if (lock) {
+		lock->lock();
+	}
 	orphan_subclasses[p_qualified_name] = p_subclass;
+	if (lock) {
+		lock->unlock();
+	}
 }
 
 Ref<GDScript> GDScriptLanguage::get_orphan_subclass(const String &p_qualified_name) {
+	// scripts can be compiled on several threads at startup, see precompile_scripts()
+	if (lock) {
+		lock->lock();
+	}
+	ObjectID orphan_subclass = 0;
 	Map<String, ObjectID>::Element *orphan_subclass_element = orphan_subclasses.find(p_qualified_name);
-	if (!orphan_subclass_element)
+	if (orphan_subclass_element) {
+		orphan_subclass = orphan_subclass_element->get();
+		orphan_subclasses.erase(orphan_subclass_element);
+	}
+	if (lock) {
+		lock->unlock();
+	}
+	if (!orphan_subclass)
 		return Ref<GDScript>();
-	ObjectID orphan_subclass = orphan_subclass_element->get();
 	Object *obj = ObjectDB::get_instance(orphan_subclass);
-	orphan_subclasses.erase(orphan_subclass_element);
 	if (!obj)
 		return Ref<GDScript>();
 	return Ref<GDScript>(Object::cast_to<GDScript>(obj));
 }
 
+void GDScriptLanguage::precompile_scripts(const Vector<String> &p_paths) {
+
+#ifndef NO_THREADS
+	// compile errors have to reach the debugger from the main thread
+	if (ScriptDebugger::get_singleton()) {
+		return;
+	}
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (!pool || pool->get_thread_count() == 0 || !GLOBAL_GET("gdscript/startup/parallel_precompile")) {
+		return;
+	}
+
+	GDScriptPrecompiler precompiler;
+	precompiler.precompile(p_paths, &precompiled_scripts);
+#endif
+}
+
 /*************** RESOURCE ***************/
 
 RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_original_path, Error *r_error) {
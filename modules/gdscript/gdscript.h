@@ -72,6 +72,7 @@ class GDScript : public Script {
 	friend class GDScriptCompiler;
 	friend class GDScriptFunctions;
 	friend class GDScriptLanguage;
+	friend class GDScriptBytecode;
 
 	Variant _static_ref; //used for static call
 	Ref<GDScriptNativeClass> native;
@@ -83,6 +84,7 @@ class GDScript : public Script {
 	Map<StringName, Variant> constants;
 	Map<StringName, GDScriptFunction *> member_functions;
 	Map<StringName, MemberInfo> member_indices; //members are just indices to the instanced script.
+	Vector<StringName> member_names; //member_indices by index, for the change journal
 	Map<StringName, Ref<GDScript> > subclasses;
 	Map<StringName, Vector<StringName> > _signals;
 
@@ -119,6 +121,7 @@ class GDScript : public Script {
 	GDScriptInstance *_create_instance(const Variant **p_args, int p_argcount, Object *p_owner, bool p_isref, Variant::CallError &r_error);
 
 	void _set_subclass_path(Ref<GDScript> &p_sc, const String &p_path);
+	void _update_member_names();
 
 #ifdef TOOLS_ENABLED
 	Set<PlaceHolderScriptInstance *> placeholders;
@@ -240,6 +243,7 @@ class GDScriptInstance : public ScriptInstance {
 	SelfList<GDScriptFunctionState>::List pending_func_states;
 
 	void _ml_call_reversed(GDScript *sptr, const StringName &p_method, const Variant **p_args, int p_argcount);
+	void _mark_member_changed(int p_index);
 
 public:
 	virtual Object *get_owner() { return owner; }
@@ -341,6 +345,13 @@ class GDScriptLanguage : public ScriptLanguage {
 		int *line;
 	};
 
+	// Code compiled without OPCODE_LINE doesn't update the line, it is looked up from the ip.
+	_FORCE_INLINE_ int _get_call_level_line(const CallLevel &p_level) const {
+		if (!p_level.line)
+			return 0;
+		return p_level.ip ? p_level.function->_get_line(*p_level.ip, *p_level.line) : *p_level.line;
+	}
+
 	int _debug_parse_err_line;
 	String _debug_parse_err_file;
 	String _debug_error;
@@ -363,8 +374,13 @@ class GDScriptLanguage : public ScriptLanguage {
 	bool profiling;
 	uint64_t script_frame_time;
 
+	uint32_t compile_generation;
+
 	Map<String, ObjectID> orphan_subclasses;
 
+	// Scripts loaded by precompile_scripts(), held until the main loop runs.
+	List<RES> precompiled_scripts;
+
 public:
 	int calls;
 
@@ -419,7 +435,7 @@ public:
 		Vector<StackInfo> csi;
 		csi.resize(_debug_call_stack_pos);
 		for (int i = 0; i < _debug_call_stack_pos; i++) {
-			csi.write[_debug_call_stack_pos - i - 1].line = _call_stack[i].line ? *_call_stack[i].line : 0;
+			csi.write[_debug_call_stack_pos - i - 1].line = _get_call_level_line(_call_stack[i]);
 			if (_call_stack[i].function) {
 				csi.write[_debug_call_stack_pos - i - 1].func = _call_stack[i].function->get_name();
 				csi.write[_debug_call_stack_pos - i - 1].file = _call_stack[i].function->get_script()->get_path();
@@ -446,6 +462,11 @@ public:
 
 	_FORCE_INLINE_ static GDScriptLanguage *get_singleton() { return singleton; }
 
+	// Bumped by every compiled script. The call caches of the VM compare it to
+	// notice that the functions of the scripts they checked may have changed.
+	_FORCE_INLINE_ uint32_t get_compile_generation() const { return compile_generation; }
+	void bump_compile_generation() { atomic_increment(&compile_generation); }
+
 	virtual String get_name() const;
 
 	/* LANGUAGE FUNCTIONS */
@@ -510,6 +531,7 @@ public:
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
+	virtual void precompile_scripts(const Vector<String> &p_paths);
 
 	/* GLOBAL CLASSES */
 
@@ -0,0 +1,866 @@
+/*************************************************************************/
+/*  gdscript_bytecode.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_bytecode.h"
+
+#include "core/engine.h"
+#include "core/io/marshalls.h"
+
+#define COMPILED_VERSION 1
+
+// Layout: "GDSB", version hash, token buffer size, token buffer, compiled classes.
+
+enum {
+	VARIANT_VALUE,
+	VARIANT_ARRAY,
+	VARIANT_DICTIONARY,
+	VARIANT_NULL_OBJECT,
+	VARIANT_SCRIPT, // by qualified name, so inner classes are found again
+	VARIANT_RESOURCE, // by path
+	VARIANT_NATIVE_CLASS,
+};
+
+struct GDScriptBytecode::Writer {
+
+	Vector<uint8_t> buffer;
+	Vector<StringName> globals; // global array index to name
+
+	void put_32(uint32_t p_value) {
+		int pos = buffer.size();
+		buffer.resize(pos + 4);
+		encode_uint32(p_value, &buffer.write[pos]);
+	}
+
+	void put_string(const String &p_string) {
+		CharString cs = p_string.utf8();
+		put_32(cs.length());
+		int pos = buffer.size();
+		buffer.resize(pos + cs.length());
+		copymem(&buffer.write[pos], cs.get_data(), cs.length());
+	}
+};
+
+struct GDScriptBytecode::Reader {
+
+	const uint8_t *buffer;
+	int size;
+	int pos;
+	bool error;
+
+	String root; // the script as it was written, references to it are the script being loaded
+	GDScript *script;
+
+	uint32_t get_32() {
+		if (pos + 4 > size) {
+			error = true;
+			return 0;
+		}
+		uint32_t value = decode_uint32(&buffer[pos]);
+		pos += 4;
+		return value;
+	}
+
+	// element counts are bounded by the data left, a corrupt count must not allocate
+	int get_count() {
+		uint32_t count = get_32();
+		if (count > (uint32_t)(size - pos)) {
+			error = true;
+			return 0;
+		}
+		return count;
+	}
+
+	String get_string() {
+		int len = get_count();
+		if (error) {
+			return String();
+		}
+		String string;
+		string.parse_utf8((const char *)&buffer[pos], len);
+		pos += len;
+		return string;
+	}
+
+	Ref<GDScript> get_script(const String &p_name) {
+		Vector<String> names = p_name.split("::");
+		Ref<GDScript> found;
+		if (names[0] == root) {
+			found = Ref<GDScript>(script);
+		} else {
+			found = ResourceLoader::load(names[0]);
+		}
+		for (int i = 1; i < names.size() && found.is_valid(); i++) {
+			const Map<StringName, Ref<GDScript> >::Element *E = found->get_subclasses().find(names[i]);
+			found = E ? E->get() : Ref<GDScript>();
+		}
+		return found;
+	}
+
+	Ref<GDScriptNativeClass> get_native_class(const String &p_name) {
+		// registered without the underscore of the exposed core classes
+		String name = p_name.begins_with("_") ? p_name.substr(1, p_name.length()) : p_name;
+		const Map<StringName, int>::Element *E = GDScriptLanguage::get_singleton()->get_global_map().find(name);
+		if (!E) {
+			return Ref<GDScriptNativeClass>();
+		}
+		return GDScriptLanguage::get_singleton()->get_global_array()[E->get()];
+	}
+};
+
+uint32_t GDScriptBytecode::get_version_hash() {
+
+	// code is only valid for the engine build that compiled it
+	Dictionary version = Engine::get_singleton()->get_version_info();
+	uint32_t hash = hash_djb2_one_32(COMPILED_VERSION);
+	hash = hash_djb2_one_32(String(version["string"]).hash(), hash);
+	hash = hash_djb2_one_32(String(version["hash"]).hash(), hash);
+	hash = hash_djb2_one_32(GDScriptFunction::OPCODE_END, hash);
+	hash = hash_djb2_one_32(Variant::VARIANT_MAX, hash);
+	hash = hash_djb2_one_32(Variant::OP_MAX, hash);
+	return hash;
+}
+
+bool GDScriptBytecode::_write_variant(Writer &w, const Variant &p_variant) {
+
+	switch (p_variant.get_type()) {
+		case Variant::OBJECT: {
+			Object *obj = p_variant;
+			if (!obj) {
+				w.put_32(VARIANT_NULL_OBJECT);
+				return true;
+			}
+
+			GDScript *script = Object::cast_to<GDScript>(obj);
+			if (script) {
+				if (!script->fully_qualified_name.begins_with("res://")) {
+					return false;
+				}
+				w.put_32(VARIANT_SCRIPT);
+				w.put_string(script->fully_qualified_name);
+				return true;
+			}
+
+			GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(obj);
+			if (native) {
+				w.put_32(VARIANT_NATIVE_CLASS);
+				w.put_string(native->get_name());
+				return true;
+			}
+
+			Resource *resource = Object::cast_to<Resource>(obj);
+			if (resource && resource->get_path().begins_with("res://") && resource->get_path().find("::") == -1) {
+				w.put_32(VARIANT_RESOURCE);
+				w.put_string(resource->get_path());
+				return true;
+			}
+
+			// any other object only exists at run time
+			return false;
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_variant;
+			w.put_32(VARIANT_ARRAY);
+			w.put_32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				if (!_write_variant(w, array[i])) {
+					return false;
+				}
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dictionary = p_variant;
+			List<Variant> keys;
+			dictionary.get_key_list(&keys);
+			w.put_32(VARIANT_DICTIONARY);
+			w.put_32(keys.size());
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				if (!_write_variant(w, E->get()) || !_write_variant(w, dictionary[E->get()])) {
+					return false;
+				}
+			}
+		} break;
+		default: {
+			int len;
+			Error err = encode_variant(p_variant, NULL, len, false);
+			ERR_FAIL_COND_V_MSG(err != OK, false, "Error when trying to encode Variant.");
+			w.put_32(VARIANT_VALUE);
+			int pos = w.buffer.size();
+			w.buffer.resize(pos + len);
+			encode_variant(p_variant, &w.buffer.write[pos], len, false);
+		} break;
+	}
+
+	return true;
+}
+
+bool GDScriptBytecode::_write_data_type(Writer &w, const GDScriptDataType &p_type) {
+
+	w.put_32(p_type.has_type);
+	w.put_32(p_type.kind);
+	w.put_32(p_type.builtin_type);
+	w.put_string(p_type.native_type);
+	return _write_variant(w, Variant(p_type.script_type));
+}
+
+bool GDScriptBytecode::_write_function(Writer &w, const GDScriptFunction *p_function) {
+
+	w.put_string(p_function->name);
+	w.put_32(p_function->_static);
+	w.put_32(p_function->rpc_mode);
+	w.put_32(p_function->_argument_count);
+	w.put_32(p_function->_stack_size);
+	w.put_32(p_function->_call_size);
+	w.put_32(p_function->_initial_line);
+
+	w.put_32(p_function->argument_types.size());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		if (!_write_data_type(w, p_function->argument_types[i])) {
+			return false;
+		}
+	}
+	if (!_write_data_type(w, p_function->return_type)) {
+		return false;
+	}
+
+	w.put_32(p_function->constants.size());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		if (!_write_variant(w, p_function->constants[i])) {
+			return false;
+		}
+	}
+
+	w.put_32(p_function->global_names.size());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		w.put_string(p_function->global_names[i]);
+	}
+
+	w.put_32(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		w.put_32(p_function->default_arguments[i]);
+	}
+
+	// the method pointers are looked up again when loading
+	w.put_32(p_function->validated_calls.size());
+	for (int i = 0; i < p_function->validated_calls.size(); i++) {
+		w.put_32(p_function->validated_calls[i].base_type);
+		w.put_string(p_function->validated_calls[i].name);
+	}
+
+	w.put_32(p_function->_method_bind_call_count);
+
+	// Global indices depend on what the running engine registered, they are stored by name.
+	// Other operands are indices, counts and jump targets, all below 1 << ADDR_BITS, so any
+	// word with a global address type is a global.
+	Vector<StringName> globals;
+	Vector<int> code = p_function->code;
+	for (int i = 0; i < code.size(); i++) {
+
+		int address_type = (code[i] & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS;
+		int address = code[i] & GDScriptFunction::ADDR_MASK;
+		StringName global;
+
+		if (address_type == GDScriptFunction::ADDR_TYPE_GLOBAL) {
+			ERR_FAIL_INDEX_V(address, w.globals.size(), false);
+			global = w.globals[address];
+#ifdef TOOLS_ENABLED
+		} else if (address_type == GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL) {
+			ERR_FAIL_INDEX_V(address, p_function->named_globals.size(), false);
+			global = p_function->named_globals[address];
+#endif
+		} else {
+			continue;
+		}
+
+		int index = globals.find(global);
+		if (index == -1) {
+			index = globals.size();
+			globals.push_back(global);
+		}
+		code.write[i] = index | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS);
+	}
+
+	w.put_32(globals.size());
+	for (int i = 0; i < globals.size(); i++) {
+		w.put_string(globals[i]);
+	}
+
+	w.put_32(code.size());
+	for (int i = 0; i < code.size(); i++) {
+		w.put_32(code[i]);
+	}
+
+	w.put_32(p_function->line_table.size());
+	for (int i = 0; i < p_function->line_table.size(); i++) {
+		w.put_32(p_function->line_table[i].first);
+		w.put_32(p_function->line_table[i].second);
+	}
+
+#ifdef TOOLS_ENABLED
+	w.put_32(p_function->arg_names.size());
+	for (int i = 0; i < p_function->arg_names.size(); i++) {
+		w.put_string(p_function->arg_names[i]);
+	}
+#else
+	w.put_32(0);
+#endif
+
+	return true;
+}
+
+void GDScriptBytecode::_write_class_tree(Writer &w, const GDScript *p_script) {
+
+	w.put_32(p_script->subclasses.size());
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		_write_class_tree(w, E->get().ptr());
+	}
+}
+
+bool GDScriptBytecode::_write_class(Writer &w, const GDScript *p_script) {
+
+	w.put_32(p_script->tool);
+	w.put_string(p_script->name);
+	w.put_string(p_script->native.is_valid() ? String(p_script->native->get_name()) : String());
+	if (!_write_variant(w, Variant(p_script->base))) {
+		return false;
+	}
+
+	w.put_32(p_script->members.size());
+	for (const Set<StringName>::Element *E = p_script->members.front(); E; E = E->next()) {
+		w.put_string(E->get());
+	}
+
+	w.put_32(p_script->member_indices.size());
+	for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get().index);
+		w.put_string(E->get().setter);
+		w.put_string(E->get().getter);
+		w.put_32(E->get().rpc_mode);
+		if (!_write_data_type(w, E->get().data_type)) {
+			return false;
+		}
+	}
+
+	w.put_32(p_script->member_info.size());
+	for (const Map<StringName, PropertyInfo>::Element *E = p_script->member_info.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get().type);
+		w.put_string(E->get().name);
+		w.put_string(E->get().class_name);
+		w.put_32(E->get().hint);
+		w.put_string(E->get().hint_string);
+		w.put_32(E->get().usage);
+	}
+
+	w.put_32(p_script->_signals.size());
+	for (const Map<StringName, Vector<StringName> >::Element *E = p_script->_signals.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get().size());
+		for (int i = 0; i < E->get().size(); i++) {
+			w.put_string(E->get()[i]);
+		}
+	}
+
+	w.put_32(p_script->constants.size());
+	for (const Map<StringName, Variant>::Element *E = p_script->constants.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		if (!_write_variant(w, E->get())) {
+			return false;
+		}
+	}
+
+	w.put_32(p_script->member_functions.size());
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		if (!_write_function(w, E->get())) {
+			return false;
+		}
+	}
+
+	w.put_32(p_script->subclasses.size());
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		if (!_write_class(w, E->get().ptr())) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool GDScriptBytecode::_read_variant(Reader &r, Variant &r_variant) {
+
+	switch (r.get_32()) {
+		case VARIANT_VALUE: {
+			int len;
+			Error err = decode_variant(r_variant, &r.buffer[r.pos], r.size - r.pos, &len, false);
+			if (err != OK) {
+				return false;
+			}
+			r.pos += len;
+		} break;
+		case VARIANT_ARRAY: {
+			int count = r.get_count();
+			Array array;
+			array.resize(count);
+			for (int i = 0; i < count; i++) {
+				if (!_read_variant(r, array[i])) {
+					return false;
+				}
+			}
+			r_variant = array;
+		} break;
+		case VARIANT_DICTIONARY: {
+			int count = r.get_count();
+			Dictionary dictionary;
+			for (int i = 0; i < count; i++) {
+				Variant key;
+				Variant value;
+				if (!_read_variant(r, key) || !_read_variant(r, value)) {
+					return false;
+				}
+				dictionary[key] = value;
+			}
+			r_variant = dictionary;
+		} break;
+		case VARIANT_NULL_OBJECT: {
+			r_variant = (Object *)NULL;
+		} break;
+		case VARIANT_SCRIPT: {
+			Ref<GDScript> script = r.get_script(r.get_string());
+			if (script.is_null()) {
+				return false;
+			}
+			r_variant = script;
+		} break;
+		case VARIANT_RESOURCE: {
+			RES resource = ResourceLoader::load(r.get_string());
+			if (resource.is_null()) {
+				return false;
+			}
+			r_variant = resource;
+		} break;
+		case VARIANT_NATIVE_CLASS: {
+			Ref<GDScriptNativeClass> native = r.get_native_class(r.get_string());
+			if (native.is_null()) {
+				return false;
+			}
+			r_variant = native;
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return !r.error;
+}
+
+bool GDScriptBytecode::_read_data_type(Reader &r, GDScriptDataType &r_type) {
+
+	r_type.has_type = r.get_32();
+	switch (r.get_32()) {
+		case GDScriptDataType::UNINITIALIZED: r_type.kind = GDScriptDataType::UNINITIALIZED; break;
+		case GDScriptDataType::BUILTIN: r_type.kind = GDScriptDataType::BUILTIN; break;
+		case GDScriptDataType::NATIVE: r_type.kind = GDScriptDataType::NATIVE; break;
+		case GDScriptDataType::SCRIPT: r_type.kind = GDScriptDataType::SCRIPT; break;
+		case GDScriptDataType::GDSCRIPT: r_type.kind = GDScriptDataType::GDSCRIPT; break;
+		default: return false;
+	}
+	uint32_t builtin_type = r.get_32();
+	if (builtin_type >= Variant::VARIANT_MAX) {
+		return false;
+	}
+	r_type.builtin_type = (Variant::Type)builtin_type;
+	r_type.native_type = r.get_string();
+
+	Variant script_type;
+	if (!_read_variant(r, script_type)) {
+		return false;
+	}
+	r_type.script_type = script_type;
+	return !r.error;
+}
+
+GDScriptFunction *GDScriptBytecode::_read_function(Reader &r, GDScript *p_script) {
+
+	GDScriptFunction *function = memnew(GDScriptFunction);
+
+#define READ_FAIL_COND(m_cond)              \
+	if (unlikely((m_cond) || r.error)) { \
+		memdelete(function);             \
+		return NULL;                     \
+	}
+
+	function->name = r.get_string();
+	function->_static = r.get_32();
+	function->rpc_mode = (MultiplayerAPI::RPCMode)r.get_32();
+	function->_argument_count = r.get_32();
+	function->_stack_size = r.get_32();
+	function->_call_size = r.get_32();
+	function->_initial_line = r.get_32();
+
+	function->argument_types.resize(r.get_count());
+	for (int i = 0; i < function->argument_types.size(); i++) {
+		READ_FAIL_COND(!_read_data_type(r, function->argument_types.write[i]));
+	}
+	READ_FAIL_COND(!_read_data_type(r, function->return_type));
+
+	function->constants.resize(r.get_count());
+	for (int i = 0; i < function->constants.size(); i++) {
+		READ_FAIL_COND(!_read_variant(r, function->constants.write[i]));
+	}
+	function->_constants_ptr = function->constants.size() ? function->constants.ptrw() : NULL;
+	function->_constant_count = function->constants.size();
+
+	function->global_names.resize(r.get_count());
+	for (int i = 0; i < function->global_names.size(); i++) {
+		function->global_names.write[i] = r.get_string();
+	}
+	function->_global_names_ptr = function->global_names.size() ? function->global_names.ptr() : NULL;
+	function->_global_names_count = function->global_names.size();
+
+	function->default_arguments.resize(r.get_count());
+	for (int i = 0; i < function->default_arguments.size(); i++) {
+		function->default_arguments.write[i] = r.get_32();
+	}
+	function->_default_arg_ptr = function->default_arguments.size() ? function->default_arguments.ptr() : NULL;
+	function->_default_arg_count = function->default_arguments.size() ? function->default_arguments.size() - 1 : 0;
+
+	function->validated_calls.resize(r.get_count());
+	for (int i = 0; i < function->validated_calls.size(); i++) {
+		GDScriptFunction::ValidatedCall &call = function->validated_calls.write[i];
+		uint32_t base_type = r.get_32();
+		READ_FAIL_COND(base_type >= Variant::VARIANT_MAX);
+		call.base_type = (Variant::Type)base_type;
+		call.name = r.get_string();
+		call.method = Variant::get_validated_method(call.base_type, call.name);
+		READ_FAIL_COND(!call.method);
+		call.argument_types = Variant::get_method_argument_types(call.base_type, call.name);
+	}
+	function->_validated_calls_ptr = function->validated_calls.size() ? function->validated_calls.ptr() : NULL;
+	function->_validated_calls_count = function->validated_calls.size();
+
+	function->_set_method_bind_call_count(r.get_32());
+
+	Vector<StringName> globals;
+	globals.resize(r.get_count());
+	for (int i = 0; i < globals.size(); i++) {
+		globals.write[i] = r.get_string();
+	}
+
+	const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+#ifdef TOOLS_ENABLED
+	const Map<StringName, Variant> &named_globals_map = GDScriptLanguage::get_singleton()->get_named_globals_map();
+#endif
+
+	function->code.resize(r.get_count());
+	for (int i = 0; i < function->code.size(); i++) {
+
+		int word = r.get_32();
+		if (((word & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) == GDScriptFunction::ADDR_TYPE_GLOBAL) {
+
+			int index = word & GDScriptFunction::ADDR_MASK;
+			READ_FAIL_COND(index >= globals.size());
+
+			const Map<StringName, int>::Element *E = global_map.find(globals[index]);
+			if (E) {
+				word = E->get() | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS);
+			} else {
+#ifdef TOOLS_ENABLED
+				READ_FAIL_COND(!named_globals_map.has(globals[index]));
+				int named_index = function->named_globals.find(globals[index]);
+				if (named_index == -1) {
+					named_index = function->named_globals.size();
+					function->named_globals.push_back(globals[index]);
+				}
+				word = named_index | (GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL << GDScriptFunction::ADDR_BITS);
+#else
+				READ_FAIL_COND(true); // not registered in this engine, the tokens will report it
+#endif
+			}
+		}
+		function->code.write[i] = word;
+	}
+	READ_FAIL_COND(function->code.empty());
+	function->_code_ptr = function->code.ptr();
+	function->_code_size = function->code.size();
+#ifdef TOOLS_ENABLED
+	function->_named_globals_ptr = function->named_globals.size() ? function->named_globals.ptr() : NULL;
+	function->_named_globals_count = function->named_globals.size();
+#endif
+
+	function->line_table.resize(r.get_count());
+	for (int i = 0; i < function->line_table.size(); i++) {
+		function->line_table.write[i].first = r.get_32();
+		function->line_table.write[i].second = r.get_32();
+	}
+
+	int arg_name_count = r.get_count();
+#ifdef TOOLS_ENABLED
+	function->arg_names.resize(arg_name_count);
+	for (int i = 0; i < arg_name_count; i++) {
+		function->arg_names.write[i] = r.get_string();
+	}
+#else
+	for (int i = 0; i < arg_name_count; i++) {
+		r.get_string();
+	}
+#endif
+	READ_FAIL_COND(false);
+
+#undef READ_FAIL_COND
+
+	function->_script = p_script;
+	function->source = r.script->get_path();
+#ifdef DEBUG_ENABLED
+	function->func_cname = (String(function->source) + " - " + String(function->name)).utf8();
+	function->_func_cname = function->func_cname.get_data();
+#endif
+
+	return function;
+}
+
+bool GDScriptBytecode::_read_class_tree(Reader &r, GDScript *p_script) {
+
+	int count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		if (r.error) {
+			return false;
+		}
+
+		Ref<GDScript> subclass;
+		subclass.instance();
+		subclass->_owner = p_script;
+		subclass->fully_qualified_name = p_script->fully_qualified_name + "::" + name;
+		p_script->subclasses.insert(name, subclass);
+
+		if (!_read_class_tree(r, subclass.ptr())) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool GDScriptBytecode::_read_class(Reader &r, GDScript *p_script) {
+
+	p_script->tool = r.get_32();
+	p_script->name = r.get_string();
+
+	String native = r.get_string();
+	if (native != String()) {
+		p_script->native = r.get_native_class(native);
+		if (p_script->native.is_null()) {
+			return false;
+		}
+	}
+
+	Variant base;
+	if (!_read_variant(r, base)) {
+		return false;
+	}
+	p_script->base = base;
+	p_script->_base = p_script->base.ptr();
+	if (p_script->base.is_null() && (Object *)base) {
+		return false;
+	}
+
+	int member_count = r.get_count();
+	for (int i = 0; i < member_count; i++) {
+		p_script->members.insert(r.get_string());
+	}
+
+	int member_index_count = r.get_count();
+	for (int i = 0; i < member_index_count; i++) {
+		StringName name = r.get_string();
+		GDScript::MemberInfo info;
+		info.index = r.get_32();
+		info.setter = r.get_string();
+		info.getter = r.get_string();
+		info.rpc_mode = (MultiplayerAPI::RPCMode)r.get_32();
+		if (!_read_data_type(r, info.data_type)) {
+			return false;
+		}
+		p_script->member_indices[name] = info;
+	}
+	p_script->_update_member_names();
+
+	int member_info_count = r.get_count();
+	for (int i = 0; i < member_info_count; i++) {
+		StringName name = r.get_string();
+		PropertyInfo info;
+		info.type = (Variant::Type)r.get_32();
+		info.name = r.get_string();
+		info.class_name = r.get_string();
+		info.hint = (PropertyHint)r.get_32();
+		info.hint_string = r.get_string();
+		info.usage = r.get_32();
+		p_script->member_info[name] = info;
+	}
+
+	int signal_count = r.get_count();
+	for (int i = 0; i < signal_count; i++) {
+		StringName name = r.get_string();
+		Vector<StringName> arguments;
+		arguments.resize(r.get_count());
+		for (int j = 0; j < arguments.size(); j++) {
+			arguments.write[j] = r.get_string();
+		}
+		p_script->_signals[name] = arguments;
+	}
+
+	int constant_count = r.get_count();
+	for (int i = 0; i < constant_count; i++) {
+		StringName name = r.get_string();
+		Variant value;
+		if (!_read_variant(r, value)) {
+			return false;
+		}
+		p_script->constants[name] = value;
+	}
+
+	int function_count = r.get_count();
+	for (int i = 0; i < function_count; i++) {
+		GDScriptFunction *function = _read_function(r, p_script);
+		if (!function) {
+			return false;
+		}
+		if (p_script->member_functions.has(function->name)) {
+			memdelete(p_script->member_functions[function->name]);
+		}
+		p_script->member_functions[function->name] = function;
+	}
+
+	const Map<StringName, GDScriptFunction *>::Element *initializer = p_script->member_functions.find("_init");
+	p_script->initializer = initializer ? initializer->get() : NULL;
+
+	int subclass_count = r.get_count();
+	for (int i = 0; i < subclass_count; i++) {
+		Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.find(r.get_string());
+		if (!E || !_read_class(r, E->get().ptr())) {
+			return false;
+		}
+	}
+
+	if (r.error) {
+		return false;
+	}
+
+	p_script->valid = true;
+	return true;
+}
+
+Vector<uint8_t> GDScriptBytecode::make_compiled_buffer(const String &p_code, const String &p_path, const Vector<uint8_t> &p_tokens) {
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_script_path(p_path);
+	script->set_source_code(p_code);
+	if (script->reload() != OK) {
+		return Vector<uint8_t>();
+	}
+
+	Writer w;
+	const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	w.globals.resize(global_map.size());
+	for (const Map<StringName, int>::Element *E = global_map.front(); E; E = E->next()) {
+		w.globals.write[E->get()] = E->key();
+	}
+
+	w.put_string(p_path);
+	_write_class_tree(w, script.ptr());
+	if (!_write_class(w, script.ptr())) {
+		return Vector<uint8_t>();
+	}
+
+	Vector<uint8_t> buffer;
+	buffer.resize(12 + p_tokens.size());
+	buffer.write[0] = 'G';
+	buffer.write[1] = 'D';
+	buffer.write[2] = 'S';
+	buffer.write[3] = 'B';
+	encode_uint32(get_version_hash(), &buffer.write[4]);
+	encode_uint32(p_tokens.size(), &buffer.write[8]);
+	copymem(&buffer.write[12], p_tokens.ptr(), p_tokens.size());
+	buffer.append_array(w.buffer);
+
+	return buffer;
+}
+
+bool GDScriptBytecode::is_compiled_buffer(const Vector<uint8_t> &p_buffer) {
+
+	return p_buffer.size() >= 12 && p_buffer[0] == 'G' && p_buffer[1] == 'D' && p_buffer[2] == 'S' && p_buffer[3] == 'B';
+}
+
+Vector<uint8_t> GDScriptBytecode::get_tokens(const Vector<uint8_t> &p_buffer) {
+
+	ERR_FAIL_COND_V(!is_compiled_buffer(p_buffer), Vector<uint8_t>());
+
+	uint32_t size = decode_uint32(&p_buffer[8]);
+	ERR_FAIL_COND_V(size == 0 || size > (uint32_t)p_buffer.size() - 12, Vector<uint8_t>());
+
+	Vector<uint8_t> tokens;
+	tokens.resize(size);
+	copymem(tokens.ptrw(), p_buffer.ptr() + 12, size);
+	return tokens;
+}
+
+Error GDScriptBytecode::load(const Vector<uint8_t> &p_buffer, GDScript *p_script) {
+
+	ERR_FAIL_COND_V(!is_compiled_buffer(p_buffer), ERR_INVALID_DATA);
+
+	// compiled by another engine build, the tokens are still good
+	if (decode_uint32(&p_buffer[4]) != get_version_hash()) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	uint32_t tokens_size = decode_uint32(&p_buffer[8]);
+	ERR_FAIL_COND_V(tokens_size >= (uint32_t)p_buffer.size() - 12, ERR_INVALID_DATA);
+
+	Reader r;
+	r.buffer = p_buffer.ptr() + 12 + tokens_size;
+	r.size = p_buffer.size() - 12 - tokens_size;
+	r.pos = 0;
+	r.error = false;
+	r.script = p_script;
+	r.root = r.get_string();
+
+	p_script->fully_qualified_name = p_script->path;
+	p_script->_owner = NULL;
+
+	if (!_read_class_tree(r, p_script) || !_read_class(r, p_script)) {
+		return ERR_INVALID_DATA;
+	}
+
+	GDScriptLanguage::get_singleton()->bump_compile_generation();
+
+	return OK;
+}
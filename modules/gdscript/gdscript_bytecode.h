@@ -0,0 +1,66 @@
+/*************************************************************************/
+/*  gdscript_bytecode.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_BYTECODE_H
+#define GDSCRIPT_BYTECODE_H
+
+#include "gdscript.h"
+
+// Compiled form of a script, exported in place of the tokens so loading skips the parser and the compiler.
+// It keeps the tokens for when the compiled code can't be used (another engine build, a debugger attached...).
+class GDScriptBytecode {
+
+	struct Writer;
+	struct Reader;
+
+	static bool _write_variant(Writer &w, const Variant &p_variant);
+	static bool _write_data_type(Writer &w, const GDScriptDataType &p_type);
+	static bool _write_function(Writer &w, const GDScriptFunction *p_function);
+	static bool _write_class(Writer &w, const GDScript *p_script);
+	static void _write_class_tree(Writer &w, const GDScript *p_script);
+
+	static bool _read_variant(Reader &r, Variant &r_variant);
+	static bool _read_data_type(Reader &r, GDScriptDataType &r_type);
+	static GDScriptFunction *_read_function(Reader &r, GDScript *p_script);
+	static bool _read_class(Reader &r, GDScript *p_script);
+	static bool _read_class_tree(Reader &r, GDScript *p_script);
+
+public:
+	static uint32_t get_version_hash();
+
+	// Compiles p_code as the script at p_path, empty if it can't be stored compiled.
+	static Vector<uint8_t> make_compiled_buffer(const String &p_code, const String &p_path, const Vector<uint8_t> &p_tokens);
+
+	static bool is_compiled_buffer(const Vector<uint8_t> &p_buffer);
+	static Vector<uint8_t> get_tokens(const Vector<uint8_t> &p_buffer);
+	static Error load(const Vector<uint8_t> &p_buffer, GDScript *p_script);
+};
+
+#endif // GDSCRIPT_BYTECODE_H
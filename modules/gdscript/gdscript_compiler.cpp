@@ -30,8 +30,11 @@
 
 #include "gdscript_compiler.h"
 
+#include "core/core_string_names.h"
 #include "gdscript.h"
 
+bool GDScriptCompiler::superinstructions = true;
+
 bool GDScriptCompiler::_is_class_member_property(CodeGen &codegen, const StringName &p_name) {
 
 	if (codegen.function_node && codegen.function_node->_static)
@@ -74,6 +77,149 @@ void GDScriptCompiler::_set_error(const String &p_error, const GDScriptParser::N
 	}
 }
 
+static Variant::Type _get_builtin_type(const GDScriptParser::DataType &p_type) {
+
+	if (!p_type.has_type || p_type.kind != GDScriptParser::DataType::BUILTIN)
+		return Variant::NIL;
+	return p_type.builtin_type;
+}
+
+GDScriptFunction::Opcode GDScriptCompiler::_get_operator_opcode(Variant::Operator op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) const {
+
+	// Parser types are only hints, the typed opcodes check the operands again and
+	// use the generic operator when they are something else.
+	Variant::Type type_a = _get_builtin_type(p_a);
+	Variant::Type type_b = _get_builtin_type(p_b);
+
+	bool ints = type_a == Variant::INT && type_b == Variant::INT;
+	bool reals = (type_a == Variant::REAL || type_a == Variant::INT) && (type_b == Variant::REAL || type_b == Variant::INT) && !ints;
+	bool scalar_b = type_b == Variant::REAL || type_b == Variant::INT;
+
+	switch (op) {
+		case Variant::OP_ADD:
+		case Variant::OP_SUBTRACT:
+		case Variant::OP_MULTIPLY:
+		case Variant::OP_DIVIDE:
+		case Variant::OP_NEGATE:
+		case Variant::OP_POSITIVE:
+		case Variant::OP_EQUAL:
+		case Variant::OP_NOT_EQUAL: {
+			if (ints)
+				return GDScriptFunction::OPCODE_OPERATOR_INT;
+			if (reals)
+				return GDScriptFunction::OPCODE_OPERATOR_REAL;
+
+			bool vector_b = type_b == type_a || ((op == Variant::OP_MULTIPLY || op == Variant::OP_DIVIDE) && scalar_b);
+			if (type_a == Variant::VECTOR2 && vector_b)
+				return GDScriptFunction::OPCODE_OPERATOR_VECTOR2;
+			if (type_a == Variant::VECTOR3 && vector_b)
+				return GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+		} break;
+		case Variant::OP_LESS:
+		case Variant::OP_LESS_EQUAL:
+		case Variant::OP_GREATER:
+		case Variant::OP_GREATER_EQUAL: {
+			if (ints)
+				return GDScriptFunction::OPCODE_OPERATOR_INT;
+			if (reals)
+				return GDScriptFunction::OPCODE_OPERATOR_REAL;
+		} break;
+		case Variant::OP_MODULE:
+		case Variant::OP_SHIFT_LEFT:
+		case Variant::OP_SHIFT_RIGHT:
+		case Variant::OP_BIT_AND:
+		case Variant::OP_BIT_OR:
+		case Variant::OP_BIT_XOR:
+		case Variant::OP_BIT_NEGATE: {
+			if (ints)
+				return GDScriptFunction::OPCODE_OPERATOR_INT;
+		} break;
+		default: {
+		}
+	}
+
+	return GDScriptFunction::OPCODE_OPERATOR;
+}
+
+int GDScriptCompiler::_get_component_index(const GDScriptParser::DataType &p_base, const StringName &p_name) const {
+
+	const CoreStringNames *names = CoreStringNames::get_singleton();
+
+	switch (_get_builtin_type(p_base)) {
+		case Variant::VECTOR2: {
+			if (p_name == names->x)
+				return 0;
+			if (p_name == names->y)
+				return 1;
+		} break;
+		case Variant::VECTOR3: {
+			if (p_name == names->x)
+				return 0;
+			if (p_name == names->y)
+				return 1;
+			if (p_name == names->z)
+				return 2;
+		} break;
+		case Variant::COLOR: {
+			if (p_name == names->r)
+				return 0;
+			if (p_name == names->g)
+				return 1;
+			if (p_name == names->b)
+				return 2;
+			if (p_name == names->a)
+				return 3;
+		} break;
+		default: {
+		}
+	}
+
+	return -1;
+}
+
+bool GDScriptCompiler::_is_method_bind_call(CodeGen &codegen, const GDScriptParser::Node *p_base, const StringName &p_method) const {
+
+	// OPCODE_CALL reports these with their own errors, connect also flags the connection as made from a script
+	if (p_method == "connect" || p_method == "call" || p_method == "free")
+		return false;
+
+	if (p_base->type == GDScriptParser::Node::TYPE_SELF)
+		return !(codegen.function_node && codegen.function_node->_static);
+
+	GDScriptParser::DataType base_type = p_base->get_datatype();
+	if (!base_type.has_type)
+		return false;
+
+	switch (base_type.kind) {
+		case GDScriptParser::DataType::BUILTIN: return base_type.builtin_type == Variant::OBJECT;
+		case GDScriptParser::DataType::NATIVE:
+		case GDScriptParser::DataType::SCRIPT:
+		case GDScriptParser::DataType::GDSCRIPT:
+		case GDScriptParser::DataType::CLASS: return true;
+		default: return false;
+	}
+}
+
+void GDScriptCompiler::_mark_operator(CodeGen &codegen) {
+
+	// a get member emitted right before is fused with the operator, which stays in place for jumps to it
+	if (superinstructions && codegen.last_get_member >= 0 && codegen.last_get_member == codegen.opcodes.size() - 3)
+		codegen.opcodes.write[codegen.last_get_member] = GDScriptFunction::OPCODE_GET_MEMBER_OPERATOR;
+
+	codegen.last_operator = codegen.opcodes.size();
+}
+
+void GDScriptCompiler::_add_conditional_jump(CodeGen &codegen, GDScriptFunction::Opcode p_jump, int p_test) {
+
+	// same for a jump testing the result of the operator emitted right before it
+	int operator_pos = codegen.opcodes.size() - 5;
+	if (superinstructions && codegen.last_operator >= 0 && codegen.last_operator == operator_pos && codegen.opcodes[operator_pos + 4] == p_test)
+		codegen.opcodes.write[operator_pos] = p_jump == GDScriptFunction::OPCODE_JUMP_IF ? GDScriptFunction::OPCODE_OPERATOR_JUMP_IF : GDScriptFunction::OPCODE_OPERATOR_JUMP_IF_NOT;
+
+	codegen.opcodes.push_back(p_jump);
+	codegen.opcodes.push_back(p_test);
+}
+
 bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size() != 1, false);
@@ -82,7 +228,10 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 	if (src_address_a < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	GDScriptParser::DataType type_a = on->arguments[0]->get_datatype();
+
+	_mark_operator(codegen);
+	codegen.opcodes.push_back(_get_operator_opcode(op, type_a, type_a)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
@@ -104,7 +253,8 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 	if (src_address_b < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	_mark_operator(codegen);
+	codegen.opcodes.push_back(_get_operator_opcode(op, on->arguments[0]->get_datatype(), on->arguments[1]->get_datatype())); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
@@ -239,6 +389,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 			// TRY CLASS MEMBER
 			if (_is_class_member_property(codegen, identifier)) {
 				//get property
+				codegen.last_get_member = codegen.opcodes.size();
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_MEMBER); // perform operator
 				codegen.opcodes.push_back(codegen.get_name_map_pos(identifier)); // argument 2 (unary only takes one parameter)
 				int dst_addr = (p_stack_level) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
@@ -656,11 +807,60 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							arguments.push_back(ret);
 						}
 
-						codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
-						codegen.opcodes.push_back(on->arguments.size() - 2);
-						codegen.alloc_call(on->arguments.size() - 2);
-						for (int i = 0; i < arguments.size(); i++)
-							codegen.opcodes.push_back(arguments[i]);
+						// Methods of built-in types called with arguments of the expected types skip the checks of Variant::call.
+						Variant::Type base_type = _get_builtin_type(instance->get_datatype());
+						StringName method = static_cast<const GDScriptParser::IdentifierNode *>(on->arguments[1])->name;
+						bool validated = base_type != Variant::NIL && base_type != Variant::OBJECT && Variant::get_validated_method(base_type, method);
+
+						Vector<Variant::Type> argument_types;
+						Vector<Variant> default_arguments;
+						if (validated) {
+							argument_types = Variant::get_method_argument_types(base_type, method);
+							default_arguments = Variant::get_method_default_arguments(base_type, method);
+
+							// void methods leave the destination untouched, Variant::call would clear it
+							bool has_return = false;
+							Variant::get_method_return_type(base_type, method, &has_return);
+
+							int argc = on->arguments.size() - 2;
+							validated = (p_root || has_return) && argc <= argument_types.size() && argc >= argument_types.size() - default_arguments.size();
+							for (int i = 0; i < argc && validated; i++) {
+								validated = argument_types[i] == Variant::NIL || _get_builtin_type(on->arguments[i + 2]->get_datatype()) == argument_types[i];
+							}
+						}
+
+						if (validated) {
+							int first_default_arg = argument_types.size() - default_arguments.size();
+							for (int i = on->arguments.size() - 2; i < argument_types.size(); i++) {
+								int idx = codegen.get_constant_pos(default_arguments[i - first_default_arg]);
+								arguments.push_back(idx | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS));
+							}
+
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_CALL_VALIDATED);
+							codegen.opcodes.push_back(argument_types.size());
+							codegen.opcodes.push_back(arguments[0]); // base
+							codegen.opcodes.push_back(arguments[1]); // method name
+							codegen.opcodes.push_back(codegen.get_validated_call_pos(base_type, method));
+							codegen.alloc_call(argument_types.size());
+							for (int i = 2; i < arguments.size(); i++)
+								codegen.opcodes.push_back(arguments[i]);
+						} else if (_is_method_bind_call(codegen, instance, method)) {
+							// calls on objects remember the native method they resolved
+							codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL_METHOD_BIND : GDScriptFunction::OPCODE_CALL_METHOD_BIND_RETURN);
+							codegen.opcodes.push_back(on->arguments.size() - 2);
+							codegen.opcodes.push_back(arguments[0]); // base
+							codegen.opcodes.push_back(arguments[1]); // method name
+							codegen.opcodes.push_back(codegen.method_bind_calls++);
+							codegen.alloc_call(on->arguments.size() - 2);
+							for (int i = 2; i < arguments.size(); i++)
+								codegen.opcodes.push_back(arguments[i]);
+						} else {
+							codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
+							codegen.opcodes.push_back(on->arguments.size() - 2);
+							codegen.alloc_call(on->arguments.size() - 2);
+							for (int i = 0; i < arguments.size(); i++)
+								codegen.opcodes.push_back(arguments[i]);
+						}
 					}
 				} break;
 				case GDScriptParser::OperatorNode::OP_YIELD: {
@@ -749,9 +949,22 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						}
 					}
 
-					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
-					codegen.opcodes.push_back(from); // argument 1
-					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					int component = -1;
+					if (on->op == GDScriptParser::OperatorNode::OP_INDEX_NAMED && p_index_addr == 0) {
+						component = _get_component_index(on->arguments[0]->get_datatype(), static_cast<GDScriptParser::IdentifierNode *>(on->arguments[1])->name);
+					}
+
+					if (component >= 0) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_COMPONENT);
+						codegen.opcodes.push_back(from);
+						codegen.opcodes.push_back(index);
+						codegen.opcodes.push_back(on->arguments[0]->get_datatype().builtin_type);
+						codegen.opcodes.push_back(component);
+					} else {
+						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+						codegen.opcodes.push_back(from); // argument 1
+						codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					}
 
 				} break;
 				case GDScriptParser::OperatorNode::OP_AND: {
@@ -761,8 +974,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					int res = _parse_expression(codegen, on->arguments[0], p_stack_level);
 					if (res < 0)
 						return res;
-					codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-					codegen.opcodes.push_back(res);
+					_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF_NOT, res);
 					int jump_fail_pos = codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
@@ -770,8 +982,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					if (res < 0)
 						return res;
 
-					codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-					codegen.opcodes.push_back(res);
+					_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF_NOT, res);
 					int jump_fail_pos2 = codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
@@ -794,8 +1005,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					int res = _parse_expression(codegen, on->arguments[0], p_stack_level);
 					if (res < 0)
 						return res;
-					codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF);
-					codegen.opcodes.push_back(res);
+					_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF, res);
 					int jump_success_pos = codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
@@ -803,8 +1013,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					if (res < 0)
 						return res;
 
-					codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF);
-					codegen.opcodes.push_back(res);
+					_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF, res);
 					int jump_success_pos2 = codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
@@ -828,8 +1037,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					int res = _parse_expression(codegen, on->arguments[0], p_stack_level);
 					if (res < 0)
 						return res;
-					codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-					codegen.opcodes.push_back(res);
+					_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF_NOT, res);
 					int jump_fail_pos = codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
@@ -1097,10 +1305,21 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						if (set_value < 0) //error
 							return set_value;
 
-						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
-						codegen.opcodes.push_back(prev_pos);
-						codegen.opcodes.push_back(set_index);
-						codegen.opcodes.push_back(set_value);
+						int component = named ? _get_component_index(op->arguments[0]->get_datatype(), static_cast<const GDScriptParser::IdentifierNode *>(op->arguments[1])->name) : -1;
+
+						if (component >= 0) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_COMPONENT);
+							codegen.opcodes.push_back(prev_pos);
+							codegen.opcodes.push_back(set_index);
+							codegen.opcodes.push_back(op->arguments[0]->get_datatype().builtin_type);
+							codegen.opcodes.push_back(component);
+							codegen.opcodes.push_back(set_value);
+						} else {
+							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+							codegen.opcodes.push_back(prev_pos);
+							codegen.opcodes.push_back(set_index);
+							codegen.opcodes.push_back(set_value);
+						}
 
 						for (int i = 0; i < setchain.size(); i++) {
 
@@ -1275,9 +1494,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 			case GDScriptParser::Node::TYPE_NEWLINE: {
 #ifdef DEBUG_ENABLED
 				const GDScriptParser::NewLineNode *nl = static_cast<const GDScriptParser::NewLineNode *>(s);
-				codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
-				codegen.opcodes.push_back(nl->line);
-				codegen.current_line = nl->line;
+				codegen.add_line(nl->line);
 #endif
 			} break;
 			case GDScriptParser::Node::TYPE_CONTROL_FLOW: {
@@ -1332,8 +1549,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 								return ERR_PARSE_ERROR;
 							}
 
-							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF);
-							codegen.opcodes.push_back(ret2);
+							_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF, ret2);
 							codegen.opcodes.push_back(codegen.opcodes.size() + 3);
 							int continue_addr = codegen.opcodes.size();
 							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP);
@@ -1365,8 +1581,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						if (ret2 < 0)
 							return ERR_PARSE_ERROR;
 
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-						codegen.opcodes.push_back(ret2);
+						_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF_NOT, ret2);
 						int else_addr = codegen.opcodes.size();
 						codegen.opcodes.push_back(0); //temporary
 
@@ -1381,9 +1596,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 							codegen.opcodes.push_back(0);
 							codegen.opcodes.write[else_addr] = codegen.opcodes.size();
 
-							codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
-							codegen.opcodes.push_back(cf->body_else->line);
-							codegen.current_line = cf->body_else->line;
+							codegen.add_line(cf->body_else->line);
 
 							Error err2 = _parse_block(codegen, cf->body_else, p_stack_level, p_break_addr, p_continue_addr);
 							if (err2)
@@ -1417,25 +1630,73 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(ret2);
 
-						//begin loop
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN);
-						codegen.opcodes.push_back(counter_pos);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(codegen.opcodes.size() + 4);
-						codegen.opcodes.push_back(iterator_pos);
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
-						codegen.opcodes.push_back(codegen.opcodes.size() + 8);
-						//break loop
-						int break_pos = codegen.opcodes.size();
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
-						codegen.opcodes.push_back(0); //skip code for next
-						//next loop
-						int continue_pos = codegen.opcodes.size();
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE);
-						codegen.opcodes.push_back(counter_pos);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(break_pos);
-						codegen.opcodes.push_back(iterator_pos);
+						// The parser turns range() into an int, Vector2 or Vector3, either constant or constructed,
+						// so those always have the type they claim and can be counted on ints.
+						Variant::Type container_type = Variant::NIL;
+						if (cf->arguments[1]->type == GDScriptParser::Node::TYPE_CONSTANT) {
+							container_type = static_cast<const GDScriptParser::ConstantNode *>(cf->arguments[1])->value.get_type();
+						} else if (cf->arguments[1]->type == GDScriptParser::Node::TYPE_OPERATOR) {
+							const GDScriptParser::OperatorNode *op = static_cast<const GDScriptParser::OperatorNode *>(cf->arguments[1]);
+							if (op->op == GDScriptParser::OperatorNode::OP_CALL && op->arguments[0]->type == GDScriptParser::Node::TYPE_TYPE) {
+								container_type = static_cast<const GDScriptParser::TypeNode *>(op->arguments[0])->vtype;
+							}
+						}
+
+						int break_pos;
+						int continue_pos;
+
+						if (container_type == Variant::INT || container_type == Variant::VECTOR2 || container_type == Variant::VECTOR3) {
+
+							int step_pos = (slevel++) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
+							codegen.alloc_stack(slevel);
+
+							//begin loop
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN_RANGE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.opcodes.push_back(codegen.opcodes.size() + 4);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(codegen.opcodes.size() + 9);
+							//break loop
+							break_pos = codegen.opcodes.size();
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(0); //skip code for next
+							//next loop
+							continue_pos = codegen.opcodes.size();
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_RANGE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.opcodes.push_back(break_pos);
+							codegen.opcodes.push_back(iterator_pos);
+
+						} else {
+
+							// arrays are indexed directly, the opcodes fall back to the generic ones otherwise
+							bool array = _get_builtin_type(cf->arguments[1]->get_datatype()) == Variant::ARRAY;
+
+							//begin loop
+							codegen.opcodes.push_back(array ? GDScriptFunction::OPCODE_ITERATE_BEGIN_ARRAY : GDScriptFunction::OPCODE_ITERATE_BEGIN);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(codegen.opcodes.size() + 4);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(codegen.opcodes.size() + 8);
+							//break loop
+							break_pos = codegen.opcodes.size();
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(0); //skip code for next
+							//next loop
+							continue_pos = codegen.opcodes.size();
+							codegen.opcodes.push_back(array ? GDScriptFunction::OPCODE_ITERATE_ARRAY : GDScriptFunction::OPCODE_ITERATE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(break_pos);
+							codegen.opcodes.push_back(iterator_pos);
+						}
 
 						Error err = _parse_block(codegen, cf->body, slevel, break_pos, continue_pos);
 						if (err)
@@ -1460,8 +1721,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						int ret2 = _parse_expression(codegen, cf->arguments[0], p_stack_level, false);
 						if (ret2 < 0)
 							return ERR_PARSE_ERROR;
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-						codegen.opcodes.push_back(ret2);
+						_add_conditional_jump(codegen, GDScriptFunction::OPCODE_JUMP_IF_NOT, ret2);
 						codegen.opcodes.push_back(break_addr);
 						Error err = _parse_block(codegen, cf->body, p_stack_level, break_addr, continue_addr);
 						if (err)
@@ -1583,7 +1843,12 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	codegen.stack_max = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
+	codegen.method_bind_calls = 0;
 	codegen.debug_stack = ScriptDebugger::get_singleton() != NULL;
+	codegen.last_operator = -1;
+	codegen.last_get_member = -1;
+	// the debugger follows the current line, without it the line is only needed on errors
+	codegen.fold_lines = superinstructions && !codegen.debug_stack;
 	Vector<StringName> argnames;
 
 	int stack_level = 0;
@@ -1714,6 +1979,17 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_constants_ptr = NULL;
 		gdfunc->_constant_count = 0;
 	}
+	//built-in methods called without checks
+	if (codegen.validated_calls.size()) {
+		gdfunc->validated_calls = codegen.validated_calls;
+		gdfunc->_validated_calls_ptr = gdfunc->validated_calls.ptr();
+		gdfunc->_validated_calls_count = gdfunc->validated_calls.size();
+	} else {
+		gdfunc->_validated_calls_ptr = NULL;
+		gdfunc->_validated_calls_count = 0;
+	}
+	//native methods resolved at run time
+	gdfunc->_set_method_bind_call_count(codegen.method_bind_calls);
 	//global names
 	if (codegen.name_map.size()) {
 
@@ -1745,6 +2021,7 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	if (codegen.opcodes.size()) {
 
 		gdfunc->code = codegen.opcodes;
+		gdfunc->line_table = codegen.line_table;
 		gdfunc->_code_ptr = &gdfunc->code[0];
 		gdfunc->_code_size = codegen.opcodes.size();
 
@@ -1850,6 +2127,7 @@ Error GDScriptCompiler::_parse_class_level(GDScript *p_script, const GDScriptPar
 	}
 	p_script->member_functions.clear();
 	p_script->member_indices.clear();
+	p_script->member_names.clear();
 	p_script->member_info.clear();
 	p_script->_signals.clear();
 	p_script->initializer = NULL;
@@ -1934,6 +2212,7 @@ Error GDScriptCompiler::_parse_class_level(GDScript *p_script, const GDScriptPar
 		p_script->member_lines[name] = p_class->variables[i].line;
 #endif
 	}
+	p_script->_update_member_names();
 
 	for (Map<StringName, GDScriptParser::ClassNode::Constant>::Element *E = p_class->constant_expressions.front(); E; E = E->next()) {
 
@@ -2169,15 +2448,13 @@ Error GDScriptCompiler::compile(const GDScriptParser *p_parser, GDScript *p_scri
 	p_script->_owner = NULL;
 	Error err = _parse_class_level(p_script, static_cast<const GDScriptParser::ClassNode *>(root), p_keep_state);
 
-	if (err)
-		return err;
+	if (!err)
+		err = _parse_class_blocks(p_script, static_cast<const GDScriptParser::ClassNode *>(root), p_keep_state);
 
-	err = _parse_class_blocks(p_script, static_cast<const GDScriptParser::ClassNode *>(root), p_keep_state);
+	// even a failed compile may have replaced some functions
+	GDScriptLanguage::get_singleton()->bump_compile_generation();
 
-	if (err)
-		return err;
-
-	return OK;
+	return err;
 }
 
 String GDScriptCompiler::get_error() const {
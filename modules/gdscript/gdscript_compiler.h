@@ -121,7 +121,44 @@ class GDScriptCompiler {
 			return pos;
 		}
 
+		Vector<GDScriptFunction::ValidatedCall> validated_calls;
+
+		int get_validated_call_pos(Variant::Type p_type, const StringName &p_method) {
+			for (int i = 0; i < validated_calls.size(); i++) {
+				if (validated_calls[i].base_type == p_type && validated_calls[i].name == p_method)
+					return i;
+			}
+			GDScriptFunction::ValidatedCall call;
+			call.method = Variant::get_validated_method(p_type, p_method);
+			call.base_type = p_type;
+			call.name = p_method;
+			call.argument_types = Variant::get_method_argument_types(p_type, p_method);
+			validated_calls.push_back(call);
+			return validated_calls.size() - 1;
+		}
+
 		Vector<int> opcodes;
+
+		// Where the last operator and get member were emitted, so an instruction
+		// emitted right after them can turn them into a superinstruction.
+		int last_operator;
+		int last_get_member;
+
+		bool fold_lines;
+		Vector<Pair<int, int> > line_table;
+
+		void add_line(int p_line) {
+			current_line = p_line;
+			if (!fold_lines) {
+				opcodes.push_back(GDScriptFunction::OPCODE_LINE);
+				opcodes.push_back(p_line);
+			} else if (line_table.size() && line_table[line_table.size() - 1].first == opcodes.size()) {
+				line_table.write[line_table.size() - 1].second = p_line;
+			} else {
+				line_table.push_back(Pair<int, int>(opcodes.size(), p_line));
+			}
+		}
+
 		void alloc_stack(int p_level) {
 			if (p_level >= stack_max) stack_max = p_level + 1;
 		}
@@ -132,6 +169,7 @@ class GDScriptCompiler {
 		int current_line;
 		int stack_max;
 		int call_max;
+		int method_bind_calls;
 	};
 
 	bool _is_class_member_property(CodeGen &codegen, const StringName &p_name);
@@ -139,6 +177,11 @@ class GDScriptCompiler {
 
 	void _set_error(const String &p_error, const GDScriptParser::Node *p_node);
 
+	GDScriptFunction::Opcode _get_operator_opcode(Variant::Operator op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) const;
+	int _get_component_index(const GDScriptParser::DataType &p_base, const StringName &p_name) const;
+	bool _is_method_bind_call(CodeGen &codegen, const GDScriptParser::Node *p_base, const StringName &p_method) const;
+	void _mark_operator(CodeGen &codegen);
+	void _add_conditional_jump(CodeGen &codegen, GDScriptFunction::Opcode p_jump, int p_test);
 	bool _create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level);
 	bool _create_binary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level, bool p_initializer = false, int p_index_addr = 0);
 
@@ -156,6 +199,8 @@ class GDScriptCompiler {
 	StringName source;
 	String error;
 
+	static bool superinstructions;
+
 public:
 	Error compile(const GDScriptParser *p_parser, GDScript *p_script, bool p_keep_state = false);
 
@@ -163,6 +208,10 @@ public:
 	int get_error_line() const;
 	int get_error_column() const;
 
+	// Fused opcodes and line tables instead of OPCODE_LINE, on unless measuring without them.
+	static void set_superinstructions_enabled(bool p_enabled) { superinstructions = p_enabled; }
+	static bool is_superinstructions_enabled() { return superinstructions; }
+
 	GDScriptCompiler();
 };
 
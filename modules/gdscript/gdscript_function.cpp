@@ -31,6 +31,7 @@
 #include "gdscript_function.h"
 
 #include "core/os/os.h"
+#include "core/variant_internal.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
 #include "core/object.h"
@@ -191,18 +192,198 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 	return err_text;
 }
 
+// Operators on the types the typed opcodes are emitted for, shared with the fused opcodes.
+// They return false when the generic operator has to run instead (other types, division by zero...).
+static _FORCE_INLINE_ bool _evaluate_int(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	if (unlikely(p_a->get_type() != Variant::INT || p_b->get_type() != Variant::INT))
+		return false;
+
+	int64_t va = *VariantInternal::get_int(p_a);
+	int64_t vb = *VariantInternal::get_int(p_b);
+
+	switch (p_op) {
+		case Variant::OP_ADD: VariantInternal::set_int(r_dst, va + vb); break;
+		case Variant::OP_SUBTRACT: VariantInternal::set_int(r_dst, va - vb); break;
+		case Variant::OP_MULTIPLY: VariantInternal::set_int(r_dst, va * vb); break;
+		case Variant::OP_DIVIDE: {
+			if (vb == 0)
+				return false; // let the generic operator report it
+			VariantInternal::set_int(r_dst, va / vb);
+		} break;
+		case Variant::OP_MODULE: {
+			if (vb == 0)
+				return false;
+			VariantInternal::set_int(r_dst, va % vb);
+		} break;
+		case Variant::OP_NEGATE: VariantInternal::set_int(r_dst, -va); break;
+		case Variant::OP_POSITIVE: VariantInternal::set_int(r_dst, va); break;
+		case Variant::OP_SHIFT_LEFT: {
+			if (vb < 0 || vb > 63)
+				return false;
+			VariantInternal::set_int(r_dst, va << vb);
+		} break;
+		case Variant::OP_SHIFT_RIGHT: {
+			if (vb < 0 || vb > 63)
+				return false;
+			VariantInternal::set_int(r_dst, va >> vb);
+		} break;
+		case Variant::OP_BIT_AND: VariantInternal::set_int(r_dst, va & vb); break;
+		case Variant::OP_BIT_OR: VariantInternal::set_int(r_dst, va | vb); break;
+		case Variant::OP_BIT_XOR: VariantInternal::set_int(r_dst, va ^ vb); break;
+		case Variant::OP_BIT_NEGATE: VariantInternal::set_int(r_dst, ~va); break;
+		case Variant::OP_EQUAL: VariantInternal::set_bool(r_dst, va == vb); break;
+		case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(r_dst, va != vb); break;
+		case Variant::OP_LESS: VariantInternal::set_bool(r_dst, va < vb); break;
+		case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(r_dst, va <= vb); break;
+		case Variant::OP_GREATER: VariantInternal::set_bool(r_dst, va > vb); break;
+		case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(r_dst, va >= vb); break;
+		default: return false;
+	}
+	return true;
+}
+
+static _FORCE_INLINE_ bool _evaluate_real(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	Variant::Type type_a = p_a->get_type();
+	Variant::Type type_b = p_b->get_type();
+
+	// int with int is left to the generic operator, it must not turn into a float
+	if (unlikely(!((type_a == Variant::REAL && (type_b == Variant::REAL || type_b == Variant::INT)) || (type_a == Variant::INT && type_b == Variant::REAL))))
+		return false;
+
+	double va = type_a == Variant::REAL ? *VariantInternal::get_real(p_a) : (double)*VariantInternal::get_int(p_a);
+	double vb = type_b == Variant::REAL ? *VariantInternal::get_real(p_b) : (double)*VariantInternal::get_int(p_b);
+
+	switch (p_op) {
+		case Variant::OP_ADD: VariantInternal::set_real(r_dst, va + vb); break;
+		case Variant::OP_SUBTRACT: VariantInternal::set_real(r_dst, va - vb); break;
+		case Variant::OP_MULTIPLY: VariantInternal::set_real(r_dst, va * vb); break;
+		case Variant::OP_DIVIDE: {
+			if (vb == 0)
+				return false;
+			VariantInternal::set_real(r_dst, va / vb);
+		} break;
+		case Variant::OP_NEGATE: VariantInternal::set_real(r_dst, -va); break;
+		case Variant::OP_POSITIVE: VariantInternal::set_real(r_dst, va); break;
+		case Variant::OP_EQUAL: VariantInternal::set_bool(r_dst, va == vb); break;
+		case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(r_dst, va != vb); break;
+		case Variant::OP_LESS: VariantInternal::set_bool(r_dst, va < vb); break;
+		case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(r_dst, va <= vb); break;
+		case Variant::OP_GREATER: VariantInternal::set_bool(r_dst, va > vb); break;
+		case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(r_dst, va >= vb); break;
+		default: return false;
+	}
+	return true;
+}
+
+static _FORCE_INLINE_ bool _evaluate_vector2(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	if (unlikely(p_a->get_type() != Variant::VECTOR2))
+		return false;
+
+	const Vector2 &va = *VariantInternal::get_vector2(p_a);
+	Variant::Type type_b = p_b->get_type();
+
+	if (type_b == Variant::VECTOR2) {
+		const Vector2 &vb = *VariantInternal::get_vector2(p_b);
+		switch (p_op) {
+			case Variant::OP_ADD: VariantInternal::set_vector2(r_dst, va + vb); break;
+			case Variant::OP_SUBTRACT: VariantInternal::set_vector2(r_dst, va - vb); break;
+			case Variant::OP_MULTIPLY: VariantInternal::set_vector2(r_dst, va * vb); break;
+			case Variant::OP_DIVIDE: VariantInternal::set_vector2(r_dst, va / vb); break;
+			case Variant::OP_NEGATE: VariantInternal::set_vector2(r_dst, -va); break;
+			case Variant::OP_POSITIVE: VariantInternal::set_vector2(r_dst, va); break;
+			case Variant::OP_EQUAL: VariantInternal::set_bool(r_dst, va == vb); break;
+			case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(r_dst, va != vb); break;
+			default: return false;
+		}
+		return true;
+	}
+
+	if (type_b == Variant::REAL || type_b == Variant::INT) {
+		real_t vb = type_b == Variant::REAL ? (real_t)*VariantInternal::get_real(p_b) : (real_t)*VariantInternal::get_int(p_b);
+		switch (p_op) {
+			case Variant::OP_MULTIPLY: VariantInternal::set_vector2(r_dst, va * vb); break;
+			case Variant::OP_DIVIDE: VariantInternal::set_vector2(r_dst, va / vb); break;
+			default: return false;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+static _FORCE_INLINE_ bool _evaluate_vector3(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	if (unlikely(p_a->get_type() != Variant::VECTOR3))
+		return false;
+
+	const Vector3 &va = *VariantInternal::get_vector3(p_a);
+	Variant::Type type_b = p_b->get_type();
+
+	if (type_b == Variant::VECTOR3) {
+		const Vector3 &vb = *VariantInternal::get_vector3(p_b);
+		switch (p_op) {
+			case Variant::OP_ADD: VariantInternal::set_vector3(r_dst, va + vb); break;
+			case Variant::OP_SUBTRACT: VariantInternal::set_vector3(r_dst, va - vb); break;
+			case Variant::OP_MULTIPLY: VariantInternal::set_vector3(r_dst, va * vb); break;
+			case Variant::OP_DIVIDE: VariantInternal::set_vector3(r_dst, va / vb); break;
+			case Variant::OP_NEGATE: VariantInternal::set_vector3(r_dst, -va); break;
+			case Variant::OP_POSITIVE: VariantInternal::set_vector3(r_dst, va); break;
+			case Variant::OP_EQUAL: VariantInternal::set_bool(r_dst, va == vb); break;
+			case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(r_dst, va != vb); break;
+			default: return false;
+		}
+		return true;
+	}
+
+	if (type_b == Variant::REAL || type_b == Variant::INT) {
+		real_t vb = type_b == Variant::REAL ? (real_t)*VariantInternal::get_real(p_b) : (real_t)*VariantInternal::get_int(p_b);
+		switch (p_op) {
+			case Variant::OP_MULTIPLY: VariantInternal::set_vector3(r_dst, va * vb); break;
+			case Variant::OP_DIVIDE: VariantInternal::set_vector3(r_dst, va / vb); break;
+			default: return false;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+// Fused opcodes only know the operands at run time, untyped code goes to the generic operator.
+static _FORCE_INLINE_ bool _evaluate_typed(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	switch (p_a->get_type()) {
+		case Variant::INT: return p_b->get_type() == Variant::INT ? _evaluate_int(p_op, p_a, p_b, r_dst) : _evaluate_real(p_op, p_a, p_b, r_dst);
+		case Variant::REAL: return _evaluate_real(p_op, p_a, p_b, r_dst);
+		case Variant::VECTOR2: return _evaluate_vector2(p_op, p_a, p_b, r_dst);
+		case Variant::VECTOR3: return _evaluate_vector3(p_op, p_a, p_b, r_dst);
+		default: return false;
+	}
+}
+
 #if defined(__GNUC__)
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
 		&&OPCODE_OPERATOR,                    \
+		&&OPCODE_OPERATOR_INT,                \
+		&&OPCODE_OPERATOR_REAL,               \
+		&&OPCODE_OPERATOR_VECTOR2,            \
+		&&OPCODE_OPERATOR_VECTOR3,            \
+		&&OPCODE_OPERATOR_JUMP_IF,            \
+		&&OPCODE_OPERATOR_JUMP_IF_NOT,        \
 		&&OPCODE_EXTENDS_TEST,                \
 		&&OPCODE_IS_BUILTIN,                  \
 		&&OPCODE_SET,                         \
 		&&OPCODE_GET,                         \
 		&&OPCODE_SET_NAMED,                   \
 		&&OPCODE_GET_NAMED,                   \
+		&&OPCODE_SET_COMPONENT,               \
+		&&OPCODE_GET_COMPONENT,               \
 		&&OPCODE_SET_MEMBER,                  \
 		&&OPCODE_GET_MEMBER,                  \
+		&&OPCODE_GET_MEMBER_OPERATOR,         \
 		&&OPCODE_ASSIGN,                      \
 		&&OPCODE_ASSIGN_TRUE,                 \
 		&&OPCODE_ASSIGN_FALSE,                \
@@ -217,6 +398,9 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_CONSTRUCT_DICTIONARY,        \
 		&&OPCODE_CALL,                        \
 		&&OPCODE_CALL_RETURN,                 \
+		&&OPCODE_CALL_VALIDATED,              \
+		&&OPCODE_CALL_METHOD_BIND,            \
+		&&OPCODE_CALL_METHOD_BIND_RETURN,     \
 		&&OPCODE_CALL_BUILT_IN,               \
 		&&OPCODE_CALL_SELF,                   \
 		&&OPCODE_CALL_SELF_BASE,              \
@@ -230,6 +414,10 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_RETURN,                      \
 		&&OPCODE_ITERATE_BEGIN,               \
 		&&OPCODE_ITERATE,                     \
+		&&OPCODE_ITERATE_BEGIN_RANGE,         \
+		&&OPCODE_ITERATE_RANGE,               \
+		&&OPCODE_ITERATE_BEGIN_ARRAY,         \
+		&&OPCODE_ITERATE_ARRAY,               \
 		&&OPCODE_ASSERT,                      \
 		&&OPCODE_BREAKPOINT,                  \
 		&&OPCODE_LINE,                        \
@@ -389,6 +577,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	String err_text;
 
+// Most operands live on the stack, GET_VARIANT_PTR decodes those without going through _get_variant.
+#define IS_STACK_ADDRESS(m_address) ((unsigned int)(((m_address)&ADDR_TYPE_MASK) >> ADDR_BITS) - ADDR_TYPE_STACK <= ADDR_TYPE_STACK_VARIABLE - ADDR_TYPE_STACK)
+
 #ifdef DEBUG_ENABLED
 
 	if (ScriptDebugger::get_singleton())
@@ -405,19 +596,63 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #define CHECK_SPACE(m_space) \
 	GD_ERR_BREAK((ip + m_space) > _code_size)
 
-#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                       \
-	Variant *m_v;                                                                              \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, stack, err_text); \
-	if (unlikely(!m_v))                                                                        \
-		OPCODE_BREAK;
+#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                \
+	Variant *m_v;                                                                       \
+	{                                                                                   \
+		int address = _code_ptr[ip + m_code_ofs];                                       \
+		if (likely(IS_STACK_ADDRESS(address) && (address & ADDR_MASK) < _stack_size)) { \
+			m_v = &stack[address & ADDR_MASK];                                          \
+		} else {                                                                        \
+			m_v = _get_variant(address, p_instance, script, self, stack, err_text);     \
+			if (unlikely(!m_v))                                                         \
+				OPCODE_BREAK;                                                           \
+		}                                                                               \
+	}
 
 #else
 #define GD_ERR_BREAK(m_cond)
 #define CHECK_SPACE(m_space)
-#define GET_VARIANT_PTR(m_v, m_code_ofs) \
-	Variant *m_v;                        \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, stack, err_text);
+#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                                                                          \
+	Variant *m_v;                                                                                                                                 \
+	{                                                                                                                                             \
+		int address = _code_ptr[ip + m_code_ofs];                                                                                                 \
+		m_v = likely(IS_STACK_ADDRESS(address)) ? &stack[address & ADDR_MASK] : _get_variant(address, p_instance, script, self, stack, err_text); \
+	}
+
+#endif
 
+// Operands written to. Scripts assign their members in place, so the writes
+// to member addresses are journaled on the owner here.
+#define GET_DST_VARIANT_PTR(m_v, m_code_ofs)                                                                                            \
+	GET_VARIANT_PTR(m_v, m_code_ofs);                                                                                                   \
+	if (unlikely((_code_ptr[ip + m_code_ofs] & ADDR_TYPE_MASK) == (ADDR_TYPE_MEMBER << ADDR_BITS)) && p_instance->owner->is_change_tracking()) \
+		p_instance->_mark_member_changed(_code_ptr[ip + m_code_ofs] & ADDR_MASK);
+
+// Generic operator, the typed operators fall back to it when the operands are not what the compiler expected.
+#ifdef DEBUG_ENABLED
+#define EVALUATE_OPERATOR(m_op, m_a, m_b, m_dst)                                                                                                                                                               \
+	{                                                                                                                                                                                                          \
+		bool valid;                                                                                                                                                                                            \
+		Variant ret;                                                                                                                                                                                           \
+		Variant::evaluate(m_op, *m_a, *m_b, ret, valid);                                                                                                                                                       \
+		if (!valid) {                                                                                                                                                                                          \
+			if (ret.get_type() == Variant::STRING) {                                                                                                                                                           \
+				/* return a string when invalid with the error */                                                                                                                                              \
+				err_text = ret;                                                                                                                                                                                \
+				err_text += " in operator '" + Variant::get_operator_name(m_op) + "'.";                                                                                                                        \
+			} else {                                                                                                                                                                                           \
+				err_text = "Invalid operands '" + Variant::get_type_name(m_a->get_type()) + "' and '" + Variant::get_type_name(m_b->get_type()) + "' in operator '" + Variant::get_operator_name(m_op) + "'."; \
+			}                                                                                                                                                                                                  \
+			OPCODE_BREAK;                                                                                                                                                                                      \
+		}                                                                                                                                                                                                      \
+		*m_dst = ret;                                                                                                                                                                                          \
+	}
+#else
+#define EVALUATE_OPERATOR(m_op, m_a, m_b, m_dst)            \
+	{                                                       \
+		bool valid;                                         \
+		Variant::evaluate(m_op, *m_a, *m_b, *m_dst, valid); \
+	}
 #endif
 
 #ifdef DEBUG_ENABLED
@@ -448,46 +683,125 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				CHECK_SPACE(5);
 
-				bool valid;
 				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
 				GD_ERR_BREAK(op >= Variant::OP_MAX);
 
 				GET_VARIANT_PTR(a, 2);
 				GET_VARIANT_PTR(b, 3);
-				GET_VARIANT_PTR(dst, 4);
+				GET_DST_VARIANT_PTR(dst, 4);
 
-#ifdef DEBUG_ENABLED
+				EVALUATE_OPERATOR(op, a, b, dst);
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
 
-				Variant ret;
-				Variant::evaluate(op, *a, *b, ret, valid);
-#else
-				Variant::evaluate(op, *a, *b, *dst, valid);
-#endif
-#ifdef DEBUG_ENABLED
-				if (!valid) {
+			OPCODE(OPCODE_OPERATOR_INT) {
 
-					if (ret.get_type() == Variant::STRING) {
-						//return a string when invalid with the error
-						err_text = ret;
-						err_text += " in operator '" + Variant::get_operator_name(op) + "'.";
-					} else {
-						err_text = "Invalid operands '" + Variant::get_type_name(a->get_type()) + "' and '" + Variant::get_type_name(b->get_type()) + "' in operator '" + Variant::get_operator_name(op) + "'.";
-					}
-					OPCODE_BREAK;
-				}
-				*dst = ret;
-#endif
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_DST_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_int(op, a, b, dst)))
+					EVALUATE_OPERATOR(op, a, b, dst);
 				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_REAL) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_DST_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_real(op, a, b, dst)))
+					EVALUATE_OPERATOR(op, a, b, dst);
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VECTOR2) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_DST_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_vector2(op, a, b, dst)))
+					EVALUATE_OPERATOR(op, a, b, dst);
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VECTOR3) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_DST_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_vector3(op, a, b, dst)))
+					EVALUATE_OPERATOR(op, a, b, dst);
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_JUMP_IF)
+			OPCODE(OPCODE_OPERATOR_JUMP_IF_NOT) {
+
+				// an operator and the conditional jump testing its result, the jump is
+				// still in the code after it so anything jumping there runs it alone
+				CHECK_SPACE(8);
+				bool jump_if = _code_ptr[ip] == OPCODE_OPERATOR_JUMP_IF;
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_DST_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_typed(op, a, b, dst)))
+					EVALUATE_OPERATOR(op, a, b, dst);
+
+				GET_VARIANT_PTR(test, 6);
+
+				bool result = test->get_type() == Variant::BOOL ? *VariantInternal::get_bool(test) : test->booleanize();
+
+				if (result == jump_if) {
+					int to = _code_ptr[ip + 7];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 8;
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 
 				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(a, 1);
 				GET_VARIANT_PTR(b, 2);
-				GET_VARIANT_PTR(dst, 3);
+				GET_DST_VARIANT_PTR(dst, 3);
 
 #ifdef DEBUG_ENABLED
 				if (b->get_type() != Variant::OBJECT || b->operator Object *() == NULL) {
@@ -557,7 +871,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				GET_VARIANT_PTR(value, 1);
 				Variant::Type var_type = (Variant::Type)_code_ptr[ip + 2];
-				GET_VARIANT_PTR(dst, 3);
+				GET_DST_VARIANT_PTR(dst, 3);
 
 				GD_ERR_BREAK(var_type < 0 || var_type >= Variant::VARIANT_MAX);
 
@@ -570,7 +884,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				CHECK_SPACE(3);
 
-				GET_VARIANT_PTR(dst, 1);
+				GET_DST_VARIANT_PTR(dst, 1);
 				GET_VARIANT_PTR(index, 2);
 				GET_VARIANT_PTR(value, 3);
 
@@ -599,7 +913,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				GET_VARIANT_PTR(src, 1);
 				GET_VARIANT_PTR(index, 2);
-				GET_VARIANT_PTR(dst, 3);
+				GET_DST_VARIANT_PTR(dst, 3);
 
 				bool valid;
 #ifdef DEBUG_ENABLED
@@ -630,7 +944,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				CHECK_SPACE(3);
 
-				GET_VARIANT_PTR(dst, 1);
+				GET_DST_VARIANT_PTR(dst, 1);
 				GET_VARIANT_PTR(value, 3);
 
 				int indexname = _code_ptr[ip + 2];
@@ -657,7 +971,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(src, 1);
-				GET_VARIANT_PTR(dst, 3);
+				GET_DST_VARIANT_PTR(dst, 3);
 
 				int indexname = _code_ptr[ip + 2];
 
@@ -687,6 +1001,88 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_SET_COMPONENT) {
+
+				CHECK_SPACE(6);
+
+				GET_DST_VARIANT_PTR(dst, 1);
+				GET_VARIANT_PTR(value, 5);
+
+				int indexname = _code_ptr[ip + 2];
+				Variant::Type type = (Variant::Type)_code_ptr[ip + 3];
+				int component = _code_ptr[ip + 4];
+
+				Variant::Type value_type = value->get_type();
+				if (likely(dst->get_type() == type && (value_type == Variant::REAL || value_type == Variant::INT))) {
+
+					real_t v = value_type == Variant::REAL ? (real_t)*VariantInternal::get_real(value) : (real_t)*VariantInternal::get_int(value);
+					switch (type) {
+						case Variant::VECTOR2: (*VariantInternal::get_vector2(dst))[component] = v; break;
+						case Variant::VECTOR3: (*VariantInternal::get_vector3(dst))[component] = v; break;
+						case Variant::COLOR: (*VariantInternal::get_color(dst))[component] = v; break;
+						default: {
+						}
+					}
+				} else {
+
+					GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+					const StringName *index = &_global_names_ptr[indexname];
+
+					bool valid;
+					dst->set_named(*index, *value, &valid);
+
+#ifdef DEBUG_ENABLED
+					if (!valid) {
+						err_text = "Invalid set index '" + String(*index) + "' (on base: '" + _get_var_type(dst) + "') with value of type '" + _get_var_type(value) + "'.";
+						OPCODE_BREAK;
+					}
+#endif
+				}
+				ip += 6;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_COMPONENT) {
+
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(src, 1);
+				GET_DST_VARIANT_PTR(dst, 5);
+
+				int indexname = _code_ptr[ip + 2];
+				Variant::Type type = (Variant::Type)_code_ptr[ip + 3];
+				int component = _code_ptr[ip + 4];
+
+				if (likely(src->get_type() == type)) {
+
+					real_t v = 0;
+					switch (type) {
+						case Variant::VECTOR2: v = (*VariantInternal::get_vector2(src))[component]; break;
+						case Variant::VECTOR3: v = (*VariantInternal::get_vector3(src))[component]; break;
+						case Variant::COLOR: v = (*VariantInternal::get_color(src))[component]; break;
+						default: {
+						}
+					}
+					VariantInternal::set_real(dst, v);
+				} else {
+
+					GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+					const StringName *index = &_global_names_ptr[indexname];
+
+					bool valid;
+					Variant ret = src->get_named(*index, &valid);
+#ifdef DEBUG_ENABLED
+					if (!valid) {
+						err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "').";
+						OPCODE_BREAK;
+					}
+#endif
+					*dst = ret;
+				}
+				ip += 6;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_SET_MEMBER) {
 
 				CHECK_SPACE(3);
@@ -712,13 +1108,15 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_GET_MEMBER_OPERATOR)
 			OPCODE(OPCODE_GET_MEMBER) {
 
 				CHECK_SPACE(3);
+				bool fused = _code_ptr[ip] == OPCODE_GET_MEMBER_OPERATOR;
 				int indexname = _code_ptr[ip + 1];
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
-				GET_VARIANT_PTR(dst, 2);
+				GET_DST_VARIANT_PTR(dst, 2);
 
 #ifndef DEBUG_ENABLED
 				ClassDB::get_property(p_instance->owner, *index, *dst);
@@ -730,13 +1128,29 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 				ip += 3;
+
+				if (fused) {
+					// the operator using the member follows, run it without dispatching
+					CHECK_SPACE(5);
+
+					Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+					GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+					GET_VARIANT_PTR(op_a, 2);
+					GET_VARIANT_PTR(op_b, 3);
+					GET_DST_VARIANT_PTR(op_dst, 4);
+
+					if (unlikely(!_evaluate_typed(op, op_a, op_b, op_dst)))
+						EVALUATE_OPERATOR(op, op_a, op_b, op_dst);
+					ip += 5;
+				}
 			}
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_ASSIGN) {
 
 				CHECK_SPACE(3);
-				GET_VARIANT_PTR(dst, 1);
+				GET_DST_VARIANT_PTR(dst, 1);
 				GET_VARIANT_PTR(src, 2);
 
 				*dst = *src;
@@ -748,7 +1162,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_ASSIGN_TRUE) {
 
 				CHECK_SPACE(2);
-				GET_VARIANT_PTR(dst, 1);
+				GET_DST_VARIANT_PTR(dst, 1);
 
 				*dst = true;
 
@@ -759,7 +1173,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_ASSIGN_FALSE) {
 
 				CHECK_SPACE(2);
-				GET_VARIANT_PTR(dst, 1);
+				GET_DST_VARIANT_PTR(dst, 1);
 
 				*dst = false;
 
@@ -770,7 +1184,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_ASSIGN_TYPED_BUILTIN) {
 
 				CHECK_SPACE(4);
-				GET_VARIANT_PTR(dst, 2);
+				GET_DST_VARIANT_PTR(dst, 2);
 				GET_VARIANT_PTR(src, 3);
 
 				Variant::Type var_type = (Variant::Type)_code_ptr[ip + 1];
@@ -800,7 +1214,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_ASSIGN_TYPED_NATIVE) {
 
 				CHECK_SPACE(4);
-				GET_VARIANT_PTR(dst, 2);
+				GET_DST_VARIANT_PTR(dst, 2);
 				GET_VARIANT_PTR(src, 3);
 
 #ifdef DEBUG_ENABLED
@@ -829,7 +1243,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_ASSIGN_TYPED_SCRIPT) {
 
 				CHECK_SPACE(4);
-				GET_VARIANT_PTR(dst, 2);
+				GET_DST_VARIANT_PTR(dst, 2);
 				GET_VARIANT_PTR(src, 3);
 
 #ifdef DEBUG_ENABLED
@@ -882,7 +1296,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				CHECK_SPACE(4);
 				Variant::Type to_type = (Variant::Type)_code_ptr[ip + 1];
 				GET_VARIANT_PTR(src, 2);
-				GET_VARIANT_PTR(dst, 3);
+				GET_DST_VARIANT_PTR(dst, 3);
 
 				GD_ERR_BREAK(to_type < 0 || to_type >= Variant::VARIANT_MAX);
 
@@ -905,7 +1319,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				CHECK_SPACE(4);
 				GET_VARIANT_PTR(to_type, 1);
 				GET_VARIANT_PTR(src, 2);
-				GET_VARIANT_PTR(dst, 3);
+				GET_DST_VARIANT_PTR(dst, 3);
 
 				GDScriptNativeClass *nc = Object::cast_to<GDScriptNativeClass>(to_type->operator Object *());
 				GD_ERR_BREAK(!nc);
@@ -933,7 +1347,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				CHECK_SPACE(4);
 				GET_VARIANT_PTR(to_type, 1);
 				GET_VARIANT_PTR(src, 2);
-				GET_VARIANT_PTR(dst, 3);
+				GET_DST_VARIANT_PTR(dst, 3);
 
 				Script *base_type = Object::cast_to<Script>(to_type->operator Object *());
 
@@ -988,7 +1402,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					argptrs[i] = v;
 				}
 
-				GET_VARIANT_PTR(dst, 3 + argc);
+				GET_DST_VARIANT_PTR(dst, 3 + argc);
 				Variant::CallError err;
 				*dst = Variant::construct(t, (const Variant **)argptrs, argc, err);
 
@@ -1018,7 +1432,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					array[i] = *v;
 				}
 
-				GET_VARIANT_PTR(dst, 2 + argc);
+				GET_DST_VARIANT_PTR(dst, 2 + argc);
 
 				*dst = array;
 
@@ -1041,7 +1455,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					dict[*k] = *v;
 				}
 
-				GET_VARIANT_PTR(dst, 2 + argc * 2);
+				GET_DST_VARIANT_PTR(dst, 2 + argc * 2);
 
 				*dst = dict;
 
@@ -1086,7 +1500,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				Variant::CallError err;
 				if (call_ret) {
 
-					GET_VARIANT_PTR(ret, argc);
+					GET_DST_VARIANT_PTR(ret, argc);
 					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
 				} else {
 
@@ -1137,6 +1551,240 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_CALL_VALIDATED) {
+
+				CHECK_SPACE(5);
+
+				int argc = _code_ptr[ip + 1];
+				GET_VARIANT_PTR(base, 2);
+				int nameg = _code_ptr[ip + 3];
+				int callg = _code_ptr[ip + 4];
+
+				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
+				GD_ERR_BREAK(callg < 0 || callg >= _validated_calls_count);
+				const ValidatedCall &validated = _validated_calls_ptr[callg];
+
+				GD_ERR_BREAK(argc < 0);
+				ip += 5;
+				CHECK_SPACE(argc + 1);
+				Variant **argptrs = call_args;
+
+				for (int i = 0; i < argc; i++) {
+					GET_VARIANT_PTR(v, i);
+					argptrs[i] = v;
+				}
+
+				GET_DST_VARIANT_PTR(ret, argc);
+
+				bool validated_args = base->get_type() == validated.base_type;
+#ifdef DEBUG_ENABLED
+				// release builds trust the parser, like the conversions done by Variant::call
+				for (int i = 0; i < argc && validated_args; i++) {
+					Variant::Type arg_type = validated.argument_types[i];
+					validated_args = arg_type == Variant::NIL || argptrs[i]->get_type() == arg_type;
+				}
+#endif
+
+#ifdef DEBUG_ENABLED
+				uint64_t call_time = 0;
+
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					call_time = OS::get_singleton()->get_ticks_usec();
+				}
+
+#endif
+				Variant::CallError err;
+				if (likely(validated_args)) {
+
+					bool aliased = ret == base;
+					for (int i = 0; i < argc && !aliased; i++) {
+						aliased = ret == argptrs[i];
+					}
+
+					if (likely(!aliased)) {
+						validated.method(*ret, *base, (const Variant **)argptrs);
+					} else {
+						Variant result;
+						validated.method(result, *base, (const Variant **)argptrs);
+						*ret = result;
+					}
+				} else {
+					base->call_ptr(_global_names_ptr[nameg], (const Variant **)argptrs, argc, ret, err);
+				}
+
+#ifdef DEBUG_ENABLED
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+				}
+
+				if (err.error != Variant::CallError::CALL_OK) {
+
+					String methodstr = _global_names_ptr[nameg];
+					String basestr = _get_var_type(base);
+					err_text = _get_call_error(err, "function '" + methodstr + "' in base '" + basestr + "'", (const Variant **)argptrs);
+					OPCODE_BREAK;
+				}
+#endif
+				ip += argc + 1;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_CALL_METHOD_BIND_RETURN)
+			OPCODE(OPCODE_CALL_METHOD_BIND) {
+
+				CHECK_SPACE(5);
+				bool call_ret = _code_ptr[ip] == OPCODE_CALL_METHOD_BIND_RETURN;
+
+				int argc = _code_ptr[ip + 1];
+				GET_VARIANT_PTR(base, 2);
+				int nameg = _code_ptr[ip + 3];
+				int callg = _code_ptr[ip + 4];
+
+				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
+				GD_ERR_BREAK(callg < 0 || callg >= _method_bind_call_count);
+				const StringName *methodname = &_global_names_ptr[nameg];
+
+				GD_ERR_BREAK(argc < 0);
+				ip += 5;
+				CHECK_SPACE(argc + 1);
+				Variant **argptrs = call_args;
+
+				for (int i = 0; i < argc; i++) {
+					GET_VARIANT_PTR(v, i);
+					argptrs[i] = v;
+				}
+
+				GET_DST_VARIANT_PTR(ret, argc);
+
+				// Only receivers without a script or with a GDScript one are cached, the
+				// functions of any other script could shadow the native method.
+				Object *object = base->get_type() == Variant::OBJECT ? VariantInternal::get_object(base) : NULL;
+				GDScript *object_script = NULL;
+				if (object && object->get_script_instance()) {
+					ScriptInstance *si = object->get_script_instance();
+					if (!si->is_placeholder() && si->get_language() == GDScriptLanguage::get_singleton()) {
+						object_script = static_cast<GDScriptInstance *>(si)->script.ptr();
+					} else {
+						object = NULL;
+					}
+				}
+
+				MethodBindTarget *target = NULL;
+				if (object) {
+					target = _method_bind_targets[callg].load(std::memory_order_acquire);
+					if (unlikely(!target || target->class_name != object->get_class_name() || target->script != object_script || target->compile_generation != GDScriptLanguage::get_singleton()->get_compile_generation())) {
+						target = _resolve_method_bind(callg, object, object_script, *methodname);
+					}
+				}
+
+#ifdef DEBUG_ENABLED
+				uint64_t call_time = 0;
+
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					call_time = OS::get_singleton()->get_ticks_usec();
+				}
+
+#endif
+				Variant::CallError err;
+				if (likely(target && target->method)) {
+
+					MethodBind *method = target->method;
+					if (unlikely(object->is_change_tracking()) && method->get_setter_property() != StringName())
+						object->mark_property_changed(method->get_setter_property());
+
+					bool done = false;
+#ifdef PTRCALL_ENABLED
+					// Arguments holding exactly the bound types are passed without conversions.
+					int method_argc = method->get_argument_count();
+					if (target->ptrcall && argc <= method_argc && argc >= method_argc - method->get_default_argument_count()) {
+
+						const void *ptrargs[PTRCALL_MAX_ARGUMENTS];
+						int enum_args[PTRCALL_MAX_ARGUMENTS];
+						done = true;
+						for (int i = 0; i < method_argc && done; i++) {
+							const Variant *arg = i < argc ? argptrs[i] : &target->default_arguments[i];
+							int arg_type = target->argument_types[i];
+							if (arg_type == Variant::NIL) {
+								ptrargs[i] = arg;
+							} else if (arg->get_type() == arg_type) {
+								ptrargs[i] = VariantInternal::get_opaque_pointer(arg);
+							} else if (arg_type == PTRCALL_TYPE_ENUM && arg->get_type() == Variant::INT) {
+								enum_args[i] = *arg;
+								ptrargs[i] = &enum_args[i];
+							} else {
+								done = false;
+							}
+						}
+
+						if (done) {
+							err.error = Variant::CallError::CALL_OK;
+
+							bool aliased = ret == base;
+							for (int i = 0; i < argc && !aliased; i++) {
+								aliased = ret == argptrs[i];
+							}
+
+							int return_type = target->return_type;
+							if (!method->has_return()) {
+								method->ptrcall(object, ptrargs, NULL);
+								if (call_ret)
+									*ret = Variant();
+							} else if (return_type == Variant::OBJECT) {
+								Object *result = NULL;
+								method->ptrcall(object, ptrargs, &result);
+								if (call_ret)
+									*ret = result;
+							} else if (return_type == PTRCALL_TYPE_REFERENCE) {
+								Ref<Reference> result;
+								method->ptrcall(object, ptrargs, &result);
+								if (call_ret)
+									*ret = result;
+							} else if (return_type == PTRCALL_TYPE_ENUM) {
+								int result = 0;
+								method->ptrcall(object, ptrargs, &result);
+								if (call_ret)
+									*ret = result;
+							} else {
+								// the destination must hold the returned type before its payload is written
+								Variant discarded;
+								Variant *result = call_ret && !aliased ? ret : &discarded;
+								if (return_type != Variant::NIL && result->get_type() != return_type) {
+									Variant::CallError ce;
+									*result = Variant::construct((Variant::Type)return_type, NULL, 0, ce);
+								}
+								method->ptrcall(object, ptrargs, return_type == Variant::NIL ? (void *)result : VariantInternal::get_opaque_pointer(result));
+								if (call_ret && result != ret)
+									*ret = *result;
+							}
+						}
+					}
+#endif
+					if (!done) {
+						Variant result = method->call(object, (const Variant **)argptrs, argc, err);
+						if (call_ret && err.error == Variant::CallError::CALL_OK)
+							*ret = result;
+					}
+				} else {
+					base->call_ptr(*methodname, (const Variant **)argptrs, argc, call_ret ? ret : NULL, err);
+				}
+
+#ifdef DEBUG_ENABLED
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+				}
+
+				if (err.error != Variant::CallError::CALL_OK) {
+
+					String methodstr = *methodname;
+					String basestr = _get_var_type(base);
+					err_text = _get_call_error(err, "function '" + methodstr + "' in base '" + basestr + "'", (const Variant **)argptrs);
+					OPCODE_BREAK;
+				}
+#endif
+				ip += argc + 1;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_CALL_BUILT_IN) {
 
 				CHECK_SPACE(4);
@@ -1154,7 +1802,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					argptrs[i] = v;
 				}
 
-				GET_VARIANT_PTR(dst, argc);
+				GET_DST_VARIANT_PTR(dst, argc);
 
 				Variant::CallError err;
 
@@ -1207,7 +1855,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					argptrs[i] = v;
 				}
 
-				GET_VARIANT_PTR(dst, argc + 3);
+				GET_DST_VARIANT_PTR(dst, argc + 3);
 
 				const GDScript *gds = _script;
 
@@ -1281,7 +1929,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				gdfs->state.self = self;
 				gdfs->state.alloca_size = alloca_size;
 				gdfs->state.ip = ip + ipofs;
-				gdfs->state.line = line;
+				gdfs->state.line = _get_line(ip, line);
 				gdfs->state.script = _script;
 #ifndef NO_THREADS
 				GDScriptLanguage::singleton->lock->lock();
@@ -1369,7 +2017,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				GET_VARIANT_PTR(result, 1);
+				GET_DST_VARIANT_PTR(result, 1);
 				*result = p_state->result;
 				ip += 2;
 			}
@@ -1439,6 +2087,116 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				OPCODE_BREAK;
 			}
 
+			OPCODE(OPCODE_ITERATE_BEGIN_RANGE) {
+
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+				GET_VARIANT_PTR(step, 3);
+
+				// same bounds as Variant::iter_init, the container is replaced by the end
+				int64_t from_value = 0;
+				int64_t to_value = 0;
+				int64_t step_value = 1;
+				bool valid = true;
+
+				switch (container->get_type()) {
+					case Variant::INT: {
+						to_value = *VariantInternal::get_int(container);
+					} break;
+					case Variant::VECTOR2: {
+						const Vector2 *range = VariantInternal::get_vector2(container);
+						from_value = range->x;
+						to_value = range->y;
+					} break;
+					case Variant::VECTOR3: {
+						const Vector3 *range = VariantInternal::get_vector3(container);
+						from_value = range->x;
+						to_value = range->y;
+						step_value = range->z;
+					} break;
+					default: {
+						valid = false;
+						step_value = 0;
+					}
+				}
+
+#ifdef DEBUG_ENABLED
+				if (!valid) {
+					err_text = "Unable to iterate on object of type '" + Variant::get_type_name(container->get_type()) + "'.";
+					OPCODE_BREAK;
+				}
+#endif
+				VariantInternal::set_int(counter, from_value);
+				VariantInternal::set_int(step, step_value);
+				*container = to_value;
+
+				if (step_value == 0 || (step_value > 0 ? from_value >= to_value : from_value <= to_value)) {
+					int jumpto = _code_ptr[ip + 4];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 5);
+
+					VariantInternal::set_int(iterator, from_value);
+					ip += 6;
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_RANGE) {
+
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(to, 2);
+				GET_VARIANT_PTR(step, 3);
+
+				// all of them are ints, set by the range iterate begin
+				int64_t step_value = *VariantInternal::get_int(step);
+				int64_t value = *VariantInternal::get_int(counter) + step_value;
+
+				if (step_value > 0 ? value >= *VariantInternal::get_int(to) : value <= *VariantInternal::get_int(to)) {
+					int jumpto = _code_ptr[ip + 4];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 5);
+
+					*VariantInternal::get_int(counter) = value;
+					VariantInternal::set_int(iterator, value);
+					ip += 6; //loop again
+				}
+			}
+			DISPATCH_OPCODE;
+
+			// The array iterates fall through to the generic ones when the container is not an array,
+			// they use the same operands.
+			OPCODE(OPCODE_ITERATE_BEGIN_ARRAY) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				if (likely(container->get_type() == Variant::ARRAY)) {
+
+					const Array *array = VariantInternal::get_array(container);
+					if (array->empty()) {
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+						GET_VARIANT_PTR(iterator, 4);
+
+						VariantInternal::set_int(counter, 0);
+						*iterator = array->get(0);
+						ip += 5;
+					}
+					DISPATCH_OPCODE;
+				}
+			}
 			OPCODE(OPCODE_ITERATE_BEGIN) {
 
 				CHECK_SPACE(8); //space for this a regular iterate
@@ -1472,6 +2230,32 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_ITERATE_ARRAY) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				if (likely(container->get_type() == Variant::ARRAY && counter->get_type() == Variant::INT)) {
+
+					const Array *array = VariantInternal::get_array(container);
+					int64_t idx = *VariantInternal::get_int(counter) + 1;
+
+					if (idx >= array->size()) {
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+						GET_VARIANT_PTR(iterator, 4);
+
+						*VariantInternal::get_int(counter) = idx;
+						*iterator = array->get(idx);
+						ip += 5; //loop again
+					}
+					DISPATCH_OPCODE;
+				}
+			}
 			OPCODE(OPCODE_ITERATE) {
 
 				CHECK_SPACE(4);
@@ -1602,7 +2386,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		String err_func = name;
 		if (p_instance && ObjectDB::instance_validate(p_instance->owner) && p_instance->script->is_valid() && p_instance->script->name != "")
 			err_func = p_instance->script->name + "." + err_func;
-		int err_line = line;
+		int err_line = _get_line(ip, line);
 		if (err_text == "") {
 			err_text = "Internal Script Error! - opcode #" + itos(last_opcode) + " (report please).";
 		}
@@ -1658,6 +2442,10 @@ int GDScriptFunction::get_code_size() const {
 
 	return _code_size;
 }
+const Vector<Pair<int, int> > &GDScriptFunction::get_line_table() const {
+
+	return line_table;
+}
 
 Variant GDScriptFunction::get_constant(int p_idx) const {
 
@@ -1770,11 +2558,134 @@ void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<String
 	}
 }
 
+GDScriptFunction::MethodBindTarget *GDScriptFunction::_resolve_method_bind(int p_call, Object *p_object, GDScript *p_script, const StringName &p_method) const {
+
+	std::atomic<MethodBindTarget *> &slot = _method_bind_targets[p_call];
+	MethodBindTarget *previous = slot.load(std::memory_order_acquire);
+
+	// A site that keeps seeing new classes is left to Object::call.
+	bool miss = previous && (previous->class_name != p_object->get_class_name() || previous->script != p_script);
+	int misses = previous ? previous->misses + (miss ? 1 : 0) : 0;
+	if (misses > METHOD_BIND_MAX_MISSES)
+		return NULL;
+
+	MethodBindTarget *target = memnew(MethodBindTarget);
+	target->class_name = p_object->get_class_name();
+	target->script = p_script;
+	target->compile_generation = GDScriptLanguage::get_singleton()->get_compile_generation();
+	target->method = NULL;
+	target->ptrcall = false;
+	target->return_type = Variant::NIL;
+	target->misses = misses;
+	target->previous = previous;
+
+	bool scripted = false;
+	for (const GDScript *script = p_script; script && !scripted; script = script->_base) {
+		scripted = script->member_functions.has(p_method);
+	}
+
+	if (!scripted) {
+		target->method = ClassDB::get_method(target->class_name, p_method);
+	}
+
+#ifdef PTRCALL_ENABLED
+	MethodBind *method = target->method;
+	if (method && !method->is_vararg() && method->get_argument_count() <= PTRCALL_MAX_ARGUMENTS) {
+
+		int argc = method->get_argument_count();
+		int first_default = argc - method->get_default_argument_count();
+		target->default_arguments.resize(argc);
+		target->ptrcall = true;
+
+		for (int i = 0; i < argc; i++) {
+			int type = method->get_ptrcall_type(i);
+			target->argument_types[i] = type;
+			// objects would be passed without the class check of MethodBind::call
+			if (type == Variant::OBJECT || type == PTRCALL_TYPE_REFERENCE || type == PTRCALL_TYPE_CONVERTED) {
+				target->ptrcall = false;
+			}
+			if (i >= first_default) {
+				Variant default_argument = method->get_default_argument(i);
+				int default_type = type == PTRCALL_TYPE_ENUM ? (int)Variant::INT : type;
+				if (type != Variant::NIL && default_argument.get_type() != default_type) {
+					target->ptrcall = false;
+				}
+				target->default_arguments.write[i] = default_argument;
+			}
+		}
+
+		if (method->has_return()) {
+			target->return_type = method->get_ptrcall_type(-1);
+			if (target->return_type == PTRCALL_TYPE_CONVERTED) {
+				target->ptrcall = false;
+			}
+		}
+	}
+#endif
+
+	if (!slot.compare_exchange_strong(previous, target, std::memory_order_acq_rel)) {
+		// another thread resolved this site meanwhile, use the slow path this time
+		memdelete(target);
+		return NULL;
+	}
+
+	return target;
+}
+
+void GDScriptFunction::_set_method_bind_call_count(int p_count) {
+
+	for (int i = 0; i < _method_bind_call_count; i++) {
+		MethodBindTarget *target = _method_bind_targets[i].load(std::memory_order_relaxed);
+		while (target) {
+			MethodBindTarget *previous = target->previous;
+			memdelete(target);
+			target = previous;
+		}
+	}
+	if (_method_bind_targets) {
+		memdelete_arr(_method_bind_targets);
+		_method_bind_targets = NULL;
+	}
+
+	_method_bind_call_count = p_count;
+	if (p_count) {
+		_method_bind_targets = memnew_arr(std::atomic<MethodBindTarget *>, p_count);
+		for (int i = 0; i < p_count; i++) {
+			_method_bind_targets[i].store(NULL, std::memory_order_relaxed);
+		}
+	}
+}
+
+int GDScriptFunction::_get_line(int p_ip, int p_line) const {
+
+	// code with OPCODE_LINE keeps the line up to date by itself
+	if (line_table.empty())
+		return p_line;
+
+	int line = _initial_line;
+	int low = 0;
+	int high = line_table.size() - 1;
+	while (low <= high) {
+		int middle = (low + high) / 2;
+		if (line_table[middle].first <= p_ip) {
+			line = line_table[middle].second;
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+	return line;
+}
+
 GDScriptFunction::GDScriptFunction() :
 		function_list(this) {
 
 	_stack_size = 0;
 	_call_size = 0;
+	_validated_calls_ptr = NULL;
+	_validated_calls_count = 0;
+	_method_bind_targets = NULL;
+	_method_bind_call_count = 0;
 	rpc_mode = MultiplayerAPI::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1803,6 +2714,9 @@ GDScriptFunction::GDScriptFunction() :
 }
 
 GDScriptFunction::~GDScriptFunction() {
+
+	_set_method_bind_call_count(0);
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
@@ -39,6 +39,8 @@
 #include "core/string_name.h"
 #include "core/variant.h"
 
+#include <atomic>
+
 class GDScriptInstance;
 class GDScript;
 
@@ -156,14 +158,23 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_INT,
+		OPCODE_OPERATOR_REAL,
+		OPCODE_OPERATOR_VECTOR2,
+		OPCODE_OPERATOR_VECTOR3,
+		OPCODE_OPERATOR_JUMP_IF, // operator followed by the jump testing its result
+		OPCODE_OPERATOR_JUMP_IF_NOT,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
 		OPCODE_GET,
 		OPCODE_SET_NAMED,
 		OPCODE_GET_NAMED,
+		OPCODE_SET_COMPONENT,
+		OPCODE_GET_COMPONENT,
 		OPCODE_SET_MEMBER,
 		OPCODE_GET_MEMBER,
+		OPCODE_GET_MEMBER_OPERATOR, // get member followed by an operator
 		OPCODE_ASSIGN,
 		OPCODE_ASSIGN_TRUE,
 		OPCODE_ASSIGN_FALSE,
@@ -178,6 +189,9 @@ public:
 		OPCODE_CONSTRUCT_DICTIONARY,
 		OPCODE_CALL,
 		OPCODE_CALL_RETURN,
+		OPCODE_CALL_VALIDATED,
+		OPCODE_CALL_METHOD_BIND,
+		OPCODE_CALL_METHOD_BIND_RETURN,
 		OPCODE_CALL_BUILT_IN,
 		OPCODE_CALL_SELF,
 		OPCODE_CALL_SELF_BASE,
@@ -191,6 +205,10 @@ public:
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_BEGIN_RANGE,
+		OPCODE_ITERATE_RANGE,
+		OPCODE_ITERATE_BEGIN_ARRAY,
+		OPCODE_ITERATE_ARRAY,
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
@@ -221,8 +239,38 @@ public:
 		StringName identifier;
 	};
 
+	// Built-in method resolved by the compiler for OPCODE_CALL_VALIDATED.
+	struct ValidatedCall {
+		Variant::ValidatedMethod method;
+		Variant::Type base_type;
+		StringName name;
+		Vector<Variant::Type> argument_types; // NIL accepts anything
+	};
+
+	enum {
+		PTRCALL_MAX_ARGUMENTS = 16, // more than any generated binder takes
+		METHOD_BIND_MAX_MISSES = 4,
+	};
+
+	// Native method an OPCODE_CALL_METHOD_BIND site resolved for the class and
+	// GDScript of a receiver. Targets never change once published, a receiver of
+	// another class links a new target in front of the old one.
+	struct MethodBindTarget {
+		StringName class_name;
+		GDScript *script; // NULL for receivers without a script
+		uint32_t compile_generation;
+		MethodBind *method; // NULL when the script defines the method, or nobody does
+		bool ptrcall;
+		int return_type; // PtrToArgType of the return value
+		int argument_types[PTRCALL_MAX_ARGUMENTS];
+		Vector<Variant> default_arguments; // indexed like the arguments
+		int misses;
+		MethodBindTarget *previous;
+	};
+
 private:
 	friend class GDScriptCompiler;
+	friend class GDScriptBytecode;
 
 	StringName source;
 
@@ -237,6 +285,10 @@ private:
 #endif
 	const int *_default_arg_ptr;
 	int _default_arg_count;
+	const ValidatedCall *_validated_calls_ptr;
+	int _validated_calls_count;
+	std::atomic<MethodBindTarget *> *_method_bind_targets;
+	int _method_bind_call_count;
 	const int *_code_ptr;
 	int _code_size;
 	int _argument_count;
@@ -255,7 +307,9 @@ private:
 	Vector<StringName> named_globals;
 #endif
 	Vector<int> default_arguments;
+	Vector<ValidatedCall> validated_calls;
 	Vector<int> code;
+	Vector<Pair<int, int> > line_table; // (code position, line) when no OPCODE_LINE is emitted
 	Vector<GDScriptDataType> argument_types;
 	GDScriptDataType return_type;
 
@@ -267,6 +321,9 @@ private:
 
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
+	MethodBindTarget *_resolve_method_bind(int p_call, Object *p_object, GDScript *p_script, const StringName &p_method) const;
+	void _set_method_bind_call_count(int p_count);
+	int _get_line(int p_ip, int p_line) const;
 
 	friend class GDScriptLanguage;
 
@@ -313,6 +370,7 @@ public:
 
 	const int *get_code() const; //used for debug
 	int get_code_size() const;
+	const Vector<Pair<int, int> > &get_line_table() const; //used for debug
 	Variant get_constant(int p_idx) const;
 	StringName get_global_name(int p_idx) const;
 	StringName get_name() const;
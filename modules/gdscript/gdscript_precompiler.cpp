@@ -0,0 +1,273 @@
+/*************************************************************************/
+/*  gdscript_precompiler.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_precompiler.h"
+
+#include "core/os/file_access.h"
+#include "core/project_settings.h"
+#include "core/script_language.h"
+#include "gdscript_bytecode.h"
+#include "gdscript_tokenizer.h"
+
+int GDScriptPrecompiler::_add_script(const String &p_path) {
+
+	String path = p_path.replace("///", "//").simplify_path();
+	if (!path.begins_with("res://")) {
+		path = "res://" + path;
+	}
+
+	const Map<String, int>::Element *E = indices.find(path);
+	if (E) {
+		return E->get();
+	}
+
+	Entry entry;
+	entry.precompiler = this;
+	entry.path = path;
+	entry.threadable = true;
+	entry.visit = VISIT_NONE;
+	entry.task = WorkerThreadPool::INVALID_TASK_ID;
+
+	int index = scripts.size();
+	scripts.push_back(entry);
+	indices[path] = index;
+	return index;
+}
+
+void GDScriptPrecompiler::_scan_dependencies(int p_index) {
+
+	String path = scripts[p_index].path;
+
+	// exported projects remap the scripts to their .gdc (or encrypted .gde) version
+	String file = ResourceLoader::path_remap(path);
+	String extension = file.get_extension().to_lower();
+
+	Vector<uint8_t> buffer;
+	if (extension == "gd" || extension == "gdc") {
+		buffer = FileAccess::get_file_as_array(file);
+	}
+	if (buffer.empty()) {
+		scripts.write[p_index].threadable = false;
+		return;
+	}
+
+	GDScriptTokenizerText text;
+	GDScriptTokenizerBuffer binary;
+	GDScriptTokenizer *tokenizer = &text;
+
+	if (extension == "gdc") {
+		if (GDScriptBytecode::is_compiled_buffer(buffer)) {
+			buffer = GDScriptBytecode::get_tokens(buffer);
+		}
+		if (binary.set_code_buffer(buffer) != OK) {
+			scripts.write[p_index].threadable = false;
+			return;
+		}
+		tokenizer = &binary;
+	} else {
+		String source;
+		if (source.parse_utf8((const char *)buffer.ptr(), buffer.size())) {
+			scripts.write[p_index].threadable = false;
+			return;
+		}
+		text.set_code(source);
+	}
+
+	String base_dir = path.get_base_dir();
+	Vector<int> dependencies;
+	bool threadable = true;
+
+	while (tokenizer->get_token() != GDScriptTokenizer::TK_EOF) {
+
+		String dependency;
+
+		switch (tokenizer->get_token()) {
+			case GDScriptTokenizer::TK_ERROR: {
+				// let the main thread report it
+				threadable = false;
+			} break;
+			case GDScriptTokenizer::TK_PR_EXTENDS: {
+				if (tokenizer->get_token(1) == GDScriptTokenizer::TK_CONSTANT && tokenizer->get_token_constant(1).get_type() == Variant::STRING) {
+					dependency = tokenizer->get_token_constant(1);
+				}
+			} break;
+			case GDScriptTokenizer::TK_PR_PRELOAD: {
+				if (tokenizer->get_token(1) == GDScriptTokenizer::TK_PARENTHESIS_OPEN && tokenizer->get_token(2) == GDScriptTokenizer::TK_CONSTANT && tokenizer->get_token_constant(2).get_type() == Variant::STRING) {
+					dependency = tokenizer->get_token_constant(2);
+				} else {
+					// a preload of a named constant, its path is only known to the parser
+					threadable = false;
+				}
+			} break;
+			case GDScriptTokenizer::TK_IDENTIFIER: {
+				// class_name and autoload scripts are loaded by the parser when they are named
+				const Map<StringName, String>::Element *E = global_scripts.find(tokenizer->get_token_identifier());
+				if (E) {
+					dependency = E->get();
+				}
+			} break;
+			default: {
+			}
+		}
+
+		if (!threadable) {
+			break;
+		}
+
+		if (dependency != "") {
+			if (dependency.is_rel_path()) {
+				dependency = base_dir.plus_file(dependency);
+			}
+
+			// loading anything but a script could touch the servers, which is only safe on the main thread
+			if (dependency.get_extension().to_lower() != "gd") {
+				threadable = false;
+				break;
+			}
+
+			int index = _add_script(dependency);
+			if (index != p_index && dependencies.find(index) == -1) {
+				dependencies.push_back(index);
+			}
+		}
+
+		tokenizer->advance();
+	}
+
+	scripts.write[p_index].dependencies = dependencies;
+	scripts.write[p_index].threadable = threadable;
+}
+
+bool GDScriptPrecompiler::_schedule(int p_index) {
+
+	Entry &entry = entries[p_index];
+	if (entry.visit == VISIT_DONE) {
+		return entry.task != WorkerThreadPool::INVALID_TASK_ID;
+	}
+	if (entry.visit == VISIT_ACTIVE) {
+		// a cycle, its scripts load each other
+		return false;
+	}
+	entry.visit = VISIT_ACTIVE;
+
+	bool schedulable = entry.threadable;
+	Vector<WorkerThreadPool::TaskID> dependencies;
+	for (int i = 0; i < entry.dependencies.size() && schedulable; i++) {
+		if (_schedule(entry.dependencies[i])) {
+			dependencies.push_back(entries[entry.dependencies[i]].task);
+		} else {
+			schedulable = false;
+		}
+	}
+
+	entry.visit = VISIT_DONE;
+	if (schedulable) {
+		entry.task = WorkerThreadPool::get_singleton()->add_task(_load_task, &entry, dependencies.ptr(), dependencies.size());
+	}
+	return schedulable;
+}
+
+void GDScriptPrecompiler::_load_task(void *p_userdata) {
+
+	Entry *entry = (Entry *)p_userdata;
+
+	// the main thread loads it again after a dependency failed, and reports the error
+	for (int i = 0; i < entry->dependencies.size(); i++) {
+		if (entry->precompiler->entries[entry->dependencies[i]].resource.is_null()) {
+			return;
+		}
+	}
+
+	entry->resource = ResourceLoader::load(entry->path, "Script");
+}
+
+void GDScriptPrecompiler::precompile(const Vector<String> &p_paths, List<RES> *r_scripts) {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND(!pool);
+
+	for (int i = 0; i < p_paths.size(); i++) {
+		if (p_paths[i].get_extension().to_lower() == "gd") {
+			_add_script(p_paths[i]);
+		}
+	}
+
+	// scanning adds the dependencies at the end, so they are scanned too
+	for (int i = 0; i < scripts.size(); i++) {
+		_scan_dependencies(i);
+	}
+
+	// dependencies are scheduled first, so their tasks exist when the dependent task is added
+	entries = scripts.ptrw();
+	for (int i = 0; i < scripts.size(); i++) {
+		_schedule(i);
+	}
+
+	int loaded = 0;
+	for (int i = 0; i < scripts.size(); i++) {
+		if (entries[i].task == WorkerThreadPool::INVALID_TASK_ID) {
+			continue;
+		}
+		pool->wait_for_task(entries[i].task);
+		if (entries[i].resource.is_valid()) {
+			r_scripts->push_back(entries[i].resource);
+			loaded++;
+		}
+	}
+	entries = NULL;
+
+	print_verbose("GDScript: precompiled " + itos(loaded) + " of " + itos(scripts.size()) + " startup scripts on " + itos(pool->get_thread_count()) + " worker threads.");
+}
+
+GDScriptPrecompiler::GDScriptPrecompiler() {
+
+	entries = NULL;
+
+	List<StringName> classes;
+	ScriptServer::get_global_class_list(&classes);
+	for (List<StringName>::Element *E = classes.front(); E; E = E->next()) {
+		global_scripts[E->get()] = ScriptServer::get_global_class_path(E->get());
+	}
+
+	List<PropertyInfo> props;
+	ProjectSettings::get_singleton()->get_property_list(&props);
+	for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+
+		String s = E->get().name;
+		if (!s.begins_with("autoload/")) {
+			continue;
+		}
+		String path = ProjectSettings::get_singleton()->get(s);
+		if (path.begins_with("*")) {
+			path = path.right(1);
+		}
+		global_scripts[s.get_slice("/", 1)] = path;
+	}
+}
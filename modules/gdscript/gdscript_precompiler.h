@@ -0,0 +1,78 @@
+/*************************************************************************/
+/*  gdscript_precompiler.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_PRECOMPILER_H
+#define GDSCRIPT_PRECOMPILER_H
+
+#include "core/io/resource_loader.h"
+#include "core/os/worker_thread_pool.h"
+
+// Loads the scripts needed at startup on the worker thread pool, so the main thread finds them in the resource cache.
+// Each script is a task that depends on the tasks of the scripts it extends or preloads, anything that could load
+// other resources or is part of a cycle is left for the main thread.
+class GDScriptPrecompiler {
+
+	enum Visit {
+		VISIT_NONE,
+		VISIT_ACTIVE,
+		VISIT_DONE,
+	};
+
+	struct Entry {
+		GDScriptPrecompiler *precompiler;
+		String path;
+		Vector<int> dependencies;
+		bool threadable;
+		Visit visit;
+		WorkerThreadPool::TaskID task;
+		RES resource;
+	};
+
+	Vector<Entry> scripts;
+	Map<String, int> indices;
+	Map<StringName, String> global_scripts;
+
+	// scripts while the tasks run, the vector doesn't change then
+	Entry *entries;
+
+	int _add_script(const String &p_path);
+	void _scan_dependencies(int p_index);
+	bool _schedule(int p_index);
+
+	static void _load_task(void *p_userdata);
+
+public:
+	// Loads p_paths and the scripts they depend on, the calling thread takes part.
+	void precompile(const Vector<String> &p_paths, List<RES> *r_scripts);
+
+	GDScriptPrecompiler();
+};
+
+#endif // GDSCRIPT_PRECOMPILER_H
@@ -33,6 +33,7 @@
 #include "core/io/marshalls.h"
 #include "core/map.h"
 #include "core/print_string.h"
+#include "core/string_buffer.h"
 #include "gdscript_functions.h"
 
 const char *GDScriptTokenizer::token_names[TK_MAX] = {
@@ -768,7 +769,7 @@ void GDScriptTokenizerText::_advance() {
 					string_mode = STRING_MULTILINE;
 				}
 
-				String str;
+				StringBuffer<> str;
 				while (true) {
 					if (CharType(GETCHAR(i)) == 0) {
 
@@ -866,9 +867,9 @@ void GDScriptTokenizerText::_advance() {
 				INCPOS(i);
 
 				if (is_node_path) {
-					_make_constant(NodePath(str));
+					_make_constant(NodePath(str.as_string()));
 				} else {
-					_make_constant(str);
+					_make_constant(str.as_string());
 				}
 
 			} break;
@@ -972,15 +973,13 @@ void GDScriptTokenizerText::_advance() {
 				}
 
 				if (_is_text_char(GETCHAR(0))) {
-					// parse identifier
-					String str;
-					str += CharType(GETCHAR(0));
-
+					// parse identifier, looked up in place so only the names
+					// that are neither keywords nor built-ins get interned
 					int i = 1;
 					while (_is_text_char(GETCHAR(i))) {
-						str += CharType(GETCHAR(i));
 						i++;
 					}
+					StringView str(&_code[code_pos], i);
 
 					bool identifier = false;
 
@@ -1048,7 +1047,7 @@ void GDScriptTokenizerText::_advance() {
 					}
 
 					if (identifier) {
-						_make_identifier(str);
+						_make_identifier(StringName(str));
 					}
 					INCPOS(str.length());
 					return;
@@ -35,6 +35,7 @@
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
 #include "gdscript.h"
+#include "gdscript_bytecode.h"
 #include "gdscript_tokenizer.h"
 
 GDScriptLanguage *script_language_gd = NULL;
@@ -81,6 +82,14 @@ public:
 		txt.parse_utf8((const char *)file.ptr(), file.size());
 		file = GDScriptTokenizerBuffer::parse_code_string(txt);
 
+		// store the compiled code when the script allows it, loading it then skips the parser and the compiler
+		if (!file.empty()) {
+			Vector<uint8_t> compiled = GDScriptBytecode::make_compiled_buffer(txt, p_path, file);
+			if (!compiled.empty()) {
+				file = compiled;
+			}
+		}
+
 		if (!file.empty()) {
 
 			if (script_mode == EditorExportPreset::MODE_SCRIPT_ENCRYPTED) {
@@ -2,70 +2,172 @@
 
 FunctionProfiler *FunctionProfiler::singleton = NULL;
 
+std::atomic<bool> FunctionProfiler::s_Enabled(false);
+std::atomic<FunctionProfiler::ThreadBuffer *> FunctionProfiler::s_Buffers(NULL);
+thread_local FunctionProfiler::ThreadBuffer *FunctionProfiler::s_ThreadBuffer = NULL;
+
+Mutex *FunctionProfiler::s_ZoneMutex = NULL;
+HashMap<String, uint32_t> *FunctionProfiler::s_ZoneIds = NULL;
+Vector<String> *FunctionProfiler::s_ZoneNames = NULL;
+
 FunctionProfiler::FunctionProfiler()
 {
 	singleton = this;
+
+	if (!s_ZoneMutex)
+		s_ZoneMutex = Mutex::create();
+
+	s_Enabled = true;
 }
 
 FunctionProfiler::~FunctionProfiler()
 {
+	s_Enabled = false;
+
+	ThreadBuffer *buffer = s_Buffers.exchange(NULL);
+	while (buffer)
+	{
+		ThreadBuffer *next = buffer->next;
+		memdelete(buffer);
+		buffer = next;
+	}
+	s_ThreadBuffer = NULL;
+
+	if (s_ZoneIds)
+		memdelete(s_ZoneIds);
+	if (s_ZoneNames)
+		memdelete(s_ZoneNames);
+	s_ZoneIds = NULL;
+	s_ZoneNames = NULL;
+
+	memdelete(s_ZoneMutex);
+	s_ZoneMutex = NULL;
 
+	if (singleton == this)
+		singleton = NULL;
 }
 
-void FunctionProfiler::Begin(const StringName &functionName)
+uint32_t FunctionProfiler::GetZone(const char *name)
 {
-	Map<StringName, Data>::Element* e = profilingData.find(functionName);
-	if (!e)
-		e = profilingData.insert(functionName, Data());
+	if (!s_ZoneMutex)
+		s_ZoneMutex = Mutex::create();
 
-	Data &data = e->get();
-	if (data.IsProfiling)
+	MutexLock lock(s_ZoneMutex);
+
+	if (!s_ZoneIds)
 	{
-		ERR_PRINT("Profiling of function [" + functionName + "] already started!");
-		return;
+		s_ZoneIds = memnew((HashMap<String, uint32_t>));
+		s_ZoneNames = memnew(Vector<String>);
 	}
-	data.IsProfiling = true;
-	data.executionTimes.push_back(OS::get_singleton()->get_ticks_usec());
+
+	String zoneName = name;
+	const uint32_t *id = s_ZoneIds->getptr(zoneName);
+	if (id)
+		return *id;
+
+	uint32_t newId = s_ZoneNames->size();
+	s_ZoneNames->push_back(zoneName);
+	s_ZoneIds->set(zoneName, newId);
+	return newId;
 }
 
-void FunctionProfiler::End(const StringName &functionName)
+FunctionProfiler::ThreadBuffer *FunctionProfiler::CreateThreadBuffer()
 {
-	Map<StringName, Data>::Element *e = profilingData.find(functionName);
-	if (!e)
-	{
-		ERR_PRINT("Profiling of function [" + functionName + "] does not exist!");
-		return;
-	}
+	static std::atomic<uint32_t> threadCount(0);
+
+	ThreadBuffer *buffer = memnew(ThreadBuffer);
+	buffer->claimed.store(0, std::memory_order_relaxed);
+	buffer->head.store(0, std::memory_order_relaxed);
+	buffer->thread = threadCount.fetch_add(1, std::memory_order_relaxed);
 
-	Data &data = e->get();
-	if (!data.IsProfiling)
+	// lock-free push, buffers are only removed on shutdown
+	buffer->next = s_Buffers.load(std::memory_order_relaxed);
+	while (!s_Buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+		;
+
+	s_ThreadBuffer = buffer;
+	return buffer;
+}
+
+// Copies the valid part of a ring that its thread may still be writing to,
+// oldest first. Returns how many events were copied.
+uint32_t FunctionProfiler::CopyEvents(const ThreadBuffer *buffer, EventCopy *events)
+{
+	uint32_t head = buffer->head.load(std::memory_order_acquire);
+	uint32_t count = MIN(head, (uint32_t)BUFFER_SIZE);
+	uint32_t first = head - count;
+
+	for (uint32_t i = first; i != head; i++)
 	{
-		ERR_PRINT("Profiling of function [" + functionName + "] has not started yet!");
-		return;
+		const Event &event = buffer->events[i & (BUFFER_SIZE - 1)];
+		EventCopy &copy = events[i - first];
+		copy.time = event.time.load(std::memory_order_relaxed);
+		copy.zone = event.zone.load(std::memory_order_relaxed);
+		copy.begin = event.begin.load(std::memory_order_relaxed);
 	}
-	data.IsProfiling = false;
-	int lastIndex = data.executionTimes.size() - 1;
-	data.executionTimes.set(lastIndex, OS::get_singleton()->get_ticks_usec() - data.executionTimes.get(lastIndex));
+
+	// events claimed meanwhile may have overwritten the oldest ones, drop those
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint32_t claimed = buffer->claimed.load(std::memory_order_relaxed);
+	uint32_t overwritten = 0;
+	if (claimed > BUFFER_SIZE && claimed - BUFFER_SIZE > first)
+		overwritten = MIN(claimed - BUFFER_SIZE - first, count);
+
+	if (overwritten)
+		memmove(events, events + overwritten, sizeof(EventCopy) * (count - overwritten));
+	return count - overwritten;
 }
 
-void FunctionProfiler::SaveToFile()
+void FunctionProfiler::SaveToFile(const String &path)
 {
 	Error err;
-	FileAccess *file = FileAccess::open("data/function_time.csv", FileAccess::WRITE, &err);
+	FileAccess *file = FileAccess::open(path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_MSG(err != OK, "Cannot write function trace to '" + path + "'.");
+
+	Vector<String> names;
+	{
+		MutexLock lock(s_ZoneMutex);
+		if (s_ZoneNames)
+			names = *s_ZoneNames;
+	}
 
-	String content;
+	Vector<EventCopy> events;
+	events.resize(BUFFER_SIZE);
 
-	for (Map<StringName, Data>::Element *e = profilingData.front(); e; e = e->next())
+	file->store_string("{\"traceEvents\":[\n");
+
+	bool first = true;
+	for (ThreadBuffer *buffer = s_Buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
 	{
-		Data &data = e->get();
-		content += String(e->key()) + ";";
-		for (int i = 0; i < data.executionTimes.size(); i++)
+		uint32_t count = CopyEvents(buffer, events.ptrw());
+
+		// ends whose begin was overwritten have nothing to close
+		int depth = 0;
+
+		String content;
+		for (uint32_t i = 0; i < count; i++)
 		{
-			content += itos(data.executionTimes.get(i)) + (i == data.executionTimes.size() - 1 ? "\n" : ";");
+			const EventCopy &event = events[i];
+
+			if (event.begin)
+				depth++;
+			else if (depth == 0)
+				continue;
+			else
+				depth--;
+
+			if (event.zone >= (uint32_t)names.size())
+				continue;
+
+			content += String(first ? "" : ",\n") + "{\"name\":\"" + names[event.zone].json_escape() + "\",\"ph\":\"" + (event.begin ? "B" : "E") + "\",\"ts\":" + itos(event.time) + ",\"pid\":0,\"tid\":" + itos(buffer->thread) + "}";
+			first = false;
 		}
+
+		file->store_string(content);
 	}
 
-	file->store_string(content);
+	file->store_string("\n]}\n");
+
 	file->close();
 	memdelete(file);
 }
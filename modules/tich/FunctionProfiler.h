@@ -2,22 +2,28 @@
 #define FUNCTION_PROFILER_H
 
 #include "core/os/os.h"
-#include "main/Performance.h"
+#include "main/performance.h"
 
-#include "core/map.h"
+#include "core/hash_map.h"
 
-//#define DEBUG_FUNCTION_PROFILER
-
-#ifdef DEBUG_FUNCTION_PROFILER
-#define FUNCTION_PROFILER_BEGIN(x) FunctionProfiler::get_singleton()->Begin(x)
-#define FUNCTION_PROFILER_END(x) FunctionProfiler::get_singleton()->End(x)
-#define FUNCTION_PROFILER_SAVE() SaveToFile()
-#else
-#define FUNCTION_PROFILER_BEGIN(x)
-#define FUNCTION_PROFILER_END(x)
-#define FUNCTION_PROFILER_SAVE()
-#endif
+#include <atomic>
 
+// Zones are interned once per call site, recording a zone is a flag check,
+// a timestamp and a store into the calling thread's ring buffer.
+#define FUNCTION_PROFILER_BEGIN(x)                                                    \
+	{                                                                                 \
+		static const uint32_t _function_profiler_zone = FunctionProfiler::GetZone(x); \
+		FunctionProfiler::Begin(_function_profiler_zone);                             \
+	}
+#define FUNCTION_PROFILER_END(x)                                                      \
+	{                                                                                 \
+		static const uint32_t _function_profiler_zone = FunctionProfiler::GetZone(x); \
+		FunctionProfiler::End(_function_profiler_zone);                               \
+	}
+#define FUNCTION_PROFILER_ZONE(x)                                                    \
+	static const uint32_t _function_profiler_zone = FunctionProfiler::GetZone(x); \
+	FunctionProfiler::Scope _function_profiler_scope(_function_profiler_zone)
+#define FUNCTION_PROFILER_SAVE() FunctionProfiler::get_singleton()->SaveToFile()
 
 class FunctionProfiler : public Reference
 {
@@ -25,22 +31,94 @@ class FunctionProfiler : public Reference
 
 	static FunctionProfiler *singleton;
 
-	struct Data
+	enum
 	{
-		bool IsProfiling;
-		Vector<uint64_t> executionTimes;
+		BUFFER_SIZE = 1 << 14, // events per thread, the oldest are overwritten
+	};
+
+	// Fields are atomic so the exporter can copy them while they are written.
+	struct Event
+	{
+		std::atomic<uint64_t> time;
+		std::atomic<uint32_t> zone;
+		std::atomic<bool> begin;
+	};
+
+	// Written by its thread only, read by the exporter as a sequence lock.
+	// `claimed` moves before an event is written and `head` after, both count
+	// every event ever recorded.
+	struct ThreadBuffer
+	{
+		Event events[BUFFER_SIZE];
+		std::atomic<uint32_t> claimed;
+		std::atomic<uint32_t> head;
+		uint32_t thread;
+		ThreadBuffer *next;
+	};
+
+	struct EventCopy
+	{
+		uint64_t time;
+		uint32_t zone;
+		bool begin;
 	};
 
 private:
-	Map<StringName, Data> profilingData;
+	static std::atomic<bool> s_Enabled;
+	static std::atomic<ThreadBuffer *> s_Buffers;
+	static thread_local ThreadBuffer *s_ThreadBuffer;
+
+	static Mutex *s_ZoneMutex;
+	static HashMap<String, uint32_t> *s_ZoneIds;
+	static Vector<String> *s_ZoneNames;
+
+	static ThreadBuffer *CreateThreadBuffer();
+	static uint32_t CopyEvents(const ThreadBuffer *buffer, EventCopy *events);
+
+	static _FORCE_INLINE_ void Record(uint32_t zone, bool begin)
+	{
+		if (!s_Enabled.load(std::memory_order_relaxed))
+			return;
+
+		ThreadBuffer *buffer = s_ThreadBuffer;
+		if (unlikely(!buffer))
+			buffer = CreateThreadBuffer();
+
+		uint32_t head = buffer->head.load(std::memory_order_relaxed);
+		buffer->claimed.store(head + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Event &event = buffer->events[head & (BUFFER_SIZE - 1)];
+		event.time.store(OS::get_singleton()->get_ticks_usec(), std::memory_order_relaxed);
+		event.zone.store(zone, std::memory_order_relaxed);
+		event.begin.store(begin, std::memory_order_relaxed);
+		buffer->head.store(head + 1, std::memory_order_release);
+	}
 
 public:
+	class Scope
+	{
+		uint32_t zone;
+
+	public:
+		_FORCE_INLINE_ Scope(uint32_t p_zone) :
+				zone(p_zone) { Begin(zone); }
+		_FORCE_INLINE_ ~Scope() { End(zone); }
+	};
+
 	FunctionProfiler();
 	~FunctionProfiler();
 
-	void Begin(const StringName& functionName);
-	void End(const StringName& functionName);
-	void SaveToFile();
+	static uint32_t GetZone(const char *name);
+
+	static _FORCE_INLINE_ void Begin(uint32_t zone) { Record(zone, true); }
+	static _FORCE_INLINE_ void End(uint32_t zone) { Record(zone, false); }
+
+	static void SetEnabled(bool enabled) { s_Enabled.store(enabled, std::memory_order_relaxed); }
+	static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+	// Writes the recorded zones as Chrome trace events (chrome://tracing).
+	void SaveToFile(const String &path = "data/function_trace.json");
 
 	static FunctionProfiler *get_singleton() { return singleton; }
 };
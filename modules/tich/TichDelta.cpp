@@ -0,0 +1,50 @@
+#include "TichDelta.h"
+
+TichDelta::TichDelta() :
+	depth(1)
+{
+}
+
+void TichDelta::set_base_path(const String &p_path)
+{
+	basePath = p_path;
+}
+
+String TichDelta::get_base_path() const
+{
+	return basePath;
+}
+
+void TichDelta::set_depth(int p_depth)
+{
+	depth = p_depth;
+}
+
+int TichDelta::get_depth() const
+{
+	return depth;
+}
+
+void TichDelta::set_delta(const Dictionary &p_delta)
+{
+	delta = p_delta;
+}
+
+Dictionary TichDelta::get_delta() const
+{
+	return delta;
+}
+
+void TichDelta::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("set_base_path", "path"), &TichDelta::set_base_path);
+	ClassDB::bind_method(D_METHOD("get_base_path"), &TichDelta::get_base_path);
+	ClassDB::bind_method(D_METHOD("set_depth", "depth"), &TichDelta::set_depth);
+	ClassDB::bind_method(D_METHOD("get_depth"), &TichDelta::get_depth);
+	ClassDB::bind_method(D_METHOD("set_delta", "delta"), &TichDelta::set_delta);
+	ClassDB::bind_method(D_METHOD("get_delta"), &TichDelta::get_delta);
+
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "base_path", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE), "set_base_path", "get_base_path");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "depth", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE), "set_depth", "get_depth");
+	ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "_delta", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE), "set_delta", "get_delta");
+}
@@ -0,0 +1,33 @@
+#ifndef TICH_DELTA_H
+#define TICH_DELTA_H
+
+#include "core/resource.h"
+
+// A snapshot that only stores what changed since the snapshot at base_path.
+// Loading walks the chain of bases back to a full PackedScene and applies
+// the deltas on top of it, see SceneState::apply_delta.
+class TichDelta : public Resource
+{
+	GDCLASS(TichDelta, Resource);
+
+	static void _bind_methods();
+
+private:
+	String basePath;
+	int depth;
+	Dictionary delta;
+
+public:
+	TichDelta();
+
+	void set_base_path(const String &p_path);
+	String get_base_path() const;
+
+	void set_depth(int p_depth);
+	int get_depth() const;
+
+	void set_delta(const Dictionary &p_delta);
+	Dictionary get_delta() const;
+};
+
+#endif
@@ -1,8 +1,11 @@
 #include "TichInfo.h"
 
-bool TichInfo::s_IsSaving = false;
+#include "core/os/thread.h"
+
+std::atomic<bool> TichInfo::s_IsSaving(false);
 bool TichInfo::s_IsLoading = false;
 bool TichInfo::s_IsGA = false;
+std::atomic<uint64_t> TichInfo::s_WriterThread(0);
 
 bool TichInfo::IsSaving()
 {
@@ -18,3 +21,9 @@ bool TichInfo::IsGA()
 {
 	return s_IsGA;
 }
+
+bool TichInfo::IsWritingState()
+{
+	uint64_t writer = s_WriterThread.load();
+	return s_IsSaving || (writer != 0 && Thread::get_caller_id() == writer);
+}
@@ -1,20 +1,30 @@
 #ifndef TICH_INFO_H
 #define TICH_INFO_H
 
+#include <stdint.h>
+
+#include <atomic>
+
 class TichInfo
 {
 	friend class TichSystem;
 	friend class TichProfiler;
+	friend class TichSaveWorker;
 
 public:
 	static bool IsSaving();
 	static bool IsLoading();
 	static bool IsGA();
 
+	// True while a state is being written, either inline by the main thread
+	// or on the save worker thread.
+	static bool IsWritingState();
+
 private:
-	static bool s_IsSaving;
+	static std::atomic<bool> s_IsSaving; // read by the save worker through IsWritingState()
 	static bool s_IsLoading;
 	static bool s_IsGA;
+	static std::atomic<uint64_t> s_WriterThread; // read by every thread writing a state
 };
 
 #endif
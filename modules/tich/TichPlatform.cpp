@@ -0,0 +1,149 @@
+#include "TichPlatform.h"
+
+#if defined(_WIN32)
+
+#include <windows.h>
+#include <psapi.h>
+
+static uint64_t FileTimeToUsec(const FILETIME &time)
+{
+	ULARGE_INTEGER value;
+	value.LowPart = time.dwLowDateTime;
+	value.HighPart = time.dwHighDateTime;
+
+	// FILETIME counts 100 ns intervals
+	return value.QuadPart / 10;
+}
+
+uint64_t TichPlatform::GetProcessCPUTime()
+{
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	return FileTimeToUsec(kernel) + FileTimeToUsec(user);
+}
+
+uint64_t TichPlatform::GetThreadCPUTime()
+{
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	return FileTimeToUsec(kernel) + FileTimeToUsec(user);
+}
+
+uint64_t TichPlatform::GetResidentMemory()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+
+	return counters.WorkingSetSize;
+}
+
+#elif defined(__linux__)
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum
+{
+	// fields of /proc/self/stat counted from the state field, see proc(5)
+	STAT_UTIME = 11,
+	STAT_STIME = 12,
+	STAT_RSS = 21,
+};
+
+static bool ReadProcStat(uint64_t *r_fields, int count)
+{
+	char buffer[1024];
+
+	int fd = open("/proc/self/stat", O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+	close(fd);
+
+	if (length <= 0)
+		return false;
+	buffer[length] = 0;
+
+	// the command name may contain spaces, the fields start after its last ')'
+	const char *c = strrchr(buffer, ')');
+	if (!c)
+		return false;
+	c += 2;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!*c)
+			return false;
+
+		char *end;
+		r_fields[i] = strtoull(c, &end, 10);
+
+		// the state field is a letter, not a number
+		while (*end && *end != ' ')
+			end++;
+		c = *end ? end + 1 : end;
+	}
+
+	return true;
+}
+
+uint64_t TichPlatform::GetProcessCPUTime()
+{
+	uint64_t fields[STAT_STIME + 1];
+	if (!ReadProcStat(fields, STAT_STIME + 1))
+		return 0;
+
+	static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+	if (ticksPerSecond <= 0)
+		return 0;
+
+	return (fields[STAT_UTIME] + fields[STAT_STIME]) * 1000000 / ticksPerSecond;
+}
+
+uint64_t TichPlatform::GetThreadCPUTime()
+{
+	struct timespec time;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+		return 0;
+
+	return (uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+uint64_t TichPlatform::GetResidentMemory()
+{
+	uint64_t fields[STAT_RSS + 1];
+	if (!ReadProcStat(fields, STAT_RSS + 1))
+		return 0;
+
+	static const long pageSize = sysconf(_SC_PAGESIZE);
+
+	return fields[STAT_RSS] * pageSize;
+}
+
+#else
+
+uint64_t TichPlatform::GetProcessCPUTime()
+{
+	return 0;
+}
+
+uint64_t TichPlatform::GetThreadCPUTime()
+{
+	return 0;
+}
+
+uint64_t TichPlatform::GetResidentMemory()
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef TICH_PLATFORM_H
+#define TICH_PLATFORM_H
+
+#include <stdint.h>
+
+// Process and thread resource sampling used by the profilers. Times are in
+// microseconds, memory in bytes. Platforms without a backend report 0.
+class TichPlatform
+{
+public:
+	static uint64_t GetProcessCPUTime();
+	static uint64_t GetThreadCPUTime();
+	static uint64_t GetResidentMemory();
+};
+
+#endif
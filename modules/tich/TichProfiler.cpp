@@ -7,10 +7,13 @@
 
 #include "resource_format_memory.h"
 #include "core/io/resource_format_binary.h"
-#include "core/io/file_access_memory.h"
 
-#include <thread>
-#include <windows.h>
+#include "TichPlatform.h"
+#include "TichStateStore.h"
+#include "FunctionProfiler.h"
+
+#include "core/sort_array.h"
+#include "scene/main/scene_tree.h"
 
 TichProfiler *TichProfiler::singleton = NULL;
 
@@ -19,11 +22,19 @@ TichProfiler::TichProfiler() :
 	timeStamp(0),
 	sample(0),
 	executionInterval(0),
-	save(false)
+	save(false),
+	cpuTimeLast(0),
+	threadCPUTimeLast(0),
+	benchmarkPending(false),
+	benchmarkRunning(false),
+	benchmarkSamples(0),
+	benchmarkInterval(0),
+	benchmarkSave(false),
+	benchmarkGA(false)
 {
 	singleton = this;
 
-	InitCPUCounter();
+	processorCount = MAX(OS::get_singleton()->get_processor_count(), 1);
 }
 
 TichProfiler::~TichProfiler()
@@ -31,54 +42,27 @@ TichProfiler::~TichProfiler()
 
 }
 
-void TichProfiler::InitCPUCounter()
-{
-	OS *os = OS::get_singleton();
-
-	handle = GetCurrentProcess();
-
-	SYSTEM_INFO sysinfo;
-	GetSystemInfo(&sysinfo);
-	int numProcessors = sysinfo.dwNumberOfProcessors / 2;
-
-	int cpuInfo[4] = { 0, 0, 0, 0 };
-	__cpuid(cpuInfo, 0);
-	if (cpuInfo[0] >= 0x16)
-	{
-		__cpuid(cpuInfo, 0x16);
-
-		os->print("EAX: 0x%08x EBX: 0x%08x ECX: %08x\r\n", cpuInfo[0], cpuInfo[1], cpuInfo[2]);
-		os->print("Processor Base Frequency:  %04d MHz\r\n", cpuInfo[0]);
-		os->print("Maximum Frequency:         %04d MHz\r\n", cpuInfo[1]);
-		os->print("Bus (Reference) Frequency: %04d MHz\r\n", cpuInfo[2]);
-		os->print("Cores %d\r\n", numProcessors);
-
-		cpuFrequency = cpuInfo[1];
-		cpuFrequency *= numProcessors;
-		cpuFrequency *= 1000000;
-	}
-	else
-	{
-		os->print("CPUID level 16h unsupported\r\n");
-	}
-}
-
+// Process CPU time spent since the last call, relative to the time all
+// processors had available in that interval.
 double TichProfiler::getCPUUsage(uint64_t deltaTime)
 {
-	uint64_t cycles;
-	QueryProcessCycleTime(handle, &cycles);
-	uint64_t deltaCycles = cycles - cyclesLast;
-	cyclesLast = cycles;
+	uint64_t cpuTime = TichPlatform::GetProcessCPUTime();
+	uint64_t deltaCPUTime = cpuTime - cpuTimeLast;
+	cpuTimeLast = cpuTime;
+
+	if (deltaTime == 0)
+		return 0;
 
-	double deltaSeconds = deltaTime / (double)1000000;
-	double cyclesPerSecond = deltaCycles / deltaSeconds;
-	double percentage = cyclesPerSecond / (double)cpuFrequency;
+	double percentage = deltaCPUTime / ((double)deltaTime * processorCount);
 
 	return percentage * 100;
 }
 
 void TichProfiler::Update(uint64_t frameTime)
 {
+	if (benchmarkPending && SceneTree::get_singleton()->get_current_scene())
+		StartBenchmark();
+
 	if (sample)
 	{
 		ProfilerData data;
@@ -87,6 +71,13 @@ void TichProfiler::Update(uint64_t frameTime)
 
 		data.cpu = getCPUUsage(frameTime);
 
+		uint64_t threadCPUTime = TichPlatform::GetThreadCPUTime();
+		data.mainThreadCPU = threadCPUTime - threadCPUTimeLast;
+		threadCPUTimeLast = threadCPUTime;
+
+		TichStateStore *store = TichStateStore::get_singleton();
+		data.stateMemory = 0;
+
 		if ((sample % executionInterval) == 0)
 		{
 			OS *os = OS::get_singleton();
@@ -94,10 +85,14 @@ void TichProfiler::Update(uint64_t frameTime)
 
 			if (TichInfo::IsGA())
 			{
+				String path = "res://state_" + itos(exectionCounter) + saveFileExtention;
 				if (save)
-					TichSystem::GetInstance()->Save("res://state_" + itos(exectionCounter) + saveFileExtention);
+					TichSystem::GetInstance()->Save(path);
 				else
-					TichSystem::GetInstance()->Load("res://state_" + itos(exectionCounter) + saveFileExtention);
+					TichSystem::GetInstance()->Load(path);
+
+				// 0 while a background save has not committed the state yet
+				data.stateMemory = store ? store->GetSlotMemory(path) : 0;
 			}
 			else
 			{
@@ -113,7 +108,6 @@ void TichProfiler::Update(uint64_t frameTime)
 
 			data.executionTime = os->get_ticks_usec() - time;
 			exectionCounter++;
-			timelineSize += ResourceFormatSaver::get_state_size();
 		}
 		else
 		{
@@ -124,7 +118,9 @@ void TichProfiler::Update(uint64_t frameTime)
 		data.nodes		= perf->get_monitor(Performance::Monitor::OBJECT_NODE_COUNT);
 		data.objects	= perf->get_monitor(Performance::Monitor::OBJECT_COUNT);
 		data.stateSize	= ResourceFormatSaver::get_state_size();
-		data.memory		= Memory::get_mem_usage() - dataFileSize + timelineSize;
+		data.memory		= Memory::get_mem_usage();
+		data.storeMemory = store ? store->GetMemoryUsage() : 0;
+		data.residentMemory = TichPlatform::GetResidentMemory();
 
 		profilingData.set(index++, data);
 
@@ -132,46 +128,136 @@ void TichProfiler::Update(uint64_t frameTime)
 
 		if (sample == 0)
 		{
-			Error err;
-			FileAccess *file = FileAccess::open(dataPath, FileAccess::WRITE, &err);
+			WriteResults();
+			WriteSummary();
 
-			String headers = "Frame Time(us);Execution Time(us);CPU(%);Memory(bytes);State Size(bytes);Nodes;Objects;Execution Time(us)\n";
+			if (FunctionProfiler::get_singleton())
+				FunctionProfiler::get_singleton()->SaveToFile(dataPath.get_basename() + "_trace.json");
 
-			file->store_string(headers);
+			OS *os = OS::get_singleton();
+			os->print("Profiling finished in %f s\n", (os->get_ticks_usec() - timeStamp) / 1000.0F / 1000.0F);
 
-			int executionStack = 0;
-			String content;
-			for (int i = 0; i < profilingData.size(); i++)
+			if (benchmarkRunning)
 			{
-				const ProfilerData &data = profilingData[i];
+				benchmarkRunning = false;
+				SceneTree::get_singleton()->quit(0);
+			}
+		}
+	}
+}
+
+void TichProfiler::WriteResults()
+{
+	Error err;
+	FileAccess *file = FileAccess::open(dataPath, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_MSG(err != OK, "Cannot write profiling data to '" + dataPath + "'.");
+
+	String headers = "Frame Time(us);Execution Time(us);CPU(%);Memory(bytes);State Size(bytes);Nodes;Objects;Execution Time(us);Main Thread CPU(us);RSS(bytes);Store Memory(bytes);State Memory(bytes)\n";
+
+	file->store_string(headers);
+
+	int executionStack = 0;
+	String content;
+	for (int i = 0; i < profilingData.size(); i++)
+	{
+		const ProfilerData &data = profilingData[i];
 
-				int exeutionTime = executionStack > i ? 0 : data.executionTime;
-				if (exeutionTime == 0)
+		int exeutionTime = executionStack > i ? 0 : data.executionTime;
+		if (exeutionTime == 0)
+		{
+			for (int j = executionStack; j < profilingData.size(); j++)
+			{
+				if (profilingData[j].executionTime != 0)
 				{
-					for (int j = executionStack; j < profilingData.size(); j++)
-					{
-						if (profilingData[j].executionTime != 0)
-						{
-							exeutionTime = profilingData[j].executionTime;
-							executionStack = j;
-							break;
-						}
-					}
+					exeutionTime = profilingData[j].executionTime;
+					executionStack = j;
+					break;
 				}
-				executionStack++;
-
-				content += itos(data.frameTime) + ";" + itos(data.executionTime) + ";" + rtos(data.cpu) + ";" + itos(data.memory) + ";" + itos(data.stateSize) + ";" + itos(data.nodes) + ";" + itos(data.objects) + ";" + (exeutionTime ? itos(exeutionTime) : "") + "\n";
 			}
+		}
+		executionStack++;
+
+		content += itos(data.frameTime) + ";" + itos(data.executionTime) + ";" + rtos(data.cpu) + ";" + itos(data.memory) + ";" + itos(data.stateSize) + ";" + itos(data.nodes) + ";" + itos(data.objects) + ";" + (exeutionTime ? itos(exeutionTime) : "") + ";" + itos(data.mainThreadCPU) + ";" + itos(data.residentMemory) + ";" + itos(data.storeMemory) + ";" + (data.stateMemory ? itos(data.stateMemory) : "") + "\n";
+	}
 
-			file->store_string(content);
+	file->store_string(content);
 
-			file->close();
-			memdelete(file);
+	file->close();
+	memdelete(file);
+}
 
-			OS *os = OS::get_singleton();
-			os->print("Profiling finished in %f s\n", (os->get_ticks_usec() - timeStamp) / 1000.0F / 1000.0F);
+// Nearest rank percentile of sorted values.
+static uint64_t Percentile(const Vector<uint64_t> &values, int percent)
+{
+	if (values.empty())
+		return 0;
+
+	int rank = (values.size() * percent + 99) / 100;
+	return values[CLAMP(rank - 1, 0, values.size() - 1)];
+}
+
+// Writes p50/p95/p99 of the execution time, state size and frame time next to
+// the profiling data and prints them, so runs can be compared without
+// post-processing the full CSV.
+void TichProfiler::WriteSummary()
+{
+	Vector<uint64_t> executionTimes;
+	Vector<uint64_t> stateSizes;
+	Vector<uint64_t> frameTimes;
+
+	for (int i = 0; i < profilingData.size(); i++)
+	{
+		const ProfilerData &data = profilingData[i];
+
+		frameTimes.push_back(data.frameTime);
+
+		if (data.executionTime != 0)
+		{
+			executionTimes.push_back(data.executionTime);
+			stateSizes.push_back(data.stateSize);
 		}
 	}
+
+	executionTimes.sort();
+	stateSizes.sort();
+	frameTimes.sort();
+
+	struct Metric
+	{
+		const char *name;
+		const Vector<uint64_t> *values;
+	};
+
+	const Metric metrics[] = {
+		{ save ? "Save Time(us)" : "Load Time(us)", &executionTimes },
+		{ "State Size(bytes)", &stateSizes },
+		{ "Frame Time(us)", &frameTimes },
+	};
+
+	OS *os = OS::get_singleton();
+	String content = "Metric;Samples;p50;p95;p99\n";
+
+	for (int i = 0; i < 3; i++)
+	{
+		const Vector<uint64_t> &values = *metrics[i].values;
+
+		uint64_t p50 = Percentile(values, 50);
+		uint64_t p95 = Percentile(values, 95);
+		uint64_t p99 = Percentile(values, 99);
+
+		os->print("%s: p50 %llu, p95 %llu, p99 %llu (%d samples)\n", metrics[i].name, p50, p95, p99, values.size());
+		content += String(metrics[i].name) + ";" + itos(values.size()) + ";" + itos(p50) + ";" + itos(p95) + ";" + itos(p99) + "\n";
+	}
+
+	String summaryPath = dataPath.get_basename() + "_summary.csv";
+
+	Error err;
+	FileAccess *file = FileAccess::open(summaryPath, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_MSG(err != OK, "Cannot write profiling summary to '" + summaryPath + "'.");
+
+	file->store_string(content);
+	file->close();
+	memdelete(file);
 }
 
 void TichProfiler::Start(const String &saveFileExtention, uint64_t samples, uint16_t executionInterval, uint16_t complexityLevel, bool save, bool gaImplementation) {
@@ -180,16 +266,13 @@ void TichProfiler::Start(const String &saveFileExtention, uint64_t samples, uint
 	this->save = save;
 	TichInfo::s_IsGA = gaImplementation;
 	this->executionInterval = executionInterval;
-	uint16_t compl = complexityLevel;
 	this->dataPath = "data/" + String(gaImplementation ? "ga" : "gs") + "_" + String(save ? "save" : "load") + "_" + itos(complexityLevel) + ".csv";
 
 	index = 0;
 	exectionCounter = 0;
-	timelineSize = 0;
 
-	FileAccessMemory *f = memnew(FileAccessMemory);
-	f->_open("data", FileAccess::READ);
-	dataFileSize = f->get_len();
+	if (gaImplementation && executionInterval)
+		ReserveTimeline(samples / executionInterval + 1);
 
 	_Directory dir;
 	dir.make_dir("data");
@@ -197,6 +280,7 @@ void TichProfiler::Start(const String &saveFileExtention, uint64_t samples, uint
 	profilingData.resize(samples);
 
 	getCPUUsage(0);
+	threadCPUTimeLast = TichPlatform::GetThreadCPUTime();
 
 	OS *os = OS::get_singleton();
 	timeStamp = os->get_ticks_usec();
@@ -204,8 +288,52 @@ void TichProfiler::Start(const String &saveFileExtention, uint64_t samples, uint
 		samples,
 		executionInterval,
 		(gaImplementation ? "GA" : "GS"),
-		(save ? "Save" : "Load")),
-		compl ;
+		(save ? "Save" : "Load"),
+		complexityLevel);
+}
+
+// Arms a headless benchmark run. It starts once the scene is current and quits
+// the tree when all samples are written. `mode` is one of ga-save, ga-load,
+// gs-save or gs-load.
+bool TichProfiler::SetupBenchmark(const String &scenePath, const String &mode, uint64_t samples, uint16_t executionInterval)
+{
+	ERR_FAIL_COND_V_MSG(samples == 0, false, "Benchmark needs at least one sample.");
+	ERR_FAIL_COND_V_MSG(executionInterval == 0, false, "Benchmark execution interval must be positive.");
+
+	if (mode == "ga-save" || mode == "ga-load" || mode == "gs-save" || mode == "gs-load")
+	{
+		benchmarkGA = mode.begins_with("ga");
+		benchmarkSave = mode.ends_with("save");
+	}
+	else
+	{
+		ERR_FAIL_V_MSG(false, "Unknown benchmark mode '" + mode + "', expected ga-save, ga-load, gs-save or gs-load.");
+	}
+
+	benchmarkName = scenePath.get_file().get_basename() + "_" + mode;
+	benchmarkSamples = samples;
+	benchmarkInterval = executionInterval;
+	benchmarkPending = true;
+
+	return true;
+}
+
+void TichProfiler::StartBenchmark()
+{
+	benchmarkPending = false;
+	benchmarkRunning = true;
+
+	if (benchmarkGA && !benchmarkSave)
+	{
+		// a fresh process has no states yet, save the ones the run will load
+		uint64_t executions = benchmarkSamples / benchmarkInterval;
+		ReserveTimeline(executions + 1);
+		for (uint64_t i = 0; i < executions; i++)
+			TichSystem::GetInstance()->Save("res://state_" + itos(i) + ".tich");
+	}
+
+	Start(".tich", benchmarkSamples, benchmarkInterval, 0, benchmarkSave, benchmarkGA);
+	dataPath = "data/" + benchmarkName + ".csv";
 }
 
 void TichProfiler::StartGs(const String& saveFileExtention, uint64_t samples, uint16_t executionInterval, bool save)
@@ -213,11 +341,48 @@ void TichProfiler::StartGs(const String& saveFileExtention, uint64_t samples, ui
 	Start(saveFileExtention, samples, executionInterval, 1, save, false);
 }
 
+// Every state a GA run writes or reads has to stay in the store until it ends.
+void TichProfiler::ReserveTimeline(uint64_t states)
+{
+	TichStateStore *store = TichStateStore::get_singleton();
+	if (store && store->GetTimelineCapacity() && (uint64_t)store->GetTimelineCapacity() < states)
+		store->SetTimelineCapacity(MIN(states, (uint64_t)INT32_MAX));
+}
+
+// Loads the state saved `steps` saves ago, see TichSystem::Rewind.
+bool TichProfiler::Rewind(int steps)
+{
+	return TichSystem::GetInstance()->Rewind(steps);
+}
+
+void TichProfiler::SetTimelineCapacity(int capacity)
+{
+	ERR_FAIL_COND(!TichStateStore::get_singleton());
+	TichStateStore::get_singleton()->SetTimelineCapacity(capacity);
+}
+
+int TichProfiler::GetTimelineCapacity() const
+{
+	ERR_FAIL_COND_V(!TichStateStore::get_singleton(), 0);
+	return TichStateStore::get_singleton()->GetTimelineCapacity();
+}
+
+uint64_t TichProfiler::GetStoreMemory() const
+{
+	ERR_FAIL_COND_V(!TichStateStore::get_singleton(), 0);
+	return TichStateStore::get_singleton()->GetMemoryUsage();
+}
+
 void TichProfiler::_bind_methods()
 {
 	ClassDB::bind_method(D_METHOD("Start", "samples", "executionInterval", "save"), &TichProfiler::StartGs);
+	ClassDB::bind_method(D_METHOD("Rewind", "steps"), &TichProfiler::Rewind);
+	ClassDB::bind_method(D_METHOD("SetTimelineCapacity", "capacity"), &TichProfiler::SetTimelineCapacity);
+	ClassDB::bind_method(D_METHOD("GetTimelineCapacity"), &TichProfiler::GetTimelineCapacity);
+	ClassDB::bind_method(D_METHOD("GetStoreMemory"), &TichProfiler::GetStoreMemory);
 
 	ADD_SIGNAL(MethodInfo("_save"));
 	ADD_SIGNAL(MethodInfo("_load"));
 	ADD_SIGNAL(MethodInfo("_change_level"));
+	ADD_SIGNAL(MethodInfo("_save_completed", PropertyInfo(Variant::STRING, "path"), PropertyInfo(Variant::BOOL, "success"), PropertyInfo(Variant::INT, "state_size"), PropertyInfo(Variant::INT, "write_time")));
 }
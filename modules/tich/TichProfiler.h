@@ -2,7 +2,7 @@
 #define TICHPROFILER_H
 
 #include "core/os/os.h"
-#include "main/Performance.h"
+#include "main/performance.h"
 
 class TichProfiler : public Reference
 {
@@ -11,8 +11,6 @@ class TichProfiler : public Reference
 	static TichProfiler *singleton;
 	static void _bind_methods();
 
-	void InitCPUCounter();
-
 private:
 
 	struct ProfilerData {
@@ -20,13 +18,25 @@ private:
 		uint64_t frameTime;
 		uint64_t executionTime;
 		double	 cpu;
+		uint64_t mainThreadCPU;
+		uint64_t residentMemory;
 		uint64_t nodes;
 		uint64_t objects;
 		uint64_t memory;
 		uint64_t stateSize;
+		uint64_t storeMemory;
+		uint64_t stateMemory;
 	};
 
 	void StartGs(const String &saveFileExtention, uint64_t samples, uint16_t executionInterval, bool save);
+	bool Rewind(int steps);
+	void SetTimelineCapacity(int capacity);
+	int GetTimelineCapacity() const;
+	uint64_t GetStoreMemory() const;
+	void StartBenchmark();
+	void WriteResults();
+	void WriteSummary();
+	void ReserveTimeline(uint64_t states);
 
 private:
 	Vector<ProfilerData> profilingData;
@@ -38,11 +48,17 @@ private:
 	bool save;
 	uint64_t index;
 	uint64_t exectionCounter;
-	uint64_t dataFileSize;
-	uint64_t timelineSize;
-	void* handle;
-	uint64_t cyclesLast;
-	uint64_t cpuFrequency;
+	uint64_t cpuTimeLast;
+	uint64_t threadCPUTimeLast;
+	int processorCount;
+
+	bool benchmarkPending;
+	bool benchmarkRunning;
+	String benchmarkName;
+	uint64_t benchmarkSamples;
+	uint16_t benchmarkInterval;
+	bool benchmarkSave;
+	bool benchmarkGA;
 
 public:
 	TichProfiler();
@@ -54,6 +70,9 @@ public:
 
 	double getCPUUsage(uint64_t deltaTime);
 
+	bool SetupBenchmark(const String &scenePath, const String &mode, uint64_t samples, uint16_t executionInterval);
+	bool IsBenchmarking() const { return benchmarkPending || benchmarkRunning; }
+
 	static TichProfiler *get_singleton() { return singleton; }
 };
 #endif // !TICHPROFILER_H
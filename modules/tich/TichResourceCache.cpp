@@ -0,0 +1,259 @@
+#include "TichResourceCache.h"
+
+#include "core/hashfuncs.h"
+#include "core/os/thread.h"
+
+TichResourceCache *TichResourceCache::singleton = NULL;
+
+TichResourceCache::TichResourceCache() :
+	enabled(true)
+{
+	singleton = this;
+	mutex = Mutex::create();
+}
+
+TichResourceCache::~TichResourceCache()
+{
+	Clear();
+	memdelete(mutex);
+
+	if (singleton == this)
+		singleton = NULL;
+}
+
+bool TichResourceCache::HashVariant(const Variant &value, uint64_t &hash)
+{
+	hash = hash_djb2_one_64(value.get_type(), hash);
+
+	switch (value.get_type())
+	{
+		case Variant::OBJECT:
+		{
+			if (value.is_ref())
+			{
+				RES res = value;
+
+				// external resources are identified by their path
+				if (res.is_valid() && res->get_path().length() && res->get_path().find("::") == -1)
+				{
+					hash = hash_djb2_one_64(res->get_path().hash(), hash);
+					return true;
+				}
+			}
+
+			return value.operator Object *() == NULL;
+		}
+		case Variant::ARRAY:
+		{
+			Array arr = value;
+			for (int i = 0; i < arr.size(); i++)
+			{
+				if (!HashVariant(arr[i], hash))
+					return false;
+			}
+			return true;
+		}
+		case Variant::DICTIONARY:
+		{
+			Dictionary dic = value;
+			for (int i = 0; i < dic.size(); i++)
+			{
+				if (!HashVariant(dic.get_key_at_index(i), hash) || !HashVariant(dic.get_value_at_index(i), hash))
+					return false;
+			}
+			return true;
+		}
+		case Variant::TICH_REF:
+			return false;
+		default:
+			hash = hash_djb2_one_64(value.hash(), hash);
+			return true;
+	}
+}
+
+bool TichResourceCache::IsVariantEqual(const Variant &a, const Variant &b)
+{
+	if (a.get_type() != b.get_type())
+		return false;
+
+	switch (a.get_type())
+	{
+		case Variant::ARRAY:
+		{
+			Array arrA = a;
+			Array arrB = b;
+			if (arrA.size() != arrB.size())
+				return false;
+
+			for (int i = 0; i < arrA.size(); i++)
+			{
+				if (!IsVariantEqual(arrA[i], arrB[i]))
+					return false;
+			}
+			return true;
+		}
+		case Variant::DICTIONARY:
+		{
+			Dictionary dicA = a;
+			Dictionary dicB = b;
+			if (dicA.size() != dicB.size())
+				return false;
+
+			for (int i = 0; i < dicA.size(); i++)
+			{
+				const Variant *value = dicB.getptr(dicA.get_key_at_index(i));
+				if (!value || !IsVariantEqual(dicA.get_value_at_index(i), *value))
+					return false;
+			}
+			return true;
+		}
+		default:
+			return a == b;
+	}
+}
+
+bool TichResourceCache::IsContentEqual(const RES &a, const RES &b)
+{
+	if (a->get_class_name() != b->get_class_name())
+		return false;
+
+	List<PropertyInfo> properties;
+	a->get_property_list(&properties);
+
+	for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next())
+	{
+		if (!(E->get().usage & PROPERTY_USAGE_STORAGE))
+			continue;
+
+		if (!IsVariantEqual(a->get(E->get().name), b->get(E->get().name)))
+			return false;
+	}
+
+	return true;
+}
+
+bool TichResourceCache::GetContentHash(const RES &resource, uint64_t &hash)
+{
+	ERR_FAIL_COND_V(resource.is_null(), false);
+
+	hash = hash_djb2_one_64(String(resource->get_class_name()).hash());
+
+	List<PropertyInfo> properties;
+	resource->get_property_list(&properties);
+
+	for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next())
+	{
+		const PropertyInfo &property = E->get();
+		if (!(property.usage & PROPERTY_USAGE_STORAGE))
+			continue;
+
+		// generated on the fly, saving them needs their owner
+		if (property.usage & PROPERTY_USAGE_RESOURCE_NOT_PERSISTENT)
+			return false;
+
+		hash = hash_djb2_one_64(property.name.hash(), hash);
+		if (!HashVariant(resource->get(property.name), hash))
+			return false;
+	}
+
+	return true;
+}
+
+bool TichResourceCache::Store(const RES &resource, uint64_t &hash)
+{
+	if (!enabled || !GetContentHash(resource, hash))
+		return false;
+
+	bool mainThread = Thread::get_caller_id() == Thread::get_main_id();
+
+	MutexLock lock(mutex);
+
+	if (mainThread)
+		released.clear();
+
+	Entry *entry = entries.getptr(hash);
+	if (entry)
+	{
+		// a hash collision is saved as usual
+		if (!IsContentEqual(entry->pristine, resource))
+			return false;
+
+		entry->references++;
+		return true;
+	}
+
+	// resources may create server objects, copies are only made on the main
+	// thread, states written by the save worker only reuse existing entries
+	if (!mainThread)
+		return false;
+
+	Entry newEntry;
+	newEntry.pristine = resource->duplicate();
+	ERR_FAIL_COND_V(newEntry.pristine.is_null(), false);
+	newEntry.references = 1;
+
+	entries.set(hash, newEntry);
+	return true;
+}
+
+void TichResourceCache::Release(const Vector<uint64_t> &hashes)
+{
+	bool mainThread = Thread::get_caller_id() == Thread::get_main_id();
+
+	MutexLock lock(mutex);
+
+	for (int i = 0; i < hashes.size(); i++)
+	{
+		Entry *entry = entries.getptr(hashes[i]);
+		ERR_CONTINUE(!entry);
+
+		if (--entry->references > 0)
+			continue;
+
+		// freeing a resource may touch the servers
+		if (!mainThread)
+			released.push_back(entry->pristine);
+		entries.erase(hashes[i]);
+	}
+
+	if (mainThread)
+		released.clear();
+}
+
+RES TichResourceCache::Get(uint64_t hash, ObjectID identity)
+{
+	MutexLock lock(mutex);
+
+	Entry *entry = entries.getptr(hash);
+	ERR_FAIL_COND_V(!entry, RES());
+
+	RES saved = Object::cast_to<Resource>(ObjectDB::get_instance(identity));
+	if (saved.is_valid() && IsContentEqual(entry->pristine, saved))
+		return saved;
+
+	// freed or modified since, hand out a new copy of the saved content
+	return entry->pristine->duplicate();
+}
+
+void TichResourceCache::Clear()
+{
+	MutexLock lock(mutex);
+	entries.clear();
+	released.clear();
+}
+
+int TichResourceCache::GetCount() const
+{
+	MutexLock lock(mutex);
+	return entries.size();
+}
+
+void TichResourceCache::SetEnabled(bool enable)
+{
+	enabled = enable;
+}
+
+bool TichResourceCache::IsEnabled() const
+{
+	return enabled;
+}
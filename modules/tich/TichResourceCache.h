@@ -0,0 +1,64 @@
+#ifndef TICH_RESOURCE_CACHE_H
+#define TICH_RESOURCE_CACHE_H
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/resource.h"
+
+// Content-addressed home of the built-in sub-resources shared by the save
+// states of the memory format. A state references a cached resource by the
+// hash of its content and the id of the instance that was saved, loading
+// hands out that instance or, if it was modified or freed since, a fresh
+// copy of the content it had. Resources that were separate when saved stay
+// separate, whatever their content.
+//
+// Every state written to the TichStateStore holds a reference to the
+// entries it uses, an entry goes away with the last slot referencing it.
+//
+// Only leaf resources are cached, the ones that reference no other
+// built-in resource: curves, gradients, shapes, most materials.
+class TichResourceCache
+{
+	static TichResourceCache *singleton;
+
+	struct Entry
+	{
+		RES pristine; // private copy of the content, never handed out
+		int references; // states referencing it
+	};
+
+private:
+	Mutex *mutex;
+	HashMap<uint64_t, Entry> entries;
+	List<RES> released; // copies dropped on other threads, freed on the main one
+	bool enabled;
+
+	static bool HashVariant(const Variant &value, uint64_t &hash);
+	static bool IsVariantEqual(const Variant &a, const Variant &b);
+	static bool IsContentEqual(const RES &a, const RES &b);
+
+public:
+	TichResourceCache();
+	~TichResourceCache();
+
+	static bool GetContentHash(const RES &resource, uint64_t &hash);
+
+	// Adds a reference to the content of `resource`, false if it can't be
+	// cached. The state that stores it releases it with Release().
+	bool Store(const RES &resource, uint64_t &hash);
+	void Release(const Vector<uint64_t> &hashes);
+
+	// The instance saved as `identity` while it still has the content of
+	// `hash`, a new copy of that content otherwise.
+	RES Get(uint64_t hash, ObjectID identity);
+
+	void Clear();
+	int GetCount() const;
+
+	void SetEnabled(bool enable);
+	bool IsEnabled() const;
+
+	static TichResourceCache *get_singleton() { return singleton; }
+};
+
+#endif
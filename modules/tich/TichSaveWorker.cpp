@@ -0,0 +1,166 @@
+#include "TichSaveWorker.h"
+
+#include "TichDelta.h"
+#include "TichInfo.h"
+
+#include "core/io/resource_saver.h"
+#include "core/os/os.h"
+
+TichSaveWorker::TichSaveWorker() :
+	thread(NULL),
+	pending(0),
+	waiters(0),
+	exit(false)
+{
+	mutex = Mutex::create();
+	semaphore = Semaphore::create();
+	idle = Semaphore::create();
+}
+
+TichSaveWorker::~TichSaveWorker()
+{
+	Stop();
+	memdelete(mutex);
+	memdelete(semaphore);
+	memdelete(idle);
+}
+
+void TichSaveWorker::_thread_func(void *p_userdata)
+{
+	TichSaveWorker *worker = (TichSaveWorker *)p_userdata;
+	worker->ThreadFunc();
+}
+
+void TichSaveWorker::ThreadFunc()
+{
+	TichInfo::s_WriterThread.store(Thread::get_caller_id());
+
+	while (!exit.load())
+	{
+		semaphore->wait();
+
+		mutex->lock();
+		if (jobs.empty())
+		{
+			mutex->unlock();
+			continue;
+		}
+		Job job = jobs.front()->get();
+		jobs.pop_front();
+		mutex->unlock();
+
+		uint64_t time = OS::get_singleton()->get_ticks_usec();
+
+		Result result;
+		result.path = job.path;
+		result.error = Write(job, result.stateSize);
+		result.writeTime = OS::get_singleton()->get_ticks_usec() - time;
+
+		// drop the references here, the main thread may be waiting on them
+		job.scene.unref();
+		job.deltaBase.unref();
+
+		mutex->lock();
+		results.push_back(result);
+		pending--;
+		for (; pending == 0 && waiters > 0; waiters--)
+			idle->post();
+		mutex->unlock();
+	}
+
+	TichInfo::s_WriterThread.store(0);
+}
+
+Error TichSaveWorker::Write(const Job &job, uint64_t &stateSize)
+{
+	Error err;
+	Ref<PackedScene> scene = job.scene;
+
+	if (job.deltaBase.is_valid())
+	{
+		Ref<TichDelta> delta;
+		delta.instance();
+		delta->set_base_path(job.deltaBasePath);
+		delta->set_depth(job.deltaDepth);
+		delta->set_delta(scene->get_state()->get_delta(job.deltaBase));
+
+		err = ResourceSaver::save(job.path, delta);
+	}
+	else
+	{
+		err = ResourceSaver::save(job.path, scene);
+	}
+
+	stateSize = ResourceFormatSaver::get_state_size();
+	return err;
+}
+
+void TichSaveWorker::Start()
+{
+	ERR_FAIL_COND_MSG(thread, "Save worker already started.");
+
+	exit.store(false);
+	thread = Thread::create(_thread_func, this);
+}
+
+void TichSaveWorker::Stop()
+{
+	if (!thread)
+		return;
+
+	Wait();
+
+	exit.store(true);
+	semaphore->post();
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+	thread = NULL;
+}
+
+bool TichSaveWorker::IsStarted() const
+{
+	return thread != NULL;
+}
+
+void TichSaveWorker::Queue(const Job &job)
+{
+	ERR_FAIL_COND_MSG(!thread, "Save worker not started.");
+
+	mutex->lock();
+	jobs.push_back(job);
+	pending++;
+	mutex->unlock();
+
+	semaphore->post();
+}
+
+bool TichSaveWorker::PopResult(Result &result)
+{
+	MutexLock lock(mutex);
+
+	if (results.empty())
+		return false;
+
+	result = results.front()->get();
+	results.pop_front();
+	return true;
+}
+
+bool TichSaveWorker::IsBusy() const
+{
+	MutexLock lock(mutex);
+	return pending > 0;
+}
+
+void TichSaveWorker::Wait()
+{
+	mutex->lock();
+	while (pending > 0)
+	{
+		waiters++;
+		mutex->unlock();
+		idle->wait();
+		mutex->lock();
+	}
+	mutex->unlock();
+}
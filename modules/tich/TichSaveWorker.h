@@ -0,0 +1,71 @@
+#ifndef TICH_SAVE_WORKER_H
+#define TICH_SAVE_WORKER_H
+
+#include "core/list.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "scene/resources/packed_scene.h"
+
+#include <atomic>
+
+// Encodes and writes captured states on a background thread, so the frame
+// only pays for packing the tree. Jobs are written in the order they were
+// queued; results are collected by the main thread with PopResult.
+class TichSaveWorker
+{
+public:
+	struct Job
+	{
+		String path;
+		Ref<PackedScene> scene;
+
+		// when valid, a TichDelta against this state is written instead
+		Ref<SceneState> deltaBase;
+		String deltaBasePath;
+		int deltaDepth;
+
+		Job() :
+			deltaDepth(0) {}
+	};
+
+	struct Result
+	{
+		String path;
+		Error error;
+		uint64_t stateSize;
+		uint64_t writeTime;
+	};
+
+private:
+	Thread *thread;
+	Mutex *mutex;
+	Semaphore *semaphore;
+	Semaphore *idle; // posted once for every waiter when the last job is written
+
+	List<Job> jobs;
+	List<Result> results;
+	int pending;
+	int waiters;
+	std::atomic<bool> exit;
+
+	static void _thread_func(void *p_userdata);
+	void ThreadFunc();
+
+public:
+	TichSaveWorker();
+	~TichSaveWorker();
+
+	void Start();
+	void Stop();
+	bool IsStarted() const;
+
+	void Queue(const Job &job);
+	bool PopResult(Result &result);
+	bool IsBusy() const;
+	void Wait();
+
+	static Error Write(const Job &job, uint64_t &stateSize);
+};
+
+#endif
@@ -0,0 +1,511 @@
+#include "TichStateStore.h"
+
+#include "core/io/compression.h"
+#include "core/os/copymem.h"
+#include "core/project_settings.h"
+
+#include "TichResourceCache.h"
+
+TichStateStore *TichStateStore::singleton = NULL;
+
+TichStateStore::TichStateStore() :
+	memoryUsage(0),
+	timelineCapacity(0),
+	compression(false),
+	currentDictionary(0),
+	lastDictionary(0),
+	dictionaryAge(0)
+{
+	singleton = this;
+	mutex = Mutex::create();
+}
+
+TichStateStore::~TichStateStore()
+{
+	Clear();
+	memdelete(mutex);
+
+	if (singleton == this)
+		singleton = NULL;
+}
+
+String TichStateStore::GetKey(const String &path)
+{
+	if (ProjectSettings::get_singleton())
+		return ProjectSettings::get_singleton()->localize_path(path);
+
+	return path;
+}
+
+bool TichStateStore::HasSlot(const String &path) const
+{
+	MutexLock lock(mutex);
+	return slots.has(GetKey(path));
+}
+
+bool TichStateStore::GetSlot(const String &path, Vector<uint8_t> &data, uint64_t &length) const
+{
+	Vector<uint8_t> frame;
+	Vector<uint8_t> dictionary;
+	{
+		MutexLock lock(mutex);
+
+		const Map<String, Slot>::Element *E = slots.find(GetKey(path));
+		if (!E)
+			return false;
+
+		const Slot &slot = E->get();
+		length = slot.length;
+
+		if (!slot.compressed)
+		{
+			data = slot.data;
+			return true;
+		}
+
+		// both are referenced by the slot, decompression can run unlocked
+		frame = slot.data;
+		if (slot.dictionary)
+			dictionary = dictionaries[slot.dictionary].data;
+	}
+
+	data.resize(length);
+	int size = Compression::decompress_zstd_dictionary(data.ptrw(), length, frame.ptr(), frame.size(), dictionary.ptr(), dictionary.size());
+	ERR_FAIL_COND_V_MSG(size != (int)length, false, "Corrupt compressed state '" + path + "'.");
+
+	return true;
+}
+
+void TichStateStore::Commit(const String &path, const Vector<uint8_t> &data, uint64_t length, const Vector<uint64_t> &resources)
+{
+	Slot slot;
+	slot.data = data;
+	slot.length = length;
+	slot.compressed = false;
+	slot.dictionary = 0;
+	slot.resources = resources;
+
+	bool compress;
+	Vector<uint8_t> dictionary;
+	{
+		MutexLock lock(mutex);
+		compress = compression && length >= COMPRESSION_MIN_SIZE && length <= INT32_MAX;
+		if (compress)
+			slot.dictionary = AcquireDictionary(dictionary);
+	}
+
+	if (compress)
+	{
+		// compressed straight from the writer's buffer into the slot
+		Vector<uint8_t> frame;
+		frame.resize(Compression::get_max_compressed_buffer_size(length, Compression::MODE_ZSTD));
+		int size = Compression::compress_zstd_dictionary(frame.ptrw(), frame.size(), data.ptr(), length, dictionary.ptr(), dictionary.size(), COMPRESSION_LEVEL);
+
+		if (size >= 0 && (uint64_t)size < length)
+		{
+			frame.resize(size);
+			slot.data = frame;
+			slot.compressed = true;
+		}
+	}
+
+	MutexLock lock(mutex);
+
+	if (!slot.compressed && slot.dictionary)
+	{
+		ReleaseDictionary(slot.dictionary);
+		slot.dictionary = 0;
+	}
+
+	// the writer's buffer grows geometrically, the slot only keeps the state
+	if (!slot.compressed && (uint64_t)slot.data.size() != length)
+		slot.data.resize(length);
+
+	String key = GetKey(path);
+
+	Map<String, Slot>::Element *E = slots.find(key);
+	if (E)
+	{
+		memoryUsage -= E->get().data.size();
+		ReleaseDictionary(E->get().dictionary);
+		ReleaseResources(E->get().resources);
+		E->get() = slot;
+	}
+	else
+	{
+		E = slots.insert(key, slot);
+	}
+
+	memoryUsage += slot.data.size();
+	PushTimeline(key);
+
+	if (compress)
+		RenewDictionary(data, length);
+}
+
+void TichStateStore::Erase(const String &path)
+{
+	MutexLock lock(mutex);
+
+	String key = GetKey(path);
+	Release(key);
+	timeline.erase(key);
+}
+
+void TichStateStore::Clear()
+{
+	MutexLock lock(mutex);
+
+	for (Map<String, Slot>::Element *E = slots.front(); E; E = E->next())
+		ReleaseResources(E->get().resources);
+
+	slots.clear();
+	memoryUsage = 0;
+	timeline.clear();
+
+	dictionaries.clear();
+	currentDictionary = 0;
+	dictionaryAge = 0;
+}
+
+void TichStateStore::Release(const String &key)
+{
+	Map<String, Slot>::Element *E = slots.find(key);
+	if (!E)
+		return;
+
+	memoryUsage -= E->get().data.size();
+	ReleaseDictionary(E->get().dictionary);
+	ReleaseResources(E->get().resources);
+	slots.erase(E);
+}
+
+void TichStateStore::ReleaseResources(const Vector<uint64_t> &resources)
+{
+	if (resources.size() && TichResourceCache::get_singleton())
+		TichResourceCache::get_singleton()->Release(resources);
+}
+
+uint32_t TichStateStore::AcquireDictionary(Vector<uint8_t> &data)
+{
+	if (!currentDictionary)
+		return 0;
+
+	StateDictionary &dictionary = dictionaries[currentDictionary];
+	dictionary.references++;
+	data = dictionary.data;
+	return currentDictionary;
+}
+
+void TichStateStore::ReleaseDictionary(uint32_t id)
+{
+	if (!id)
+		return;
+
+	Map<uint32_t, StateDictionary>::Element *E = dictionaries.find(id);
+	ERR_FAIL_COND(!E);
+
+	E->get().references--;
+	if (E->get().references > 0 || id == currentDictionary)
+		return;
+
+	memoryUsage -= E->get().data.size();
+	dictionaries.erase(E);
+}
+
+void TichStateStore::RenewDictionary(const Vector<uint8_t> &data, uint64_t length)
+{
+	if (currentDictionary && ++dictionaryAge < DICTIONARY_INTERVAL)
+		return;
+
+	// the head of a state holds its string table and the first nodes
+	StateDictionary dictionary;
+	dictionary.data.resize(MIN(length, (uint64_t)DICTIONARY_SIZE));
+	copymem(dictionary.data.ptrw(), data.ptr(), dictionary.data.size());
+	dictionary.references = 0;
+
+	uint32_t previous = currentDictionary;
+
+	currentDictionary = ++lastDictionary;
+	dictionaries.insert(currentDictionary, dictionary);
+	memoryUsage += dictionary.data.size();
+	dictionaryAge = 0;
+
+	// drop the previous one right away if no slot ended up using it
+	if (previous)
+	{
+		dictionaries[previous].references++;
+		ReleaseDictionary(previous);
+	}
+}
+
+void TichStateStore::PushTimeline(const String &key)
+{
+	// a rewritten state moves to the front
+	timeline.erase(key);
+	timeline.push_back(key);
+
+	while (timelineCapacity > 0 && timeline.size() > timelineCapacity)
+	{
+		Release(timeline[0]);
+		timeline.remove(0);
+	}
+}
+
+int TichStateStore::GetSlotCount() const
+{
+	MutexLock lock(mutex);
+	return slots.size();
+}
+
+uint64_t TichStateStore::GetSlotSize(const String &path) const
+{
+	MutexLock lock(mutex);
+
+	const Map<String, Slot>::Element *E = slots.find(GetKey(path));
+	return E ? E->get().length : 0;
+}
+
+uint64_t TichStateStore::GetSlotMemory(const String &path) const
+{
+	MutexLock lock(mutex);
+
+	const Map<String, Slot>::Element *E = slots.find(GetKey(path));
+	return E ? E->get().data.size() : 0;
+}
+
+uint64_t TichStateStore::GetMemoryUsage() const
+{
+	MutexLock lock(mutex);
+	return memoryUsage;
+}
+
+void TichStateStore::SetCompression(bool enabled)
+{
+	MutexLock lock(mutex);
+	compression = enabled;
+}
+
+bool TichStateStore::IsCompression() const
+{
+	MutexLock lock(mutex);
+	return compression;
+}
+
+void TichStateStore::SetTimelineCapacity(int capacity)
+{
+	ERR_FAIL_COND(capacity < 0);
+
+	MutexLock lock(mutex);
+
+	timelineCapacity = capacity;
+	while (timelineCapacity > 0 && timeline.size() > timelineCapacity)
+	{
+		Release(timeline[0]);
+		timeline.remove(0);
+	}
+}
+
+int TichStateStore::GetTimelineCapacity() const
+{
+	MutexLock lock(mutex);
+	return timelineCapacity;
+}
+
+int TichStateStore::GetTimelineLength() const
+{
+	MutexLock lock(mutex);
+	return timeline.size();
+}
+
+String TichStateStore::GetTimelineState(int stepsBack) const
+{
+	MutexLock lock(mutex);
+
+	ERR_FAIL_INDEX_V(stepsBack, timeline.size(), String());
+
+	return timeline[timeline.size() - 1 - stepsBack];
+}
+
+///////////////////////////////////////////////////////////
+
+Error FileAccessTichStore::_open(const String &p_path, int p_mode_flags)
+{
+	TichStateStore *store = TichStateStore::get_singleton();
+	ERR_FAIL_COND_V(!store, ERR_UNCONFIGURED);
+
+	close();
+
+	path = TichStateStore::GetKey(p_path);
+	pos = 0;
+
+	if (p_mode_flags & WRITE)
+	{
+		writing = true;
+		length = 0;
+
+		// the last state written here is the best guess for this one
+		Reserve(store->GetSlotSize(path));
+		return OK;
+	}
+
+	writing = false;
+	if (!store->GetSlot(path, buffer, length))
+	{
+		path = String();
+		ERR_FAIL_V_MSG(ERR_FILE_NOT_FOUND, "Can't find state '" + p_path + "'.");
+	}
+
+	data = (uint8_t *)buffer.ptr();
+	return OK;
+}
+
+void FileAccessTichStore::close()
+{
+	if (path.empty())
+		return;
+
+	if (writing)
+	{
+		// trimmed while unshared, so the shrink happens in place
+		buffer.resize(length);
+		TichStateStore::get_singleton()->Commit(path, buffer, length, resources);
+	}
+
+	buffer = Vector<uint8_t>();
+	resources.clear();
+	data = NULL;
+	length = 0;
+	writing = false;
+	path = String();
+}
+
+bool FileAccessTichStore::is_open() const
+{
+	return !path.empty();
+}
+
+String FileAccessTichStore::get_path() const
+{
+	return path;
+}
+
+String FileAccessTichStore::get_path_absolute() const
+{
+	return path;
+}
+
+void FileAccessTichStore::Reserve(uint64_t size)
+{
+	if (size <= (uint64_t)buffer.size())
+		return;
+
+	uint64_t capacity = MAX((uint64_t)buffer.size(), (uint64_t)4096);
+	while (capacity < size)
+		capacity *= 2;
+
+	buffer.resize(capacity);
+	data = buffer.ptrw();
+}
+
+void FileAccessTichStore::seek(size_t p_position)
+{
+	ERR_FAIL_COND(path.empty());
+	pos = p_position;
+}
+
+void FileAccessTichStore::seek_end(int64_t p_position)
+{
+	ERR_FAIL_COND(path.empty());
+	pos = length + p_position;
+}
+
+size_t FileAccessTichStore::get_position() const
+{
+	ERR_FAIL_COND_V(path.empty(), 0);
+	return pos;
+}
+
+size_t FileAccessTichStore::get_len() const
+{
+	ERR_FAIL_COND_V(path.empty(), 0);
+	return length;
+}
+
+bool FileAccessTichStore::eof_reached() const
+{
+	return pos > length;
+}
+
+uint8_t FileAccessTichStore::get_8() const
+{
+	uint8_t ret = 0;
+	if (pos < length)
+		ret = data[pos];
+
+	++pos;
+	return ret;
+}
+
+int FileAccessTichStore::get_buffer(uint8_t *p_dst, int p_length) const
+{
+	ERR_FAIL_COND_V(path.empty(), -1);
+
+	uint64_t left = pos < length ? length - pos : 0;
+	int read = MIN((uint64_t)p_length, left);
+
+	if (read < p_length)
+		WARN_PRINT("Reading less data than requested");
+
+	copymem(p_dst, &data[pos], read);
+	pos += p_length;
+
+	return read;
+}
+
+Error FileAccessTichStore::get_error() const
+{
+	return pos >= length ? ERR_FILE_EOF : OK;
+}
+
+void FileAccessTichStore::flush()
+{
+	ERR_FAIL_COND(path.empty());
+}
+
+void FileAccessTichStore::store_8(uint8_t p_byte)
+{
+	ERR_FAIL_COND(!writing);
+
+	Reserve(pos + 1);
+	data[pos++] = p_byte;
+	length = MAX(length, pos);
+}
+
+void FileAccessTichStore::store_buffer(const uint8_t *p_src, int p_length)
+{
+	ERR_FAIL_COND(!writing);
+
+	Reserve(pos + p_length);
+	copymem(&data[pos], p_src, p_length);
+	pos += p_length;
+	length = MAX(length, pos);
+}
+
+bool FileAccessTichStore::file_exists(const String &p_name)
+{
+	return TichStateStore::get_singleton() && TichStateStore::get_singleton()->HasSlot(p_name);
+}
+
+FileAccessTichStore::FileAccessTichStore() :
+	data(NULL),
+	length(0),
+	pos(0),
+	writing(false)
+{
+}
+
+FileAccessTichStore::~FileAccessTichStore()
+{
+	close();
+}
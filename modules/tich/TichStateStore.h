@@ -0,0 +1,153 @@
+#ifndef TICH_STATE_STORE_H
+#define TICH_STATE_STORE_H
+
+#include "core/map.h"
+#include "core/os/file_access.h"
+#include "core/os/mutex.h"
+#include "core/vector.h"
+
+// In-memory home of the save states written by the memory and binary
+// formats. Every state path gets its own slot, sized to the state that was
+// written to it. The timeline lists the slots from the oldest to the most
+// recently written one; with a capacity set it works as a ring, the oldest
+// slot is released when a new state does not fit anymore.
+//
+// With compression on, states are stored as zstd frames primed with a
+// dictionary cut from an earlier state. Consecutive states of a scene share
+// most of their names and values, so the dictionary does most of the work.
+// Every slot keeps the dictionary it was compressed with alive.
+class TichStateStore
+{
+	static TichStateStore *singleton;
+
+	enum
+	{
+		COMPRESSION_LEVEL = 1,
+		COMPRESSION_MIN_SIZE = 256,
+		DICTIONARY_SIZE = 256 * 1024,
+		DICTIONARY_INTERVAL = 32, // states compressed before the dictionary is renewed
+	};
+
+	struct Slot
+	{
+		Vector<uint8_t> data; // reserved bytes, the state is the first `length`
+		uint64_t length;
+		bool compressed; // data is a zstd frame of `length` bytes
+		uint32_t dictionary;
+		Vector<uint64_t> resources; // TichResourceCache entries the state references
+	};
+
+	struct StateDictionary
+	{
+		Vector<uint8_t> data;
+		int references;
+	};
+
+private:
+	Mutex *mutex;
+	Map<String, Slot> slots;
+	uint64_t memoryUsage;
+
+	Vector<String> timeline;
+	int timelineCapacity; // 0 keeps every state
+
+	bool compression;
+	Map<uint32_t, StateDictionary> dictionaries;
+	uint32_t currentDictionary; // 0 while no state has been written yet
+	uint32_t lastDictionary;
+	int dictionaryAge;
+
+	void Release(const String &key);
+	static void ReleaseResources(const Vector<uint64_t> &resources);
+	void PushTimeline(const String &key);
+
+	uint32_t AcquireDictionary(Vector<uint8_t> &data);
+	void ReleaseDictionary(uint32_t id);
+	void RenewDictionary(const Vector<uint8_t> &data, uint64_t length);
+
+public:
+	TichStateStore();
+	~TichStateStore();
+
+	static String GetKey(const String &path);
+
+	bool HasSlot(const String &path) const;
+	bool GetSlot(const String &path, Vector<uint8_t> &data, uint64_t &length) const;
+	// The slot takes over the references to the cached resources.
+	void Commit(const String &path, const Vector<uint8_t> &data, uint64_t length, const Vector<uint64_t> &resources);
+	void Erase(const String &path);
+	void Clear();
+
+	int GetSlotCount() const;
+	uint64_t GetSlotSize(const String &path) const;
+	uint64_t GetSlotMemory(const String &path) const;
+	uint64_t GetMemoryUsage() const;
+
+	// Applies to states written from now on, stored states keep their format.
+	void SetCompression(bool enabled);
+	bool IsCompression() const;
+
+	void SetTimelineCapacity(int capacity);
+	int GetTimelineCapacity() const;
+	int GetTimelineLength() const;
+	String GetTimelineState(int stepsBack) const;
+
+	static TichStateStore *get_singleton() { return singleton; }
+};
+
+// Reads and writes one slot of the TichStateStore. Reads work on a copy on
+// write reference of the slot, writes go to a private buffer that grows as
+// needed and is committed to the store on close.
+class FileAccessTichStore : public FileAccess
+{
+	String path;
+	Vector<uint8_t> buffer;
+	uint8_t *data;
+	uint64_t length;
+	mutable uint64_t pos;
+	bool writing;
+	Vector<uint64_t> resources;
+
+	void Reserve(uint64_t size);
+
+public:
+	// The open state, valid until close().
+	const uint8_t *GetData() const { return data; }
+
+	// A TichResourceCache reference taken by the state being written.
+	void AddCachedResource(uint64_t hash) { resources.push_back(hash); }
+
+	virtual Error _open(const String &p_path, int p_mode_flags);
+	virtual void close();
+	virtual bool is_open() const;
+
+	virtual String get_path() const;
+	virtual String get_path_absolute() const;
+
+	virtual void seek(size_t p_position);
+	virtual void seek_end(int64_t p_position);
+	virtual size_t get_position() const;
+	virtual size_t get_len() const;
+
+	virtual bool eof_reached() const;
+
+	virtual uint8_t get_8() const;
+	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+
+	virtual Error get_error() const;
+
+	virtual void flush();
+	virtual void store_8(uint8_t p_byte);
+	virtual void store_buffer(const uint8_t *p_src, int p_length);
+
+	virtual bool file_exists(const String &p_name);
+
+	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
+	virtual uint32_t _get_unix_permissions(const String &p_file) { return 0; }
+	virtual Error _set_unix_permissions(const String &p_file, uint32_t p_permissions) { return FAILED; }
+
+	FileAccessTichStore();
+	~FileAccessTichStore();
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "scene/main/scene_tree.h"
 #include "scene/2d/parallax_layer.h"
 #include "scene/resources/packed_scene.h"
+#include "core/io/resource_loader.h"
 #include "TichInfo.h"
 
 #include "main/input_default.h"
@@ -12,10 +13,13 @@
 #include "core/engine.h"
 
 #include "core/os/os.h"
-#include "main/Performance.h"
+#include "main/performance.h"
 
 #include "resource_format_memory.h"
 #include "TichProfiler.h"
+#include "TichDelta.h"
+#include "TichSaveWorker.h"
+#include "TichStateStore.h"
 
 #include "FunctionProfiler.h"
 
@@ -25,6 +29,9 @@
 #define SAVE_FILE_EXTENTION ".tich"
 //#define SAVE_FILE_EXTENTION ".tscn"
 
+// states kept in the store, the oldest is released when a new one does not fit
+#define STATE_TIMELINE_CAPACITY 64
+
 TichSystem* TichSystem::s_Instance = nullptr;
 
 TichSystem::TichSystem()
@@ -34,7 +41,28 @@ TichSystem::TichSystem()
 	currentComplexity = Complexity::LEVEL_2;
 	lastButtonStateF1 = false;
 	lastButtonStateF2 = false;
+	lastButtonStateF8 = false;
+	lastButtonStateF9 = false;
+	lastButtonStateF10 = false;
+	lastButtonStateF11 = false;
+	lastButtonStateF12 = false;
 	screenshotCountDown = -1;
+	asyncSave = false;
+	reportSaveSize = false;
+	saveWorker = nullptr;
+	deltaMode = false;
+	maxDeltaChain = 10;
+	deltaChain = 0;
+	inPlaceRestore = false;
+
+	if (TichStateStore::get_singleton())
+		TichStateStore::get_singleton()->SetTimelineCapacity(STATE_TIMELINE_CAPACITY);
+}
+
+TichSystem::~TichSystem()
+{
+	if (saveWorker)
+		memdelete(saveWorker);
 }
 
 void TichSystem::Update(uint64_t frameTime)
@@ -59,6 +87,21 @@ void TichSystem::Update(uint64_t frameTime)
 	//Change Level Complexity
 	bool buttonStateF7 = input->is_key_pressed(KeyList::KEY_F7);
 
+	//Toggle Delta Snapshots
+	bool buttonStateF8 = input->is_key_pressed(KeyList::KEY_F8);
+
+	//Toggle Background Saving
+	bool buttonStateF9 = input->is_key_pressed(KeyList::KEY_F9);
+
+	//Toggle Parallel Packing
+	bool buttonStateF10 = input->is_key_pressed(KeyList::KEY_F10);
+
+	//Toggle In-Place Restore
+	bool buttonStateF11 = input->is_key_pressed(KeyList::KEY_F11);
+
+	//Toggle State Compression
+	bool buttonStateF12 = input->is_key_pressed(KeyList::KEY_F12);
+
 	if (buttonStateF1)
 	{
 		if (!lastButtonStateF1)
@@ -74,7 +117,11 @@ void TichSystem::Update(uint64_t frameTime)
 				os->print("Save Time %llu\n", time);
 				os->print("Memory %llu\n", Memory::get_mem_usage());
 				os->print("Frame Time %llu\n", frameTime);
-				os->print("State Size %llu\n", ResourceFormatSaver::get_state_size());
+				// written on the worker, its size is known once it completes
+				if (asyncSave)
+					reportSaveSize = true;
+				else
+					os->print("State Size %llu\n", ResourceFormatSaver::get_state_size());
 			}
 		}	
 	}
@@ -151,6 +198,37 @@ void TichSystem::Update(uint64_t frameTime)
 		}
 	}
 
+	if (buttonStateF8 && !lastButtonStateF8)
+	{
+		SetDeltaMode(!deltaMode, maxDeltaChain);
+		OS::get_singleton()->print("Delta Snapshots %s\n", deltaMode ? "On" : "Off");
+	}
+
+	if (buttonStateF9 && !lastButtonStateF9)
+	{
+		SetAsyncSave(!asyncSave);
+		OS::get_singleton()->print("Background Saving %s\n", asyncSave ? "On" : "Off");
+	}
+
+	if (buttonStateF10 && !lastButtonStateF10)
+	{
+		SceneState::set_parallel_pack(!SceneState::is_parallel_pack());
+		OS::get_singleton()->print("Parallel Packing %s\n", SceneState::is_parallel_pack() ? "On" : "Off");
+	}
+
+	if (buttonStateF11 && !lastButtonStateF11)
+	{
+		SetInPlaceRestore(!inPlaceRestore);
+		OS::get_singleton()->print("In-Place Restore %s\n", inPlaceRestore ? "On" : "Off");
+	}
+
+	if (buttonStateF12 && !lastButtonStateF12)
+	{
+		TichStateStore *store = TichStateStore::get_singleton();
+		store->SetCompression(!store->IsCompression());
+		OS::get_singleton()->print("State Compression %s\n", store->IsCompression() ? "On" : "Off");
+	}
+
 	lastButtonStateF1 = buttonStateF1;
 	lastButtonStateF2 = buttonStateF2;
 	lastButtonStateF3 = buttonStateF3;
@@ -158,6 +236,13 @@ void TichSystem::Update(uint64_t frameTime)
 	lastButtonStateF5 = buttonStateF5;
 	lastButtonStateF6 = buttonStateF6;
 	lastButtonStateF7 = buttonStateF7;
+	lastButtonStateF8 = buttonStateF8;
+	lastButtonStateF9 = buttonStateF9;
+	lastButtonStateF10 = buttonStateF10;
+	lastButtonStateF11 = buttonStateF11;
+	lastButtonStateF12 = buttonStateF12;
+
+	PollSaveWorker();
 
 	if (currentTreeVersion != SceneTree::get_singleton()->get_tree_version())
 	{
@@ -217,22 +302,56 @@ bool TichSystem::Save(const String& file)
 		return false;
 	}
 
-	FUNCTION_PROFILER_BEGIN("ResourceSaver::save()");
-	result = ResourceSaver::save(file, packedScene);
-	FUNCTION_PROFILER_END("ResourceSaver::save()");
+	// the state outlives this frame, either as delta base or on the worker
+	if (deltaMode || asyncSave)
+		packedScene->get_state()->make_variants_unique();
 
-	if (result != Error::OK)
+	TichSaveWorker::Job job;
+	job.path = file;
+	job.scene = packedScene;
+
+	// a delta written over any state of its own chain would break the chain, that one is a full snapshot
+	if (deltaMode && deltaBaseState.is_valid() && deltaChain < maxDeltaChain && !deltaChainPaths.has(file))
+	{
+		job.deltaBase = deltaBaseState;
+		job.deltaBasePath = deltaBasePath;
+		job.deltaDepth = deltaChain + 1;
+	}
+
+	if (asyncSave)
 	{
-		ERR_PRINT("Failed to save scene, Error: " + result);
 		TichInfo::s_IsSaving = false;
-		return false;
+
+		saveWorker->Queue(job);
 	}
+	else
+	{
+		uint64_t stateSize;
 
-	//WARN_PRINT("Scene Saved Successfully");
+		FUNCTION_PROFILER_BEGIN("ResourceSaver::save()");
+		result = TichSaveWorker::Write(job, stateSize);
+		FUNCTION_PROFILER_END("ResourceSaver::save()");
+
+		TichInfo::s_IsSaving = false;
 
-	TichInfo::s_IsSaving = false;
+		if (result != Error::OK)
+		{
+			ERR_PRINT("Failed to save scene, Error: " + result);
+			return false;
+		}
+	}
 
-	FUNCTION_PROFILER_SAVE();
+	if (deltaMode)
+	{
+		deltaChain = job.deltaBase.is_valid() ? job.deltaDepth : 0;
+		deltaBaseState = packedScene->get_state();
+		deltaBasePath = file;
+		if (!job.deltaBase.is_valid())
+			deltaChainPaths.clear();
+		deltaChainPaths.insert(file);
+	}
+
+	//WARN_PRINT("Scene Saved Successfully");
 
 	return true;
 }
@@ -242,10 +361,38 @@ bool TichSystem::Load(const String &file)
 	if (TichInfo::s_IsLoading)
 		return false;
 
+	// the state may still be in flight
+	if (saveWorker)
+		saveWorker->Wait();
+
 	TichInfo::s_IsLoading = true;
 	//WARN_PRINT("Loading");
 
-	Error result = SceneTree::get_singleton()->change_scene(file);
+	Error result = ERR_CANT_OPEN;
+	Set<String> chainPaths;
+	Ref<SceneState> state = LoadState(file, chainPaths);
+
+	// the live tree is updated when the state allows it, rebuilt otherwise
+	if (state.is_valid() && inPlaceRestore)
+		result = SceneTree::get_singleton()->restore_scene_in_place(state);
+
+	if (state.is_valid() && (!inPlaceRestore || result == ERR_UNAVAILABLE))
+	{
+		Ref<PackedScene> packedScene;
+		packedScene.instance();
+		packedScene->replace_state(state);
+
+		result = SceneTree::get_singleton()->change_scene_to(packedScene);
+	}
+
+	if (result == Error::OK && deltaMode)
+	{
+		// the loaded state becomes the base of the next delta
+		deltaBaseState = state;
+		deltaBasePath = file;
+		deltaChain = chainPaths.size() - 1;
+		deltaChainPaths = chainPaths;
+	}
 
 	currentTreeVersion = SceneTree::get_singleton()->get_tree_version();
 
@@ -259,6 +406,149 @@ bool TichSystem::Load(const String &file)
 	return true;
 }
 
+// Loads the state saved `steps` saves ago from the state store timeline. With
+// delta snapshots on, the timeline capacity has to exceed the delta chain
+// length, otherwise the base of an old delta may already be evicted.
+bool TichSystem::Rewind(int steps)
+{
+	TichStateStore *store = TichStateStore::get_singleton();
+	ERR_FAIL_COND_V(!store, false);
+
+	if (saveWorker)
+		saveWorker->Wait();
+
+	ERR_FAIL_INDEX_V(steps, store->GetTimelineLength(), false);
+
+	return Load(store->GetTimelineState(steps));
+}
+
+void TichSystem::SetDeltaMode(bool enabled, uint16_t maxChainLength)
+{
+	deltaMode = enabled;
+	maxDeltaChain = maxChainLength;
+
+	// the base of every delta in the chain has to stay in the store
+	TichStateStore *store = TichStateStore::get_singleton();
+	if (enabled && store && store->GetTimelineCapacity() && store->GetTimelineCapacity() <= maxChainLength)
+		store->SetTimelineCapacity(maxChainLength + 1);
+
+	// the next save is always a full snapshot
+	deltaChain = 0;
+	deltaBasePath = String();
+	deltaBaseState.unref();
+	deltaChainPaths.clear();
+}
+
+bool TichSystem::IsDeltaMode() const
+{
+	return deltaMode;
+}
+
+void TichSystem::SetAsyncSave(bool enabled)
+{
+	if (enabled && !saveWorker)
+		saveWorker = memnew(TichSaveWorker);
+
+	if (enabled && !saveWorker->IsStarted())
+		saveWorker->Start();
+	else if (!enabled && saveWorker)
+		saveWorker->Wait();
+
+	asyncSave = enabled;
+
+	// a base captured inline may still share containers with the tree
+	deltaChain = 0;
+	deltaBasePath = String();
+	deltaBaseState.unref();
+	deltaChainPaths.clear();
+}
+
+bool TichSystem::IsAsyncSave() const
+{
+	return asyncSave;
+}
+
+void TichSystem::SetInPlaceRestore(bool enabled)
+{
+	inPlaceRestore = enabled;
+}
+
+bool TichSystem::IsInPlaceRestore() const
+{
+	return inPlaceRestore;
+}
+
+void TichSystem::PollSaveWorker()
+{
+	if (!saveWorker)
+		return;
+
+	TichSaveWorker::Result result;
+	while (saveWorker->PopResult(result))
+	{
+		if (result.error != Error::OK)
+		{
+			ERR_PRINT("Failed to save scene, Error: " + itos(result.error));
+
+			// the next delta cannot build on a chain with a state that was never written
+			if (deltaChainPaths.has(result.path))
+			{
+				deltaChain = 0;
+				deltaBasePath = String();
+				deltaBaseState.unref();
+				deltaChainPaths.clear();
+			}
+		}
+
+		if (reportSaveSize && result.path == SAVE_FILE)
+		{
+			reportSaveSize = false;
+			if (result.error == Error::OK)
+				OS::get_singleton()->print("State Size %llu\n", result.stateSize);
+		}
+
+		TichProfiler::get_singleton()->emit_signal("_save_completed", result.path, result.error == Error::OK, result.stateSize, result.writeTime);
+	}
+}
+
+Ref<SceneState> TichSystem::LoadState(const String &file, Set<String> &chainPaths)
+{
+	// walk back to the full snapshot, then replay the deltas on top of it
+	Vector<Ref<TichDelta> > deltas;
+	String path = file;
+	RES res = ResourceLoader::load(path);
+	chainPaths.insert(path);
+
+	while (res.is_valid() && res->is_class("TichDelta"))
+	{
+		Ref<TichDelta> delta = res;
+		deltas.push_back(delta);
+
+		path = delta->get_base_path();
+		ERR_FAIL_COND_V_MSG(chainPaths.has(path), Ref<SceneState>(), "Delta chain is circular, " + path + " is visited twice: " + file + ".");
+		chainPaths.insert(path);
+		res = ResourceLoader::load(path);
+	}
+
+	Ref<PackedScene> packedScene = res;
+	ERR_FAIL_COND_V_MSG(packedScene.is_null(), Ref<SceneState>(), "Failed to load base snapshot: " + path + ".");
+
+	Ref<SceneState> state = packedScene->get_state();
+
+	for (int i = deltas.size() - 1; i >= 0; i--)
+	{
+		Ref<SceneState> next;
+		next.instance();
+
+		Error err = next->apply_delta(state, deltas[i]->get_delta());
+		ERR_FAIL_COND_V_MSG(err != OK, Ref<SceneState>(), "Failed to apply delta snapshot, Error: " + itos(err));
+
+		state = next;
+	}
+
+	return state;
+}
+
 void TichSystem::OnReadyPost()
 {
 	TichInfo::s_IsLoading = false;
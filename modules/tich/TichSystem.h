@@ -2,9 +2,12 @@
 #define TICH_SYSTEM_H
 
 #include "core/reference.h"
+#include "core/set.h"
 #include "core/vector.h"
 
 class ParallaxBackground;
+class SceneState;
+class TichSaveWorker;
 
 
 enum Complexity : uint16_t {
@@ -19,11 +22,24 @@ class TichSystem : public Reference
 
 public:
 	TichSystem();
+	~TichSystem();
 
 	void Update(uint64_t frameTime);
 	void ChangeComplexity();
 	bool Save(const String &file);
 	bool Load(const String &file);
+	bool Rewind(int steps);
+
+	void SetDeltaMode(bool enabled, uint16_t maxChainLength = 10);
+	bool IsDeltaMode() const;
+
+	void SetAsyncSave(bool enabled);
+	bool IsAsyncSave() const;
+
+	// Loads update the live tree instead of replacing it, nodes that still
+	// exist keep their identity and only differing properties are written.
+	void SetInPlaceRestore(bool enabled);
+	bool IsInPlaceRestore() const;
 
 private:
 
@@ -35,6 +51,9 @@ private:
 	void OnPreSave();
 	void OnPostSave();
 
+	Ref<SceneState> LoadState(const String &file, Set<String> &chainPaths);
+	void PollSaveWorker();
+
 public:
 	static TichSystem* GetInstance();
 
@@ -46,6 +65,11 @@ private:
 	bool lastButtonStateF5;
 	bool lastButtonStateF6;
 	bool lastButtonStateF7;
+	bool lastButtonStateF8;
+	bool lastButtonStateF9;
+	bool lastButtonStateF10;
+	bool lastButtonStateF11;
+	bool lastButtonStateF12;
 	uint64_t currentTreeVersion;
 
 	uint16_t currentComplexity;
@@ -54,6 +78,19 @@ private:
 	int8_t screenshotCountDown;
 	String screenshotFileName;
 
+	bool asyncSave;
+	bool reportSaveSize; // print the size of the F1 save when the worker completes it
+	TichSaveWorker *saveWorker;
+
+	bool deltaMode;
+	uint16_t maxDeltaChain;
+	uint16_t deltaChain;
+	String deltaBasePath;
+	Ref<SceneState> deltaBaseState;
+	Set<String> deltaChainPaths; // the base snapshot and the deltas up to deltaBasePath
+
+	bool inPlaceRestore;
+
 private:
 	Vector<ParallaxBackground*> parallaxBackgrounds;
 
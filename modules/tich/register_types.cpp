@@ -3,6 +3,9 @@
 #include "resource_format_memory.h"
 #include "TichSystem.h"
 #include "TichProfiler.h"
+#include "TichDelta.h"
+#include "TichResourceCache.h"
+#include "TichStateStore.h"
 #include "FunctionProfiler.h"
 
 #include "core/class_db.h"
@@ -10,21 +13,21 @@
 #include "core/io/resource_saver.h"
 #include "core/io/resource_loader.h"
 
-#include "core/io/file_access_memory.h"
 
 static Ref<ResourceFormatSaverMemory> resource_saver_memory;
 static Ref<ResourceFormatLoaderMemory> resource_loader_memory;
 
+static TichStateStore *stateStore = NULL;
+static TichResourceCache *resourceCache = NULL;
+
 static Ref<TichSystem> tichSystem;
 static Ref<TichProfiler> tichProfiler;
 static Ref<FunctionProfiler> functionProfiler;
 
 void register_tich_types()
 {
-	Vector<uint8_t> data;
-	data.resize(1024 * 1024 * 64);
-
-	FileAccessMemory::register_file("data", data);
+	stateStore = memnew(TichStateStore);
+	resourceCache = memnew(TichResourceCache);
 
 	resource_saver_memory.instance();
 	ResourceSaver::add_resource_format_saver(resource_saver_memory);
@@ -34,6 +37,7 @@ void register_tich_types()
 
 	ClassDB::register_class<TichSystem>();
 	ClassDB::register_class<TichProfiler>();
+	ClassDB::register_class<TichDelta>();
 
 	tichSystem.instance();
 	tichProfiler.instance();
@@ -44,7 +48,14 @@ void register_tich_types()
 
 void unregister_tich_types()
 {
-	FileAccessMemory::cleanup();
+	// stops the save worker before its target goes away
+	tichSystem.unref();
+
+	memdelete(stateStore);
+	stateStore = NULL;
+
+	memdelete(resourceCache);
+	resourceCache = NULL;
 
 	ResourceSaver::remove_resource_format_saver(resource_saver_memory);
 	resource_saver_memory.unref();
@@ -52,7 +63,6 @@ void unregister_tich_types()
 	ResourceLoader::remove_resource_format_loader(resource_loader_memory);
 	resource_loader_memory.unref();
 
-	tichSystem.unref();
 	tichProfiler.unref();
 	functionProfiler.unref();
 }
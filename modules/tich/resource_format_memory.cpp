@@ -38,15 +38,17 @@
 #include "core/version.h"
 
 #include "scene/main/node.h"
+#include "scene/resources/packed_scene.h"
 
-#include "core/io/file_access_memory.h"
 
 #include "core/math/random_number_generator.h"
 
 #include "TichInfo.h"
+#include "TichResourceCache.h"
+#include "TichStateStore.h"
 
 //#define print_bl(m_what) print_line(m_what)
-#define print_bl(m_what) (void)(m_what)
+#define print_bl(m_what) (void)0
 
 enum {
 
@@ -94,6 +96,7 @@ enum {
 	OBJECT_INTERNAL_RESOURCE = 2,
 	OBJECT_EXTERNAL_RESOURCE_INDEX = 3,
 	OBJECT_RANDOM_GENERATOR = 4,
+	OBJECT_CACHED_RESOURCE = 5,
 	//version 2: added 64 bits support for float and int
 	//version 3: changed nodepath encoding
 	FORMAT_VERSION = 3,
@@ -102,18 +105,110 @@ enum {
 
 };
 
+// Returns where the next `p_size` bytes are, NULL past the end of the buffer.
+_FORCE_INLINE_ const uint8_t *ResourceInteractiveLoaderMemory::_advance(uint64_t p_size) {
+
+	const uint8_t *ptr = data_pos + p_size <= data_len ? &data[data_pos] : NULL;
+	data_pos += p_size;
+	return ptr;
+}
+
+_FORCE_INLINE_ uint8_t ResourceInteractiveLoaderMemory::_get_8() {
+
+	if (!data)
+		return f->get_8();
+
+	const uint8_t *ptr = _advance(1);
+	return ptr ? *ptr : 0;
+}
+
+_FORCE_INLINE_ uint16_t ResourceInteractiveLoaderMemory::_get_16() {
+
+	if (!data)
+		return f->get_16();
+
+	const uint8_t *ptr = _advance(2);
+	return ptr ? decode_uint16(ptr) : 0;
+}
+
+_FORCE_INLINE_ uint32_t ResourceInteractiveLoaderMemory::_get_32() {
+
+	if (!data)
+		return f->get_32();
+
+	const uint8_t *ptr = _advance(4);
+	return ptr ? decode_uint32(ptr) : 0;
+}
+
+_FORCE_INLINE_ uint64_t ResourceInteractiveLoaderMemory::_get_64() {
+
+	if (!data)
+		return f->get_64();
+
+	const uint8_t *ptr = _advance(8);
+	return ptr ? decode_uint64(ptr) : 0;
+}
+
+_FORCE_INLINE_ float ResourceInteractiveLoaderMemory::_get_float() {
+
+	if (!data)
+		return f->get_float();
+
+	const uint8_t *ptr = _advance(4);
+	return ptr ? decode_float(ptr) : 0;
+}
+
+_FORCE_INLINE_ double ResourceInteractiveLoaderMemory::_get_double() {
+
+	if (!data)
+		return f->get_double();
+
+	const uint8_t *ptr = _advance(8);
+	return ptr ? decode_double(ptr) : 0;
+}
+
+void ResourceInteractiveLoaderMemory::_get_buffer(uint8_t *p_dst, uint64_t p_length) {
+
+	if (!data) {
+		f->get_buffer(p_dst, p_length);
+		return;
+	}
+
+	uint64_t left = data_pos < data_len ? data_len - data_pos : 0;
+	uint64_t read = MIN(p_length, left);
+
+	copymem(p_dst, &data[data_pos], read);
+	if (read < p_length)
+		zeromem(p_dst + read, p_length - read);
+
+	data_pos += p_length;
+}
+
+void ResourceInteractiveLoaderMemory::_seek(uint64_t p_position) {
+
+	if (data)
+		data_pos = p_position;
+	else
+		f->seek(p_position);
+}
+
+bool ResourceInteractiveLoaderMemory::_eof_reached() const {
+
+	return data ? data_pos > data_len : f->eof_reached();
+}
+
 void ResourceInteractiveLoaderMemory::_advance_padding(uint32_t p_len) {
 
 	uint32_t extra = 4 - (p_len % 4);
 	if (extra < 4) {
 		for (uint32_t i = 0; i < extra; i++)
-			f->get_8(); //pad to 32
+			_get_8(); //pad to 32
 	}
 }
 
 Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 {
-	uint8_t type = f->get_8();
+	uint8_t type = _get_8();
 
 	print_bl("find property of type: " + itos(type));
 
@@ -133,19 +228,19 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_INT: {
 
-			r_v = int(f->get_32());
+			r_v = int(_get_32());
 		} break;
 		case VARIANT_INT64: {
 
-			r_v = int64_t(f->get_64());
+			r_v = int64_t(_get_64());
 		} break;
 		case VARIANT_REAL: {
 
-			r_v = f->get_float();
+			r_v = _get_float();
 		} break;
 		case VARIANT_DOUBLE: {
 
-			r_v = f->get_double();
+			r_v = _get_double();
 		} break;
 		case VARIANT_STRING: {
 
@@ -158,107 +253,107 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		case VARIANT_VECTOR2: {
 
 			Vector2 v;
-			v.x = f->get_float();
-			v.y = f->get_float();
+			v.x = _get_float();
+			v.y = _get_float();
 			r_v = v;
 
 		} break;
 		case VARIANT_RECT2: {
 
 			Rect2 v;
-			v.position.x = f->get_float();
-			v.position.y = f->get_float();
-			v.size.x = f->get_float();
-			v.size.y = f->get_float();
+			v.position.x = _get_float();
+			v.position.y = _get_float();
+			v.size.x = _get_float();
+			v.size.y = _get_float();
 			r_v = v;
 
 		} break;
 		case VARIANT_VECTOR3: {
 
 			Vector3 v;
-			v.x = f->get_float();
-			v.y = f->get_float();
-			v.z = f->get_float();
+			v.x = _get_float();
+			v.y = _get_float();
+			v.z = _get_float();
 			r_v = v;
 		} break;
 		case VARIANT_PLANE: {
 
 			Plane v;
-			v.normal.x = f->get_float();
-			v.normal.y = f->get_float();
-			v.normal.z = f->get_float();
-			v.d = f->get_float();
+			v.normal.x = _get_float();
+			v.normal.y = _get_float();
+			v.normal.z = _get_float();
+			v.d = _get_float();
 			r_v = v;
 		} break;
 		case VARIANT_QUAT: {
 			Quat v;
-			v.x = f->get_float();
-			v.y = f->get_float();
-			v.z = f->get_float();
-			v.w = f->get_float();
+			v.x = _get_float();
+			v.y = _get_float();
+			v.z = _get_float();
+			v.w = _get_float();
 			r_v = v;
 
 		} break;
 		case VARIANT_AABB: {
 
 			AABB v;
-			v.position.x = f->get_float();
-			v.position.y = f->get_float();
-			v.position.z = f->get_float();
-			v.size.x = f->get_float();
-			v.size.y = f->get_float();
-			v.size.z = f->get_float();
+			v.position.x = _get_float();
+			v.position.y = _get_float();
+			v.position.z = _get_float();
+			v.size.x = _get_float();
+			v.size.y = _get_float();
+			v.size.z = _get_float();
 			r_v = v;
 
 		} break;
 		case VARIANT_MATRIX32: {
 
 			Transform2D v;
-			v.elements[0].x = f->get_float();
-			v.elements[0].y = f->get_float();
-			v.elements[1].x = f->get_float();
-			v.elements[1].y = f->get_float();
-			v.elements[2].x = f->get_float();
-			v.elements[2].y = f->get_float();
+			v.elements[0].x = _get_float();
+			v.elements[0].y = _get_float();
+			v.elements[1].x = _get_float();
+			v.elements[1].y = _get_float();
+			v.elements[2].x = _get_float();
+			v.elements[2].y = _get_float();
 			r_v = v;
 
 		} break;
 		case VARIANT_MATRIX3: {
 
 			Basis v;
-			v.elements[0].x = f->get_float();
-			v.elements[0].y = f->get_float();
-			v.elements[0].z = f->get_float();
-			v.elements[1].x = f->get_float();
-			v.elements[1].y = f->get_float();
-			v.elements[1].z = f->get_float();
-			v.elements[2].x = f->get_float();
-			v.elements[2].y = f->get_float();
-			v.elements[2].z = f->get_float();
+			v.elements[0].x = _get_float();
+			v.elements[0].y = _get_float();
+			v.elements[0].z = _get_float();
+			v.elements[1].x = _get_float();
+			v.elements[1].y = _get_float();
+			v.elements[1].z = _get_float();
+			v.elements[2].x = _get_float();
+			v.elements[2].y = _get_float();
+			v.elements[2].z = _get_float();
 			r_v = v;
 
 		} break;
 		case VARIANT_TRANSFORM: {
 
 			Transform v;
-			v.basis.elements[0].x = f->get_float();
-			v.basis.elements[0].y = f->get_float();
-			v.basis.elements[0].z = f->get_float();
-			v.basis.elements[1].x = f->get_float();
-			v.basis.elements[1].y = f->get_float();
-			v.basis.elements[1].z = f->get_float();
-			v.basis.elements[2].x = f->get_float();
-			v.basis.elements[2].y = f->get_float();
-			v.basis.elements[2].z = f->get_float();
-			v.origin.x = f->get_float();
-			v.origin.y = f->get_float();
-			v.origin.z = f->get_float();
+			v.basis.elements[0].x = _get_float();
+			v.basis.elements[0].y = _get_float();
+			v.basis.elements[0].z = _get_float();
+			v.basis.elements[1].x = _get_float();
+			v.basis.elements[1].y = _get_float();
+			v.basis.elements[1].z = _get_float();
+			v.basis.elements[2].x = _get_float();
+			v.basis.elements[2].y = _get_float();
+			v.basis.elements[2].z = _get_float();
+			v.origin.x = _get_float();
+			v.origin.y = _get_float();
+			v.origin.z = _get_float();
 			r_v = v;
 		} break;
 		case VARIANT_COLOR: {
 
 			Color v;
-			uint32_t color = f->get_32();
+			uint32_t color = _get_32();
 			uint8_t *rgba = (uint8_t *)&color;
 			v.r = (float)rgba[0] / 255.0f;
 			v.g = (float)rgba[1] / 255.0f;
@@ -275,11 +370,11 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_RID: {
 
-			r_v = f->get_32();
+			r_v = _get_32();
 		} break;
 		case VARIANT_OBJECT: {
 
-			uint32_t objtype = f->get_8();
+			uint32_t objtype = _get_8();
 
 			switch (objtype) {
 
@@ -288,7 +383,7 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 
 				} break;
 				case OBJECT_INTERNAL_RESOURCE: {
-					uint32_t index = f->get_32();
+					uint32_t index = _get_32();
 					String path = res_path + "::" + itos(index);
 					RES res = ResourceLoader::load(path);
 					if (res.is_null()) {
@@ -319,10 +414,29 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 					}
 					r_v = res;
 
+				} break;
+				case OBJECT_CACHED_RESOURCE: {
+					uint64_t hash = _get_64();
+					ObjectID identity = _get_64();
+
+					// every reference to the same saved resource gets the same instance
+					RES res;
+					const Map<ObjectID, RES>::Element *C = cached_resources.find(identity);
+					if (C) {
+						res = C->get();
+					} else if (TichResourceCache::get_singleton()) {
+						res = TichResourceCache::get_singleton()->Get(hash, identity);
+						cached_resources[identity] = res;
+					}
+					if (res.is_null()) {
+						WARN_PRINT(String("Couldn't find cached resource: " + String::num_uint64(hash, 16)).utf8().get_data());
+					}
+					r_v = res;
+
 				} break;
 				case OBJECT_EXTERNAL_RESOURCE_INDEX: {
 					//new file format, just refers to an index in the external list
-					int erindex = f->get_32();
+					int erindex = _get_32();
 
 					if (erindex < 0 || erindex >= external_resources.size()) {
 						WARN_PRINT("Broken external resource! (index out of size)");
@@ -348,7 +462,7 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 				} break;
 				case OBJECT_RANDOM_GENERATOR: {
 					Ref<RandomNumberGenerator> rng = (RandomNumberGenerator*)ClassDB::instance("RandomNumberGenerator");
-					rng->set_seed(f->get_64());
+					rng->set_seed(_get_64());
 					r_v = rng;
 				} break;
 				default: {
@@ -360,7 +474,7 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_DICTIONARY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 			Dictionary d; //last bit means shared
 			len &= 0x7FFFFFFF;
 			for (uint32_t i = 0; i < len; i++) {
@@ -377,7 +491,7 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 			Array a; //last bit means shared
 			len &= 0x7FFFFFFF;
 			a.resize(len);
@@ -392,12 +506,12 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_RAW_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 
 			PoolVector<uint8_t> array;
 			array.resize(len);
 			PoolVector<uint8_t>::Write w = array.write();
-			f->get_buffer(w.ptr(), len);
+			_get_buffer(w.ptr(), len);
 			_advance_padding(len);
 			w.release();
 			r_v = array;
@@ -405,12 +519,12 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_INT_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 
 			PoolVector<int> array;
 			array.resize(len);
 			PoolVector<int>::Write w = array.write();
-			f->get_buffer((uint8_t *)w.ptr(), len * 4);
+			_get_buffer((uint8_t *)w.ptr(), len * 4);
 #ifdef BIG_ENDIAN_ENABLED
 			{
 				uint32_t *ptr = (uint32_t *)w.ptr();
@@ -426,12 +540,12 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_REAL_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 
 			PoolVector<real_t> array;
 			array.resize(len);
 			PoolVector<real_t>::Write w = array.write();
-			f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t));
+			_get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t));
 #ifdef BIG_ENDIAN_ENABLED
 			{
 				uint32_t *ptr = (uint32_t *)w.ptr();
@@ -448,7 +562,7 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_STRING_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 			PoolVector<String> array;
 			array.resize(len);
 			PoolVector<String>::Write w = array.write();
@@ -460,13 +574,13 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_VECTOR2_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 
 			PoolVector<Vector2> array;
 			array.resize(len);
 			PoolVector<Vector2>::Write w = array.write();
 			if (sizeof(Vector2) == 8) {
-				f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 2);
+				_get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 2);
 #ifdef BIG_ENDIAN_ENABLED
 				{
 					uint32_t *ptr = (uint32_t *)w.ptr();
@@ -487,13 +601,13 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_VECTOR3_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 
 			PoolVector<Vector3> array;
 			array.resize(len);
 			PoolVector<Vector3>::Write w = array.write();
 			if (sizeof(Vector3) == 12) {
-				f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 3);
+				_get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 3);
 #ifdef BIG_ENDIAN_ENABLED
 				{
 					uint32_t *ptr = (uint32_t *)w.ptr();
@@ -514,13 +628,13 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 		case VARIANT_COLOR_ARRAY: {
 
-			uint32_t len = f->get_32();
+			uint32_t len = _get_32();
 
 			PoolVector<Color> array;
 			array.resize(len);
 			PoolVector<Color>::Write w = array.write();
 			if (sizeof(Color) == 16) {
-				f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 4);
+				_get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 4);
 #ifdef BIG_ENDIAN_ENABLED
 				{
 					uint32_t *ptr = (uint32_t *)w.ptr();
@@ -540,15 +654,15 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 		} break;
 #ifndef DISABLE_DEPRECATED
 		case VARIANT_IMAGE: {
-			uint32_t encoding = f->get_32();
+			uint32_t encoding = _get_32();
 			if (encoding == IMAGE_ENCODING_EMPTY) {
 				r_v = Ref<Image>();
 				break;
 			} else if (encoding == IMAGE_ENCODING_RAW) {
-				uint32_t width = f->get_32();
-				uint32_t height = f->get_32();
-				uint32_t mipmaps = f->get_32();
-				uint32_t format = f->get_32();
+				uint32_t width = _get_32();
+				uint32_t height = _get_32();
+				uint32_t mipmaps = _get_32();
+				uint32_t format = _get_32();
 				const uint32_t format_version_shift = 24;
 				const uint32_t format_version_mask = format_version_shift - 1;
 
@@ -563,12 +677,12 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 
 				Image::Format fmt = Image::Format(format & format_version_mask); //if format changes, we can add a compatibility bit on top
 
-				uint32_t datalen = f->get_32();
+				uint32_t datalen = _get_32();
 
 				PoolVector<uint8_t> imgdata;
 				imgdata.resize(datalen);
 				PoolVector<uint8_t>::Write w = imgdata.write();
-				f->get_buffer(w.ptr(), datalen);
+				_get_buffer(w.ptr(), datalen);
 				_advance_padding(datalen);
 				w.release();
 
@@ -580,9 +694,9 @@ Error ResourceInteractiveLoaderMemory::parse_variant(Variant &r_v)
 			} else {
 				//compressed
 				PoolVector<uint8_t> data;
-				data.resize(f->get_32());
+				data.resize(_get_32());
 				PoolVector<uint8_t>::Write w = data.write();
-				f->get_buffer(w.ptr(), data.size());
+				_get_buffer(w.ptr(), data.size());
 				w.release();
 
 				Ref<Image> image;
@@ -689,7 +803,7 @@ Error ResourceInteractiveLoaderMemory::poll() {
 
 	uint64_t offset = internal_resources[s].offset;
 
-	f->seek(offset);
+	_seek(offset);
 
 	String t = get_unicode_string();
 
@@ -712,13 +826,13 @@ Error ResourceInteractiveLoaderMemory::poll() {
 	r->set_path(path);
 	r->set_subindex(subindex);
 
-	int pc = f->get_32();
+	int pc = _get_32();
 
 	//set properties
 
 	for (int i = 0; i < pc; i++)
 	{
-		StringName name = get_unicode_string();
+		StringName name = get_string_name();
 
 		if (name == StringName()) {
 			error = ERR_FILE_CORRUPT;
@@ -744,6 +858,7 @@ Error ResourceInteractiveLoaderMemory::poll() {
 	if (main) {
 
 		f->close();
+		data = NULL;
 		resource = res;
 		resource->set_as_translation_remapped(translation_remapped);
 		error = ERR_FILE_EOF;
@@ -770,9 +885,22 @@ void ResourceInteractiveLoaderMemory::set_translation_remapped(bool p_remapped)
 
 String ResourceInteractiveLoaderMemory::get_unicode_string()
 {
-	ResourceFormatSaverMemory *saver = ResourceFormatSaverMemory::singleton;
+	uint16_t index = _get_16();
+	ERR_FAIL_INDEX_V_MSG(index, string_elements.size(), String(), "Corrupt state, string index out of range.");
+
+	return string_elements[index]->key();
+}
+
+StringName ResourceInteractiveLoaderMemory::get_string_name()
+{
+	uint16_t index = _get_16();
+	ERR_FAIL_INDEX_V_MSG(index, string_map.size(), StringName(), "Corrupt state, string index out of range.");
+
+	StringName &name = string_map.write[index];
+	if (name == StringName())
+		name = string_elements[index]->key();
 
-	return saver->m_StringElements.get(f->get_16())->key();
+	return name;
 }
 
 void ResourceInteractiveLoaderMemory::get_dependencies(FileAccess *p_f, List<String> *p_dependencies, bool p_add_types) {
@@ -799,7 +927,16 @@ void ResourceInteractiveLoaderMemory::open(FileAccess *p_f) {
 
 	f = p_f;
 
-	uint32_t ext_resources_size = f->get_32();
+	FileAccessTichStore *store = dynamic_cast<FileAccessTichStore *>(f);
+	data = store ? store->GetData() : NULL;
+	data_len = store ? store->get_len() : 0;
+	data_pos = store ? store->get_position() : 0;
+
+	// the table only grows, indices written before now stay valid
+	string_elements = ResourceFormatSaverMemory::singleton->m_StringElements;
+	string_map.resize(string_elements.size());
+
+	uint32_t ext_resources_size = _get_32();
 	for (uint32_t i = 0; i < ext_resources_size; i++) {
 
 		ExtResource er;
@@ -811,22 +948,23 @@ void ResourceInteractiveLoaderMemory::open(FileAccess *p_f) {
 	}
 
 	print_bl("ext resources: " + itos(ext_resources_size));
-	uint32_t int_resources_size = f->get_32();
+	uint32_t int_resources_size = _get_32();
 
 	for (uint32_t i = 0; i < int_resources_size; i++) {
 
 		IntResource ir;
 		ir.path = get_unicode_string();
-		ir.offset = f->get_64();
+		ir.offset = _get_64();
 		internal_resources.push_back(ir);
 	}
 
 	print_bl("int resources: " + itos(int_resources_size));
 
-	if (f->eof_reached()) {
+	if (_eof_reached()) {
 
 		error = ERR_FILE_CORRUPT;
 		f->close();
+		data = NULL;
 		ERR_FAIL_MSG("Premature end of file (EOF): " + local_path + ".");
 	}
 }
@@ -871,6 +1009,8 @@ String ResourceInteractiveLoaderMemory::recognize(FileAccess *p_f) {
 		return "";
 	}
 
+	string_elements = ResourceFormatSaverMemory::singleton->m_StringElements;
+
 	String type = get_unicode_string();
 
 	return type;
@@ -879,6 +1019,9 @@ String ResourceInteractiveLoaderMemory::recognize(FileAccess *p_f) {
 ResourceInteractiveLoaderMemory::ResourceInteractiveLoaderMemory() :
 		translation_remapped(false),
 		f(NULL),
+		data(NULL),
+		data_len(0),
+		data_pos(0),
 		error(OK),
 		stage(0) {
 }
@@ -897,8 +1040,10 @@ Ref<ResourceInteractiveLoader> ResourceFormatLoaderMemory::load_interactive(cons
 	Error err;
 	//FileAccess *f = FileAccess::open(p_path, FileAccess::READ, &err);
 
-	FileAccessMemory* f = memnew(FileAccessMemory);
-	err = f->_open("data", FileAccess::READ);
+	FileAccessTichStore *f = memnew(FileAccessTichStore);
+	err = f->_open(p_path, FileAccess::READ);
+	if (err != OK)
+		memdelete(f);
 
 	ERR_FAIL_COND_V_MSG(err != OK, Ref<ResourceInteractiveLoader>(), "Cannot open file '" + p_path + "'.");
 
@@ -986,10 +1131,10 @@ void ResourceFormatSaverMemoryInstance::_pad_buffer(FileAccess *f, int p_bytes)
 
 void ResourceFormatSaverMemoryInstance::_write_variant(const Variant &p_property, const PropertyInfo &p_hint) {
 
-	write_variant(f, p_property, resource_set, external_resources, p_hint);
+	write_variant(f, p_property, resource_set, external_resources, content_resources, p_hint);
 }
 
-void ResourceFormatSaverMemoryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, const PropertyInfo &p_hint) {
+void ResourceFormatSaverMemoryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, const Map<RES, uint64_t> &content_resources, const PropertyInfo &p_hint) {
 
 	switch (p_property.get_type()) {
 
@@ -1191,7 +1336,14 @@ void ResourceFormatSaverMemoryInstance::write_variant(FileAccess *f, const Varia
 				return; // don't save it
 			}
 
-			if (res->get_path().length() && res->get_path().find("::") == -1) {
+			const Map<RES, uint64_t>::Element *C = content_resources.find(res);
+
+			if (C) {
+				f->store_8(OBJECT_CACHED_RESOURCE);
+				f->store_64(C->get());
+				// a copy taken for the worker stands in for the resource in the tree
+				f->store_64(SceneState::get_captured_source(res->get_instance_id()));
+			} else if (res->get_path().length() && res->get_path().find("::") == -1) {
 				f->store_8(OBJECT_EXTERNAL_RESOURCE_INDEX);
 				f->store_32(external_resources[res]);
 			} else {
@@ -1223,8 +1375,8 @@ void ResourceFormatSaverMemoryInstance::write_variant(FileAccess *f, const Varia
 					continue;
 				*/
 
-				write_variant(f, E->get(), resource_set, external_resources);
-				write_variant(f, d[E->get()], resource_set, external_resources);
+				write_variant(f, E->get(), resource_set, external_resources, content_resources);
+				write_variant(f, d[E->get()], resource_set, external_resources, content_resources);
 			}
 
 		} break;
@@ -1235,7 +1387,7 @@ void ResourceFormatSaverMemoryInstance::write_variant(FileAccess *f, const Varia
 			f->store_32(uint32_t(a.size()));
 			for (int i = 0; i < a.size(); i++) {
 
-				write_variant(f, a[i], resource_set, external_resources);
+				write_variant(f, a[i], resource_set, external_resources, content_resources);
 			}
 
 		} break;
@@ -1354,9 +1506,20 @@ void ResourceFormatSaverMemoryInstance::_find_resources(const Variant &p_variant
 				return;
 			}
 
-			if (resource_set.has(res))
+			if (resource_set.has(res) || content_resources.has(res))
 				return;
 
+			// unchanged sub-resources are shared with the earlier states
+			if (!p_main && TichResourceCache::get_singleton()) {
+				uint64_t hash;
+				if (TichResourceCache::get_singleton()->Store(res, hash)) {
+					// the state's slot keeps the entry alive
+					static_cast<FileAccessTichStore *>(f)->AddCachedResource(hash);
+					content_resources[res] = hash;
+					return;
+				}
+			}
+
 			List<PropertyInfo> property_list;
 
 			res->get_property_list(&property_list);
@@ -1451,10 +1614,13 @@ int ResourceFormatSaverMemoryInstance::add_unicode_string(const String &p_string
 Error ResourceFormatSaverMemoryInstance::save(const String &p_path, const RES &p_resource, uint64_t &bytesWritten, uint32_t p_flags) {
 
 	Error err;
-	FileAccessMemory *file = memnew(FileAccessMemory);
-	err = file->_open("data", FileAccess::WRITE);
+	FileAccessTichStore *file = memnew(FileAccessTichStore);
+	err = file->_open(p_path, FileAccess::WRITE);
 	f = file;
 
+	if (err != OK)
+		memdelete(file);
+
 	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot create file '" + p_path + "'.");
 
 	relative_paths = p_flags & ResourceSaver::FLAG_RELATIVE_PATHS;
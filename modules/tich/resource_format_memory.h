@@ -46,12 +46,20 @@ class ResourceInteractiveLoaderMemory : public ResourceInteractiveLoader {
 
 	FileAccess *f;
 
+	// states in the TichStateStore are decoded straight from their buffer,
+	// anything else goes through `f`
+	const uint8_t *data;
+	uint64_t data_len;
+	uint64_t data_pos;
+
 	uint64_t importmd_ofs;
 
 	Vector<char> str_buf;
 	List<RES> resource_cache;
+	Map<ObjectID, RES> cached_resources; // TichResourceCache resources by the id they were saved with
 
-	//Map<int,StringName> string_map;
+	// the saver's string table as of open(), names are interned on first use
+	Vector<Map<String, int>::Element *> string_elements;
 	Vector<StringName> string_map;
 
 	struct ExtResource {
@@ -69,8 +77,20 @@ class ResourceInteractiveLoaderMemory : public ResourceInteractiveLoader {
 	Vector<IntResource> internal_resources;
 
 	String get_unicode_string();
+	StringName get_string_name();
 	void _advance_padding(uint32_t p_len);
 
+	const uint8_t *_advance(uint64_t p_size);
+	uint8_t _get_8();
+	uint16_t _get_16();
+	uint32_t _get_32();
+	uint64_t _get_64();
+	float _get_float();
+	double _get_double();
+	void _get_buffer(uint8_t *p_dst, uint64_t p_length);
+	void _seek(uint64_t p_position);
+	bool _eof_reached() const;
+
 	Map<String, String> remaps;
 	Error error;
 
@@ -133,6 +153,7 @@ class ResourceFormatSaverMemoryInstance {
 	Vector<StringName> strings;
 
 	Map<RES, int> external_resources;
+	Map<RES, uint64_t> content_resources; // referenced by hash through TichResourceCache
 	List<RES> saved_resources;
 
 	struct Property {
@@ -155,7 +176,7 @@ class ResourceFormatSaverMemoryInstance {
 
 public:
 	Error save(const String &p_path, const RES &p_resource, uint64_t &bytesWritten, uint32_t p_flags = 0);
-	static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, const PropertyInfo &p_hint = PropertyInfo());
+	static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, const Map<RES, uint64_t> &content_resources, const PropertyInfo &p_hint = PropertyInfo());
 };
 
 class ResourceFormatSaverMemory : public ResourceFormatSaver
@@ -1379,6 +1379,69 @@ Error SceneTree::change_scene_to(const Ref<PackedScene> &p_scene) {
 	return OK;
 }
 
+// Like change_scene_to for a tich state, but the live tree is updated to
+// match the state instead of being replaced.
+Error SceneTree::restore_scene_in_place(const Ref<SceneState> &p_state) {
+
+	ERR_FAIL_COND_V(p_state.is_null(), ERR_INVALID_PARAMETER);
+
+	if (!p_state->can_restore_in_place(root))
+		return ERR_UNAVAILABLE;
+
+	call_deferred("_restore_scene", p_state);
+	return OK;
+}
+
+void SceneTree::_restore_scene(const Ref<SceneState> &p_state) {
+
+	if (unlikely(_quit))
+		return;
+
+	ObjectID current_scene_id = current_scene ? current_scene->get_instance_id() : 0;
+
+	Set<Node *> previous_children;
+	for (int i = 0; i < root->get_child_count(); i++)
+		previous_children.insert(root->get_child(i));
+
+	Error err = p_state->restore_in_place(root);
+	if (err != OK)
+		ERR_PRINT("Failed to restore scene in place, Error: " + itos(err));
+
+	// only autoloads that were recreated need their globals registered again
+	for (int i = 0; i < root->get_child_count(); i++)
+	{
+		Node *node = root->get_child(i);
+		if (previous_children.has(node))
+			continue;
+
+		String setting = "autoload/" + node->get_name();
+		if (!ProjectSettings::get_singleton()->has_setting(setting))
+			continue;
+
+		String path = ProjectSettings::get_singleton()->get(setting);
+		if (path.begins_with("*"))
+		{
+			for (int j = 0; j < ScriptServer::get_language_count(); j++)
+			{
+				ScriptServer::get_language(j)->add_global_constant(node->get_name(), node);
+			}
+		}
+	}
+
+	if (!current_scene_id || !ObjectDB::get_instance(current_scene_id))
+	{
+		current_scene = NULL;
+		for (int i = 0; i < root->get_child_count(); i++)
+		{
+			Node *node = root->get_child(i);
+			if (current_scene == NULL || node->get_child_count() > current_scene->get_child_count())
+				current_scene = node;
+		}
+	}
+
+	TichSystem::GetInstance()->OnReadyPost();
+}
+
 Error SceneTree::reload_current_scene() {
 	ERR_FAIL_COND_V(!current_scene, ERR_UNCONFIGURED);
 	String fname = current_scene->get_filename();
@@ -1949,6 +2012,7 @@ void SceneTree::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("reload_current_scene"), &SceneTree::reload_current_scene);
 
 	ClassDB::bind_method(D_METHOD("_change_scene"), &SceneTree::_change_scene);
+	ClassDB::bind_method(D_METHOD("_restore_scene"), &SceneTree::_restore_scene);
 
 	ClassDB::bind_method(D_METHOD("set_multiplayer", "multiplayer"), &SceneTree::set_multiplayer);
 	ClassDB::bind_method(D_METHOD("get_multiplayer"), &SceneTree::get_multiplayer);
@@ -40,6 +40,7 @@
 #include "scene/resources/world_2d.h"
 
 class PackedScene;
+class SceneState;
 class Node;
 class Viewport;
 class Material;
@@ -178,6 +179,7 @@ private:
 	int collision_debug_contacts;
 
 	void _change_scene(Node *p_to);
+	void _restore_scene(const Ref<SceneState> &p_state);
 	//void _call_group(uint32_t p_call_flags,const StringName& p_group,const StringName& p_function,const Variant& p_arg1,const Variant& p_arg2);
 
 	List<Ref<SceneTreeTimer> > timers;
@@ -384,6 +386,7 @@ public:
 	Node *get_current_scene() const;
 	Error change_scene(const String &p_path);
 	Error change_scene_to(const Ref<PackedScene> &p_scene);
+	Error restore_scene_in_place(const Ref<SceneState> &p_state);
 	Error reload_current_scene();
 
 	Ref<SceneTreeTimer> create_timer(float p_delay_sec, bool p_process_pause = true);
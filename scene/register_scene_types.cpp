@@ -226,6 +226,7 @@ static Ref<ResourceFormatLoaderShader> resource_loader_shader;
 void register_scene_types() {
 
 	SceneStringNames::create();
+	SceneState::init_property_cache();
 
 	OS::get_singleton()->yield(); //may take time to init
 
@@ -774,6 +775,8 @@ void unregister_scene_types() {
 
 	clear_default_theme();
 
+	SceneState::finish_property_cache();
+
 	ResourceLoader::remove_resource_format_loader(resource_loader_dynamic_font);
 	resource_loader_dynamic_font.unref();
 
@@ -39,6 +39,7 @@
 #include "scene/gui/control.h"
 #include "scene/main/instance_placeholder.h"
 
+#include "core/os/threaded_array_processor.h"
 #include "scene/main/viewport.h"
 #include "modules/tich/TichInfo.h"
 #include "modules/tich/FunctionProfiler.h"
@@ -50,6 +51,76 @@ bool SceneState::can_instance() const {
 	return nodes.size() > 0;
 }
 
+static bool _has_tich_ref(const Variant &p_value) {
+
+	switch (p_value.get_type()) {
+		case Variant::TICH_REF:
+			return true;
+		case Variant::ARRAY: {
+			Array arr = p_value;
+			for (int i = 0; i < arr.size(); i++) {
+				if (arr[i].get_type() == Variant::TICH_REF)
+					return true;
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dic = p_value;
+			for (int i = 0; i < dic.size(); i++) {
+				if (dic.get_value_at_index(i).get_type() == Variant::TICH_REF)
+					return true;
+			}
+		} break;
+		default:
+			break;
+	}
+
+	return false;
+}
+
+struct NodeType {
+	bool resolved;
+	bool enabled;
+	ClassDB::CreationFunc creation_func;
+};
+
+static bool _resolve_node_type(NodeType &r_type, const StringName &p_class) {
+
+	if (!r_type.resolved) {
+		r_type.enabled = ClassDB::is_class_enabled(p_class);
+		r_type.creation_func = r_type.enabled ? ClassDB::get_creation_func(p_class) : NULL;
+		r_type.resolved = true;
+	}
+
+	return r_type.enabled;
+}
+
+static Node *_create_node(ClassDB::CreationFunc p_creation_func, const StringName &p_type, const Node *p_parent) {
+
+	Object *obj = p_creation_func ? p_creation_func() : NULL;
+	if (!Object::cast_to<Node>(obj)) {
+		if (obj) {
+			memdelete(obj);
+			obj = NULL;
+		}
+		WARN_PRINT(String("Warning node of type " + p_type.operator String() + " does not exist.").ascii().get_data());
+		if (p_parent) {
+			if (Object::cast_to<Spatial>(p_parent)) {
+				obj = memnew(Spatial);
+			} else if (Object::cast_to<Control>(p_parent)) {
+				obj = memnew(Control);
+			} else if (Object::cast_to<Node2D>(p_parent)) {
+				obj = memnew(Node2D);
+			}
+		}
+
+		if (!obj) {
+			obj = memnew(Node);
+		}
+	}
+
+	return Object::cast_to<Node>(obj);
+}
+
 Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	// nodes where instancing failed (because something is missing)
@@ -81,15 +152,27 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 	//Vector<Variant> properties;
 
 
-	struct TichRefNode
+	// properties holding TICH_REFs, resolved in one pass once all nodes exist
+	struct TichRefFixup
 	{
 		int nodeIndex;
-		Map<StringName, Variant> tichRefs;
+		StringName name;
+		Variant value;
 	};
 
-	Vector<TichRefNode> tichRefNodes;
+	Vector<TichRefFixup> tichRefFixups;
 	Vector<Node*> externalNodes;
 
+	// setters and constructors are resolved once, not per node
+	bool fast_restore = p_edit_state == GEN_EDIT_STATE_DISABLED && restore_setter_cache;
+
+	// sized by the names table, which has no bound, so not on the stack
+	Vector<NodeType> node_type_cache;
+	node_type_cache.resize(sname_count);
+	NodeType *node_types = node_type_cache.ptrw();
+	for (int i = 0; i < sname_count; i++)
+		node_types[i].resolved = false;
+
 
 	const NodeData *nd = &nodes[0];
 
@@ -172,31 +255,9 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 				}
 #endif
 			}
-		} else if (ClassDB::is_class_enabled(snames[n.type])) {
+		} else if (n.type >= 0 && n.type < sname_count && _resolve_node_type(node_types[n.type], snames[n.type])) {
 			//node belongs to this scene and must be created
-			Object *obj = ClassDB::instance(snames[n.type]);
-			if (!Object::cast_to<Node>(obj)) {
-				if (obj) {
-					memdelete(obj);
-					obj = NULL;
-				}
-				WARN_PRINT(String("Warning node of type " + snames[n.type].operator String() + " does not exist.").ascii().get_data());
-				if (n.parent >= 0 && n.parent < nc && ret_nodes[n.parent]) {
-					if (Object::cast_to<Spatial>(ret_nodes[n.parent])) {
-						obj = memnew(Spatial);
-					} else if (Object::cast_to<Control>(ret_nodes[n.parent])) {
-						obj = memnew(Control);
-					} else if (Object::cast_to<Node2D>(ret_nodes[n.parent])) {
-						obj = memnew(Node2D);
-					}
-				}
-
-				if (!obj) {
-					obj = memnew(Node);
-				}
-			}
-
-			node = Object::cast_to<Node>(obj);
+			node = _create_node(node_types[n.type].creation_func, snames[n.type], n.parent >= 0 && n.parent < nc ? ret_nodes[n.parent] : NULL);
 
 		} else {
 			//print_line("Class is disabled for: " + itos(n.type));
@@ -213,8 +274,6 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 
 				const NodeData::Property *nprops = &n.properties[0];
 
-				TichRefNode tichRefNode;
-
 				for (int j = 0; j < nprop_count; j++) {
 
 					bool valid;
@@ -224,17 +283,17 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 					const StringName& name = snames[nprops[j].name];
 					Variant value = props[nprops[j].value];
 
-					if (value.get_type() == Variant::Type::TICH_REF)
-					{
-						tichRefNode.tichRefs.insert(name, value);
-					}
-					else if (value.get_type() == Variant::Type::ARRAY)
-					{
-						tichRefNode.tichRefs.insert(name, value);
-					}
-					else if (value.get_type() == Variant::Type::DICTIONARY)
+					if (_has_tich_ref(value))
 					{
-						tichRefNode.tichRefs.insert(name, value);
+						TichRefFixup fixup;
+						fixup.nodeIndex = i;
+						fixup.name = name;
+						fixup.value = value;
+						tichRefFixups.push_back(fixup);
+
+						// set once the referenced node exists
+						if (value.get_type() == Variant::Type::TICH_REF)
+							continue;
 					}
 
 					if (snames[nprops[j].name] == CoreStringNames::get_singleton()->_script) {
@@ -289,14 +348,12 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 						} else if (p_edit_state == GEN_EDIT_STATE_INSTANCE) {
 							value = value.duplicate(true); // Duplicate arrays and dictionaries for the editor
 						}
-						node->set(name, value, &valid);
-					}
-				}
 
-				if (tichRefNode.tichRefs.size() > 0)
-				{
-					tichRefNode.nodeIndex = i;
-					tichRefNodes.push_back(tichRefNode);
+						if (fast_restore && !node->get_script_instance())
+							_restore_property(node, name, value);
+						else
+							node->set(name, value, &valid);
+					}
 				}
 			}
 
@@ -413,57 +470,436 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 	}
 
 
-	Node *node = NULL;
-
-	for (int i = 0; i < tichRefNodes.size(); i++)
+	for (int i = 0; i < tichRefFixups.size(); i++)
 	{
-		const TichRefNode& tichRefNode = tichRefNodes[i];
-		node = ret_nodes[tichRefNode.nodeIndex];
+		const TichRefFixup &fixup = tichRefFixups[i];
+		Node *node = ret_nodes[fixup.nodeIndex];
+		if (!node)
+			continue;
 
-		for (Map<StringName, Variant>::Element *E = tichRefNode.tichRefs.front(); E; E = E->next())
-		{
-			Variant value = E->get();
+		Variant value = _resolve_tich_refs(fixup.value, externalNodes, ret_nodes[0]);
+		node->set(fixup.name, value);
+	}
 
-			if (value.get_type() == Variant::Type::ARRAY)
-			{
-				Array arr = value;
-				for (int j = 0; j < arr.size(); j++)
-				{
-					Variant& element = arr[j];
-					if (element.get_type() == Variant::Type::TICH_REF)
-					{
-						injectTichRefProperty(element, element, externalNodes, ret_nodes[0]);
+	return ret_nodes[0];
+}
+
+static bool _is_in_groups(const Vector<int> &p_groups, const StringName *p_names, const StringName &p_group) {
+
+	for (int i = 0; i < p_groups.size(); i++) {
+		if (p_names[p_groups[i]] == p_group)
+			return true;
+	}
+
+	return false;
+}
+
+static void _get_detached_paths(Node *p_node, const String &p_path, Map<String, Node *> &r_paths) {
+
+	r_paths[p_path] = p_node;
+
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		Node *child = p_node->get_child(i);
+		_get_detached_paths(child, p_path + "/" + child->get_name(), r_paths);
+	}
+}
+
+// Resets the storable properties of a matched node that the state does not
+// hold to the class or script default they had when it was packed.
+void SceneState::_reset_unsaved_properties(Node *p_node, const NodeData &p_data) const {
+
+	Set<StringName> saved;
+	for (int i = 0; i < p_data.properties.size(); i++)
+		saved.insert(names[p_data.properties[i].name]);
+
+	List<PropertyInfo> plist;
+	p_node->get_property_list(&plist);
+	StringName type = p_node->get_class_name();
+	Ref<Script> script = p_node->get_script();
+
+	for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next()) {
+
+		// what a tich save stores, see is_property_to_be_saved()
+		if (!(E->get().usage & (PROPERTY_USAGE_STORAGE | PROPERTY_USAGE_SCRIPT_VARIABLE)))
+			continue;
+
+		PropertyDefault d = _get_class_property_default(type, E->get().name);
+		if (saved.has(d.name))
+			continue;
+
+		if (script.is_valid()) {
+			PropertyDefault scriptDefault = _get_script_property_default(script, d.name);
+			if (scriptDefault.valid)
+				d = scriptDefault;
+		}
+		if (!d.valid)
+			continue;
+
+		bool valid;
+		Variant current = p_node->get(d.name, &valid);
+		if (valid && current.get_type() == d.value.get_type() && current == d.value)
+			continue;
+
+		// the cached default must not be shared with the node
+		Variant value = d.value.duplicate(true);
+		if (restore_setter_cache && !p_node->get_script_instance())
+			_restore_property(p_node, d.name, value);
+		else
+			p_node->set(d.name, value);
+	}
+}
+
+// An in-place restore only knows how to match plain nodes, which is all a
+// tich state contains: saving never references instanced scenes.
+bool SceneState::can_restore_in_place(const Node *p_root) const {
+
+	if (!p_root || nodes.size() == 0 || base_scene_idx >= 0)
+		return false;
+
+	const NodeData &root = nodes[0];
+	if (root.type < 0 || root.type >= names.size() || p_root->get_class_name() != names[root.type])
+		return false;
+
+	for (int i = 0; i < nodes.size(); i++) {
+		if (nodes[i].instance >= 0)
+			return false;
+	}
+
+	return true;
+}
+
+// Restores the state onto the live tree under `p_root` instead of building a
+// new one. Nodes are matched by path and class, only properties that differ
+// from the state, or from their default when the state leaves them out, are
+// written, and only nodes missing from either side are created or freed.
+// New subtrees are built detached and enter the tree once they are complete.
+Error SceneState::restore_in_place(Node *p_root) const {
+
+	ERR_FAIL_COND_V(!can_restore_in_place(p_root), ERR_UNAVAILABLE);
+
+	int nc = nodes.size();
+	const NodeData *nd = nodes.ptr();
+
+	const StringName *snames = NULL;
+	int sname_count = names.size();
+	if (sname_count)
+		snames = &names[0];
+
+	const Variant *props = NULL;
+	int prop_count = variants.size();
+	if (prop_count)
+		props = &variants[0];
+
+	struct TichRefFixup {
+		int nodeIndex;
+		StringName name;
+		Variant value;
+	};
+
+	struct PendingChild {
+		Node *node;
+		Node *parent;
+	};
+
+	Vector<TichRefFixup> tichRefFixups;
+	Vector<PendingChild> pendingChildren;
+	Vector<Node *> externalNodes;
+	List<Node *> strays;
+	Set<Node *> matched;
+	Map<Ref<Resource>, Ref<Resource> > resources_local_to_scene;
+
+	Node **ret_nodes = (Node **)alloca(sizeof(Node *) * nc);
+	bool *created = (bool *)alloca(sizeof(bool) * nc);
+
+	for (int i = 0; i < nc; i++) {
+
+		const NodeData &n = nd[i];
+
+		ret_nodes[i] = NULL;
+		created[i] = false;
+
+		Node *parent = NULL;
+		int parent_idx = -1;
+		if (i > 0 && n.parent >= 0) {
+			if (n.parent & FLAG_ID_IS_PATH) {
+				parent = p_root->get_node_or_null(node_paths[n.parent & FLAG_MASK]);
+			} else {
+				ERR_FAIL_INDEX_V(n.parent, i, ERR_FILE_CORRUPT);
+				parent_idx = n.parent;
+				parent = ret_nodes[parent_idx];
+			}
+		}
+
+		bool typed = n.type >= 0 && n.type < sname_count;
+		ERR_FAIL_INDEX_V(n.name, sname_count, ERR_FILE_CORRUPT);
+		const StringName &node_name = snames[n.name];
+
+		Node *node = NULL;
+
+		if (i == 0) {
+			node = p_root;
+		} else if (parent && (parent_idx < 0 || !created[parent_idx])) {
+			// a live parent, look for the node where the state had it
+			Node *live = parent->_get_child_by_name(node_name);
+			if (live && (n.type == TYPE_INSTANCED || (typed && live->get_class_name() == snames[n.type]))) {
+				node = live;
+			} else if (live) {
+				parent->remove_child(live);
+				memdelete(live);
+			}
+		}
+
+		if (!node && n.type != TYPE_INSTANCED && typed && ClassDB::is_class_enabled(snames[n.type])) {
+			node = _create_node(ClassDB::get_creation_func(snames[n.type]), snames[n.type], parent);
+			created[i] = true;
+		}
+
+		if (!node)
+			continue;
+
+		ret_nodes[i] = node;
+		if (!created[i])
+			matched.insert(node);
+
+		//properties
+		for (int j = 0; j < n.properties.size(); j++) {
+
+			const NodeData::Property &prop = n.properties[j];
+			ERR_FAIL_INDEX_V(prop.name, sname_count, ERR_FILE_CORRUPT);
+			ERR_FAIL_INDEX_V(prop.value, prop_count, ERR_FILE_CORRUPT);
+
+			const StringName &name = snames[prop.name];
+			Variant value = props[prop.value];
+
+			if (_has_tich_ref(value)) {
+				TichRefFixup fixup;
+				fixup.nodeIndex = i;
+				fixup.name = name;
+				fixup.value = value;
+				tichRefFixups.push_back(fixup);
+				continue;
+			}
+
+			if (value.get_type() == Variant::OBJECT) {
+				Ref<Resource> res = value;
+				if (res.is_valid() && res->is_local_to_scene()) {
+					Map<Ref<Resource>, Ref<Resource> >::Element *E = resources_local_to_scene.find(res);
+					if (E) {
+						value = E->get();
+					} else {
+						Ref<Resource> local_dupe = res->duplicate_for_local_scene(p_root, resources_local_to_scene);
+						resources_local_to_scene[res] = local_dupe;
+						value = local_dupe;
 					}
 				}
-				node->set(E->key(), arr);
 			}
-			else if (value.get_type() == Variant::Type::DICTIONARY)
-			{
-				Dictionary dic = value;
-				for (int j = 0; j < dic.size(); j++)
-				{
-					Variant &element = dic.get_value_at_index(j);
-					if (element.get_type() == Variant::Type::TICH_REF)
-					{
-						injectTichRefProperty(element, element, externalNodes, ret_nodes[0]);
 
-						dic[dic.get_key_at_index(j)] = element;
-					}
+			if (!created[i]) {
+				bool valid;
+				Variant current = node->get(name, &valid);
+				if (valid && current.get_type() == value.get_type() && current == value)
+					continue;
+			}
+
+			if (name == CoreStringNames::get_singleton()->_script) {
+				//keep the script variables, as instance() does
+				List<Pair<StringName, Variant> > old_state;
+				if (node->get_script_instance()) {
+					node->get_script_instance()->get_property_state(old_state);
+				}
+
+				node->set(name, value);
+
+				for (List<Pair<StringName, Variant> >::Element *E = old_state.front(); E; E = E->next()) {
+					node->set(E->get().first, E->get().second);
 				}
-				node->set(E->key(), dic);
+			} else if (restore_setter_cache && !node->get_script_instance()) {
+				_restore_property(node, name, value);
+			} else {
+				node->set(name, value);
+			}
+		}
+
+		// pack leaves out properties at their default, a live node may hold
+		// another value for them
+		if (!created[i])
+			_reset_unsaved_properties(node, n);
+
+		//groups
+		for (int j = 0; j < n.groups.size(); j++) {
+			ERR_FAIL_INDEX_V(n.groups[j], sname_count, ERR_FILE_CORRUPT);
+			node->add_to_group(snames[n.groups[j]], true);
+		}
+
+		if (!created[i]) {
+			List<Node::GroupInfo> groups;
+			node->get_groups(&groups);
+			for (List<Node::GroupInfo>::Element *E = groups.front(); E; E = E->next()) {
+				if (E->get().persistent && !_is_in_groups(n.groups, snames, E->get().name))
+					node->remove_from_group(E->get().name);
 			}
+			continue;
+		}
+
+		//parenthood, new nodes under a live parent wait until their subtree is built
+		if (!parent) {
+			node->_set_name_nocheck(node_name);
+			if (String(node_name).begins_with("_"))
+				externalNodes.push_back(node);
 			else
+				strays.push_back(node);
+		} else if (parent_idx >= 0 && created[parent_idx]) {
+			parent->_add_child_nocheck(node, node_name);
+		} else {
+			node->_set_name_nocheck(node_name);
+			PendingChild pending;
+			pending.node = node;
+			pending.parent = parent;
+			pendingChildren.push_back(pending);
+		}
+
+		if (n.owner >= 0 && !(n.owner & FLAG_ID_IS_PATH) && n.owner < nc && ret_nodes[n.owner])
+			node->_set_owner_nocheck(ret_nodes[n.owner]);
+	}
+
+	// free what the state does not have, nodes it would not have saved stay
+	for (int i = 0; i < nc; i++) {
+
+		Node *node = ret_nodes[i];
+		if (!node || created[i])
+			continue;
+
+		for (int j = node->get_child_count() - 1; j >= 0; j--) {
+			Node *child = node->get_child(j);
+			if (child->get_owner() == p_root && !matched.has(child)) {
+				node->remove_child(child);
+				memdelete(child);
+			}
+		}
+	}
+
+	for (Map<Ref<Resource>, Ref<Resource> >::Element *E = resources_local_to_scene.front(); E; E = E->next()) {
+		E->get()->setup_local_to_scene();
+	}
+
+	//connections, live nodes keep theirs
+	for (int i = 0; i < connections.size(); i++) {
+
+		const ConnectionData &c = connections[i];
+
+		Node *cfrom = (c.from & FLAG_ID_IS_PATH) ? p_root->get_node_or_null(node_paths[c.from & FLAG_MASK]) : (c.from < nc ? ret_nodes[c.from] : NULL);
+		Node *cto = (c.to & FLAG_ID_IS_PATH) ? p_root->get_node_or_null(node_paths[c.to & FLAG_MASK]) : (c.to < nc ? ret_nodes[c.to] : NULL);
+
+		if (!cfrom || !cto || cfrom->is_connected(snames[c.signal], cto, snames[c.method]))
+			continue;
+
+		Vector<Variant> binds;
+		binds.resize(c.binds.size());
+		for (int j = 0; j < c.binds.size(); j++)
+			binds.write[j] = props[c.binds[j]];
+
+		cfrom->connect(snames[c.signal], cto, snames[c.method], binds, CONNECT_PERSIST | c.flags);
+	}
+
+	//references, the detached subtrees are found by the path they will have
+	Map<String, Node *> detachedNodes;
+	for (int i = 0; i < pendingChildren.size(); i++) {
+
+		const PendingChild &pending = pendingChildren[i];
+		String base = pending.parent == p_root ? String() : pending.parent->get_path_tich_ref() + "/";
+		_get_detached_paths(pending.node, base + pending.node->get_name(), detachedNodes);
+	}
+
+	for (int i = 0; i < tichRefFixups.size(); i++) {
+
+		const TichRefFixup &fixup = tichRefFixups[i];
+		Node *node = ret_nodes[fixup.nodeIndex];
+
+		Variant value = _resolve_tich_refs(fixup.value, externalNodes, p_root, &detachedNodes);
+
+		if (!created[fixup.nodeIndex]) {
+			bool valid;
+			Variant current = node->get(fixup.name, &valid);
+			if (valid && current.get_type() == value.get_type() && current == value)
+				continue;
+		}
+
+		node->set(fixup.name, value);
+	}
+
+	//enter the tree, children keep the order of the state
+	for (int i = 0; i < pendingChildren.size(); i++) {
+
+		const PendingChild &pending = pendingChildren[i];
+		pending.parent->add_child(pending.node);
+	}
+
+	int *child_pos = (int *)alloca(sizeof(int) * nc);
+	for (int i = 0; i < nc; i++)
+		child_pos[i] = 0;
+
+	for (int i = 1; i < nc; i++) {
+
+		int parent_idx = nd[i].parent;
+		if (!ret_nodes[i] || parent_idx < 0 || (parent_idx & FLAG_ID_IS_PATH) || created[parent_idx])
+			continue;
+
+		Node *parent = ret_nodes[parent_idx];
+		if (!parent || ret_nodes[i]->get_parent() != parent)
+			continue;
+
+		int pos = child_pos[parent_idx]++;
+		if (ret_nodes[i]->get_index() != pos)
+			parent->move_child(ret_nodes[i], pos);
+	}
+
+	while (strays.size()) {
+		memdelete(strays.front()->get());
+		strays.pop_front();
+	}
+
+	return OK;
+}
+
+// Returns `p_value` with its TICH_REFs replaced by the nodes they point to.
+// Containers are resolved on a copy, the state keeps its references.
+Variant SceneState::_resolve_tich_refs(const Variant &p_value, const Vector<Node *> &externalNodes, const Node *root, const Map<String, Node *> *detachedNodes) const {
+
+	if (p_value.get_type() == Variant::Type::ARRAY)
+	{
+		Array arr = Array(p_value).duplicate();
+		for (int j = 0; j < arr.size(); j++)
+		{
+			Variant element = arr[j];
+			if (element.get_type() == Variant::Type::TICH_REF)
+			{
+				injectTichRefProperty(element, element, externalNodes, root, detachedNodes);
+				arr[j] = element;
+			}
+		}
+		return arr;
+	}
+	else if (p_value.get_type() == Variant::Type::DICTIONARY)
+	{
+		Dictionary dic = Dictionary(p_value).duplicate();
+		for (int j = 0; j < dic.size(); j++)
+		{
+			Variant element = dic.get_value_at_index(j);
+			if (element.get_type() == Variant::Type::TICH_REF)
 			{
-				injectTichRefProperty(value, value, externalNodes, ret_nodes[0]);
-				node->set(E->key(), value);
+				injectTichRefProperty(element, element, externalNodes, root, detachedNodes);
+				dic[dic.get_key_at_index(j)] = element;
 			}
 		}
+		return dic;
 	}
 
-	return ret_nodes[0];
+	Variant value = p_value;
+	injectTichRefProperty(value, value, externalNodes, root, detachedNodes);
+	return value;
 }
 
-void SceneState::injectTichRefProperty(Variant &retVariant, String path, const Vector<Node *> &externalNodes, const Node *root) const {
+void SceneState::injectTichRefProperty(Variant &retVariant, String path, const Vector<Node *> &externalNodes, const Node *root, const Map<String, Node *> *detachedNodes) const {
 	bool isWeakRef = false;
 
 	if (path.begins_with("#"))
@@ -497,6 +933,14 @@ void SceneState::injectTichRefProperty(Variant &retVariant, String path, const V
 			retVariant = root->get_node_or_null(path);
 		}
 
+		// nodes created by an in-place restore are not in the tree yet
+		if (retVariant.get_type() == Variant::Type::NIL && detachedNodes)
+		{
+			const Map<String, Node *>::Element *E = detachedNodes->find(path);
+			if (E)
+				retVariant = E->get();
+		}
+
 		ERR_FAIL_COND_MSG(retVariant.get_type() == Variant::Type::NIL, "TichRef Node not found: " + path + ".");
 	}
 	else
@@ -532,7 +976,7 @@ static int _vm_get_variant(const Variant &p_variant, HashMap<Variant, int, Varia
 	return idx;
 }
 
-Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, NameMap &name_map, VariantMap &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map, Set<Node *> &externalNodes) {
+Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, NameMap &name_map, VariantMap &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map, Set<Node *> &externalNodes, bool p_children) {
 
 	// this function handles all the work related to properly packing scenes, be it
 	// instanced or inherited.
@@ -576,6 +1020,11 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 
 	bool instanced_by_owner = true;
 
+	// instance states cache the paths they are queried for, and may be
+	// shared by the subtrees of a parallel pack
+	if (pack_lock)
+		pack_lock->lock();
+
 	{
 		Node *n = p_node;
 
@@ -609,6 +1058,9 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 							//must instance ourselves
 							Ref<PackedScene> instance = ResourceLoader::load(p_node->get_filename());
 							if (!instance.is_valid()) {
+								if (pack_lock)
+									pack_lock->unlock();
+								FUNCTION_PROFILER_END("SceneState::_parse_node() - Init");
 								return ERR_CANT_OPEN;
 							}
 							nd.instance = _vm_get_variant(instance, variant_map);
@@ -636,47 +1088,184 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 		}
 	}
 
+	if (pack_lock)
+		pack_lock->unlock();
+
 	FUNCTION_PROFILER_END("SceneState::_parse_node() - Init");
 	FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - Property");
 	// all setup, we then proceed to check all properties for the node
 	// and save the ones that are worth saving
 
-	FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - get_property_list");
-	List<PropertyInfo> plist;
-	p_node->get_property_list(&plist);
-	StringName type = p_node->get_class();
-	FUNCTION_PROFILER_END("SceneState::_parse_node() - get_property_list");
+	// a change tracked node re-reads only the properties written since its
+	// last pack. A native setter may change other native properties, so a
+	// write to one re-reads them all, script variables only change alone
+	Ref<Script> script = p_node->get_script();
+	TrackedNodeProperties cached;
+	bool tracking = tracked_node_cache && p_node->is_change_tracking();
+	bool hasCached = tracking && _get_tracked_node_properties(p_node, cached) && cached.script == (script.is_valid() ? script->get_instance_id() : 0);
+	bool trackable = tracking;
+
+	TrackedNodeProperties tracked;
+	tracked.version = p_node->get_change_version();
+	tracked.script = script.is_valid() ? script->get_instance_id() : 0;
+	tracked.saving = TichInfo::IsSaving();
+	tracked.reread = false;
+
+	Set<StringName> changed;
+	bool nativeChanged = false;
+	if (hasCached && cached.version != tracked.version)
+	{
+		List<StringName> changedList;
+		p_node->get_changed_properties(cached.version, &changedList);
 
+		Set<StringName> scriptVariables;
+		for (int i = 0; i < cached.properties.size(); i++)
+		{
+			if (cached.properties[i].script_variable)
+				scriptVariables.insert(cached.properties[i].property);
+		}
 
-	Variant value;
-	String name;
-	bool isExternalNode;
-	bool isWeakRef;
+		for (List<StringName>::Element *E = changedList.front(); E; E = E->next())
+		{
+			changed.insert(E->get());
+			if (!scriptVariables.has(E->get()))
+				nativeChanged = true;
+		}
+	}
 
-	for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next())
+	List<PropertyInfo> plist;
+	if (hasCached && cached.version == tracked.version && !cached.reread)
 	{
-		FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - is_property_to_be_saved1");
-		bool save = is_property_to_be_saved(p_node, E->get(), name, value, isExternalNode, isWeakRef);
-		FUNCTION_PROFILER_END("SceneState::_parse_node() - is_property_to_be_saved1");
+		// nothing was written to the node since, the cached entry stays current
+		for (int i = 0; i < cached.properties.size(); i++)
+		{
+			const TrackedProperty &property = cached.properties[i];
+			if (!property.saved)
+				continue;
+
+			NodeData::Property prop;
+			prop.name = _nm_get_string(property.property, name_map);
+			prop.value = _vm_get_variant(property.value, variant_map);
+			nd.properties.push_back(prop);
+		}
+		trackable = false;
+	}
+	else
+	{
+		FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - get_property_list");
+		p_node->get_property_list(&plist);
+		FUNCTION_PROFILER_END("SceneState::_parse_node() - get_property_list");
+	}
+	StringName type = p_node->get_class_name();
+
+	Variant value;
+	String name;
+	bool isExternalNode;
+	bool isWeakRef;
+
+	int index = 0;
+	for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next(), index++)
+	{
+		bool scriptVariable = E->get().usage & PROPERTY_USAGE_SCRIPT_VARIABLE;
+
+		if (hasCached && index < cached.properties.size())
+		{
+			const TrackedProperty &property = cached.properties[index];
+			bool reuse = property.property == E->get().name && !property.reread && (scriptVariable || !nativeChanged);
+			if (reuse && !changed.empty())
+				reuse = !changed.has(property.property);
+
+			if (reuse)
+			{
+				if (trackable)
+					tracked.properties.push_back(property);
+
+				if (property.saved)
+				{
+					NodeData::Property prop;
+					prop.name = _nm_get_string(property.property, name_map);
+					prop.value = _vm_get_variant(property.value, variant_map);
+					nd.properties.push_back(prop);
+				}
+				continue;
+			}
+		}
+
+		TrackedProperty record;
+		record.property = E->get().name;
+		record.script_variable = scriptVariable;
+		record.saved = false;
+		record.reread = false;
+
+		FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - is_property_to_be_saved1");
+		PropertyDefault classDefault = _get_class_property_default(type, E->get().name);
+		bool save = is_property_to_be_saved(p_node, E->get(), classDefault.name, name, value, isExternalNode, isWeakRef);
+		FUNCTION_PROFILER_END("SceneState::_parse_node() - is_property_to_be_saved1");
 		if (!save)
+		{
+			if (trackable)
+				tracked.properties.push_back(record);
 			continue;
+		}
 
 		if (isExternalNode)
 		{
+			// external nodes are renamed in the order they are found, which
+			// only the serial pack can reproduce
+			if (pack_lock)
+			{
+				FUNCTION_PROFILER_END("SceneState::_parse_node() - Property");
+				return ERR_SKIP;
+			}
+
 			FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - _parse_external_node");
 			Error err = _parse_external_node(value, name, value, isWeakRef, externalNodes, name_map, variant_map, node_map);
 			FUNCTION_PROFILER_END("SceneState::_parse_node() - _parse_external_node");
 			if (err)
+			{
+				FUNCTION_PROFILER_END("SceneState::_parse_node() - Property");
 				return err;
+			}
+
+			// depends on the order other nodes are packed in
+			trackable = false;
 		}
 
-		bool isDefault = is_default_value(type, p_node, value, name);
+		bool isDefault = is_default_value(classDefault, p_node, value);
+
+		// scripts append to their arrays and dictionaries in place, without
+		// a write to the member
+		Variant::Type valueType = value.get_type();
+		record.reread = scriptVariable && (valueType == Variant::DICTIONARY || valueType >= Variant::ARRAY);
 
 		FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - is_property_to_be_saved2");
-		save = is_property_value_to_be_saved(pack_state_stack, E->get(), value, isDefault);
+		if (pack_lock && pack_state_stack.size())
+		{
+			pack_lock->lock();
+			save = is_property_value_to_be_saved(pack_state_stack, E->get(), value, isDefault);
+			pack_lock->unlock();
+		}
+		else
+		{
+			save = is_property_value_to_be_saved(pack_state_stack, E->get(), value, isDefault);
+		}
 		FUNCTION_PROFILER_END("SceneState::_parse_node() - is_property_to_be_saved2");
 		if (!save)
+		{
+			if (trackable)
+				tracked.properties.push_back(record);
 			continue;
+		}
+
+		if (trackable)
+		{
+			// references are saved as paths, which change with the referenced node
+			if (_has_tich_ref(value))
+				record.reread = true;
+			record.saved = true;
+			record.value = value;
+			tracked.properties.push_back(record);
+		}
 
 		NodeData::Property prop;
 		prop.name = _nm_get_string(name, name_map);
@@ -684,6 +1273,13 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 		nd.properties.push_back(prop);
 	}
 
+	if (trackable)
+	{
+		for (int i = 0; i < tracked.properties.size() && !tracked.reread; i++)
+			tracked.reread = tracked.properties[i].reread;
+		_set_tracked_node_properties(p_node, tracked);
+	}
+
 	FUNCTION_PROFILER_END("SceneState::_parse_node() - Property");
 	FUNCTION_PROFILER_BEGIN("SceneState::_parse_node() - Group");
 	// save the groups this node is into
@@ -702,6 +1298,8 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 		*/
 
 		bool skip = false;
+		if (pack_lock && pack_state_stack.size())
+			pack_lock->lock();
 		for (List<PackState>::Element *F = pack_state_stack.front(); F; F = F->next()) {
 			//check all levels of pack to see if the group was added somewhere
 			const PackState &ps = F->get();
@@ -710,6 +1308,8 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 				break;
 			}
 		}
+		if (pack_lock && pack_state_stack.size())
+			pack_lock->unlock();
 
 		if (skip)
 			continue;
@@ -788,6 +1388,9 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 
 	FUNCTION_PROFILER_END("SceneState::_parse_node() - End");
 
+	if (!p_children)
+		return OK;
+
 	for (int i = 0; i < p_node->get_child_count(); i++) {
 
 		Node *c = p_node->get_child(i);
@@ -799,7 +1402,7 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Nam
 	return OK;
 }
 
-bool SceneState::is_property_to_be_saved(Node *node, const PropertyInfo &propertyInfo, String &name, Variant &value, bool &isExternal, bool& isWeakRef)
+bool SceneState::is_property_to_be_saved(Node *node, const PropertyInfo &propertyInfo, const StringName &propertyName, String &name, Variant &value, bool &isExternal, bool& isWeakRef)
 {
 	isExternal = false;
 	isWeakRef = false;
@@ -818,7 +1421,7 @@ bool SceneState::is_property_to_be_saved(Node *node, const PropertyInfo &propert
 			}
 
 			name = propertyInfo.name;
-			value = node->get(propertyInfo.name);
+			value = node->get(propertyName);
 
 			if ((Node *)value)
 			{
@@ -826,7 +1429,14 @@ bool SceneState::is_property_to_be_saved(Node *node, const PropertyInfo &propert
 				isExternal = !nodeValue->is_inside_tree();
 
 				if (!isExternal)
+				{
+					// the path is cached on the node, which other subtrees may reference too
+					if (pack_lock)
+						pack_lock->lock();
 					value = Variant(nodeValue->get_path_tich_ref(), true);
+					if (pack_lock)
+						pack_lock->unlock();
+				}
 			}
 			else
 			{
@@ -843,7 +1453,13 @@ bool SceneState::is_property_to_be_saved(Node *node, const PropertyInfo &propert
 							isExternal = !nodeValue->is_inside_tree();
 
 							if (!isExternal)
+							{
+								if (pack_lock)
+									pack_lock->lock();
 								value = Variant("#" + nodeValue->get_path_tich_ref(), true);
+								if (pack_lock)
+									pack_lock->unlock();
+							}
 						}
 						else if (refValue.get_type() == Variant::Type::NIL)
 						{
@@ -858,30 +1474,266 @@ bool SceneState::is_property_to_be_saved(Node *node, const PropertyInfo &propert
 	else
 	{
 		name = propertyInfo.name;
-		value = node->get(propertyInfo.name);
+		value = node->get(propertyName);
 	}
 
 	return true;
 }
 
-bool SceneState::is_default_value(const StringName& type, Node *node, const Variant &value, const String &name)
+bool SceneState::is_default_value(const PropertyDefault &classDefault, Node *node, const Variant &value)
 {
 	bool isdefault = false;
-	Variant default_value = ClassDB::class_get_default_property_value(type, name);
 
-	if (default_value.get_type() != Variant::NIL)
+	if (classDefault.valid)
 	{
-		isdefault = bool(Variant::evaluate(Variant::OP_EQUAL, value, default_value));
+		isdefault = bool(Variant::evaluate(Variant::OP_EQUAL, value, classDefault.value));
 	}
 
-	Ref<Script> script = node->get_script();
-	if (!isdefault && script.is_valid() && script->get_property_default_value(name, default_value))
+	if (!isdefault)
 	{
-		isdefault = bool(Variant::evaluate(Variant::OP_EQUAL, value, default_value));
+		Ref<Script> script = node->get_script();
+		if (script.is_valid())
+		{
+			PropertyDefault scriptDefault = _get_script_property_default(script, classDefault.name);
+			if (scriptDefault.valid)
+				isdefault = bool(Variant::evaluate(Variant::OP_EQUAL, value, scriptDefault.value));
+		}
 	}
 	return isdefault;
 }
 
+SceneState::PropertyDefault SceneState::_get_class_property_default(const StringName &p_type, const String &p_name)
+{
+	if (class_property_cache)
+	{
+		RWLockRead r(property_cache_lock);
+
+		const HashMap<String, PropertyDefault> *defaults = class_property_cache->getptr(p_type);
+		if (defaults)
+		{
+			const PropertyDefault *d = defaults->getptr(p_name);
+			if (d)
+				return *d;
+		}
+	}
+
+	PropertyDefault d;
+	d.name = p_name;
+
+	if (!class_property_cache)
+	{
+		d.value = ClassDB::class_get_default_property_value(p_type, d.name);
+		d.valid = d.value.get_type() != Variant::NIL;
+		return d;
+	}
+
+	// ClassDB fills its default value table lazily without locking, keep
+	// parallel packs from doing that concurrently
+	RWLockWrite w(property_cache_lock);
+	d.value = ClassDB::class_get_default_property_value(p_type, d.name);
+	d.valid = d.value.get_type() != Variant::NIL;
+	(*class_property_cache)[p_type][p_name] = d;
+
+	return d;
+}
+
+SceneState::PropertyDefault SceneState::_get_script_property_default(const Ref<Script> &p_script, const StringName &p_name)
+{
+	ObjectID id = p_script->get_instance_id();
+
+	if (script_property_cache)
+	{
+		RWLockRead r(property_cache_lock);
+
+		const HashMap<StringName, PropertyDefault> *defaults = script_property_cache->getptr(id);
+		if (defaults)
+		{
+			const PropertyDefault *d = defaults->getptr(p_name);
+			if (d)
+				return *d;
+		}
+	}
+
+	PropertyDefault d;
+	d.name = p_name;
+
+	if (!script_property_cache)
+	{
+		d.valid = p_script->get_property_default_value(p_name, d.value);
+		return d;
+	}
+
+	RWLockWrite w(property_cache_lock);
+	d.valid = p_script->get_property_default_value(p_name, d.value);
+	(*script_property_cache)[id][p_name] = d;
+
+	return d;
+}
+
+SceneState::RestoreSetter SceneState::_get_restore_setter(const StringName &p_class, const StringName &p_property)
+{
+	{
+		RWLockRead r(property_cache_lock);
+
+		const HashMap<StringName, RestoreSetter> *setters = restore_setter_cache->getptr(p_class);
+		if (setters)
+		{
+			const RestoreSetter *s = setters->getptr(p_property);
+			if (s)
+				return *s;
+		}
+	}
+
+	RestoreSetter s;
+	s.mode = RestoreSetter::SET_OBJECT;
+	s.method = NULL;
+	s.index = -1;
+
+	bool found = false;
+	int index = ClassDB::get_property_index(p_class, p_property, &found);
+	if (found)
+	{
+		StringName setter = ClassDB::get_property_setter(p_class, p_property);
+		if (setter == StringName())
+		{
+			s.mode = RestoreSetter::SET_NONE;
+		}
+		else
+		{
+			s.method = ClassDB::get_method(p_class, setter);
+			if (s.method)
+			{
+				s.mode = RestoreSetter::SET_BIND;
+				s.index = index;
+			}
+		}
+	}
+
+	RWLockWrite w(property_cache_lock);
+	(*restore_setter_cache)[p_class][p_property] = s;
+
+	return s;
+}
+
+// Same as Object::set for nodes without a script instance, minus the
+// string-keyed walk through ClassDB for every property.
+void SceneState::_restore_property(Node *p_node, const StringName &p_property, const Variant &p_value)
+{
+	RestoreSetter s = _get_restore_setter(p_node->get_class_name(), p_property);
+
+	Variant::CallError ce;
+	switch (s.mode)
+	{
+		case RestoreSetter::SET_BIND:
+			if (unlikely(p_node->is_change_tracking()))
+				p_node->mark_property_changed(p_property);
+
+			if (s.index >= 0)
+			{
+				Variant index = s.index;
+				const Variant *args[2] = { &index, &p_value };
+				s.method->call(p_node, args, 2, ce);
+			}
+			else
+			{
+				const Variant *args[1] = { &p_value };
+				s.method->call(p_node, args, 1, ce);
+			}
+			break;
+		case RestoreSetter::SET_NONE:
+			break;
+		default:
+			p_node->set(p_property, p_value);
+			break;
+	}
+}
+
+RWLock *SceneState::property_cache_lock = NULL;
+HashMap<StringName, HashMap<StringName, SceneState::RestoreSetter> > *SceneState::restore_setter_cache = NULL;
+HashMap<StringName, HashMap<String, SceneState::PropertyDefault> > *SceneState::class_property_cache = NULL;
+HashMap<ObjectID, HashMap<StringName, SceneState::PropertyDefault> > *SceneState::script_property_cache = NULL;
+HashMap<ObjectID, SceneState::TrackedNodeProperties> *SceneState::tracked_node_cache = NULL;
+HashMap<ObjectID, Ref<Resource> > *SceneState::captured_copies = NULL;
+HashMap<ObjectID, ObjectID> *SceneState::captured_sources = NULL;
+uint32_t SceneState::captured_prune_size = 1024;
+uint32_t SceneState::tracked_node_prune_size = 1024;
+
+void SceneState::init_property_cache()
+{
+	property_cache_lock = RWLock::create();
+	class_property_cache = memnew((HashMap<StringName, HashMap<String, PropertyDefault> >));
+	script_property_cache = memnew((HashMap<ObjectID, HashMap<StringName, PropertyDefault> >));
+	restore_setter_cache = memnew((HashMap<StringName, HashMap<StringName, RestoreSetter> >));
+	tracked_node_cache = memnew((HashMap<ObjectID, TrackedNodeProperties>));
+	captured_copies = memnew((HashMap<ObjectID, Ref<Resource> >));
+	captured_sources = memnew((HashMap<ObjectID, ObjectID>));
+}
+
+void SceneState::finish_property_cache()
+{
+	memdelete(class_property_cache);
+	memdelete(script_property_cache);
+	memdelete(restore_setter_cache);
+	memdelete(tracked_node_cache);
+	memdelete(captured_copies);
+	memdelete(captured_sources);
+	memdelete(property_cache_lock);
+	class_property_cache = NULL;
+	script_property_cache = NULL;
+	restore_setter_cache = NULL;
+	tracked_node_cache = NULL;
+	captured_copies = NULL;
+	captured_sources = NULL;
+	property_cache_lock = NULL;
+}
+
+// Script defaults change when a script is reloaded, and reloading a base
+// script changes the defaults of every script extending it.
+void SceneState::clear_property_cache()
+{
+	if (!script_property_cache)
+		return;
+
+	RWLockWrite w(property_cache_lock);
+	script_property_cache->clear();
+	tracked_node_cache->clear();
+}
+
+bool SceneState::_get_tracked_node_properties(Node *p_node, TrackedNodeProperties &r_properties)
+{
+	RWLockRead r(property_cache_lock);
+
+	const TrackedNodeProperties *properties = tracked_node_cache->getptr(p_node->get_instance_id());
+	if (!properties || properties->saving != TichInfo::IsSaving())
+		return false;
+
+	r_properties = *properties;
+	return true;
+}
+
+void SceneState::_set_tracked_node_properties(Node *p_node, const TrackedNodeProperties &p_properties)
+{
+	RWLockWrite w(property_cache_lock);
+
+	(*tracked_node_cache)[p_node->get_instance_id()] = p_properties;
+
+	if (tracked_node_cache->size() < tracked_node_prune_size)
+		return;
+
+	// entries of freed nodes are never hit again
+	List<ObjectID> freed;
+	const ObjectID *K = NULL;
+	while ((K = tracked_node_cache->next(K)))
+	{
+		if (!ObjectDB::get_instance(*K))
+			freed.push_back(*K);
+	}
+	for (List<ObjectID>::Element *E = freed.front(); E; E = E->next())
+		tracked_node_cache->erase(E->get());
+
+	tracked_node_prune_size = MAX(1024u, tracked_node_cache->size() * 2);
+}
+
 bool SceneState::is_property_value_to_be_saved(List<PackState> &pack_state_stack, const PropertyInfo &propertyInfo, const Variant &value, bool isDefault)
 {
 	if (pack_state_stack.size())
@@ -976,14 +1828,15 @@ Error SceneState::_parse_external_node(Node *node, const String& varName, Varian
 
 	List<PropertyInfo> plist;
 	node->get_property_list(&plist);
-	StringName type = node->get_class();
+	StringName type = node->get_class_name();
 	Variant value;
 	String name;
 	bool isExternalNode;
 
 	for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next())
 	{
-		if (!is_property_to_be_saved(node, E->get(), name, value, isWeakRef, isExternalNode))
+		PropertyDefault classDefault = _get_class_property_default(type, E->get().name);
+		if (!is_property_to_be_saved(node, E->get(), classDefault.name, name, value, isWeakRef, isExternalNode))
 			continue;
 
 		if (isExternalNode)
@@ -993,7 +1846,7 @@ Error SceneState::_parse_external_node(Node *node, const String& varName, Varian
 				return err;
 		}
 
-		bool isDefault = is_default_value(type, node, value, name);
+		bool isDefault = is_default_value(classDefault, node, value);
 
 		if (isDefault)
 			continue;
@@ -1207,6 +2060,180 @@ Error SceneState::_parse_connections(Node *p_owner, Node *p_node, NameMap &name_
 	return OK;
 }
 
+static bool _has_script_instance(const Node *p_node) {
+
+	if (p_node->get_script_instance())
+		return true;
+
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		if (_has_script_instance(p_node->get_child(i)))
+			return true;
+	}
+
+	return false;
+}
+
+void SceneState::_parse_subtree(uint32_t p_index, ParallelPack *p_pack) {
+
+	SubtreePack &sp = p_pack->subtrees[p_pack->threaded ? p_pack->threaded[p_index] : p_index];
+
+	// node 0 is a placeholder for the parent, so subtree indices start at 1
+	sp.state->nodes.resize(1);
+
+	Set<Node *> external_nodes;
+	int parent = p_pack->parent == NO_PARENT_SAVED ? NO_PARENT_SAVED : 0;
+	sp.error = sp.state->_parse_node(p_pack->owner, sp.node, parent, sp.name_map, sp.variant_map, sp.node_map, sp.nodepath_map, external_nodes);
+}
+
+template <class K, class M>
+static void _get_table_order(const M &p_map, Vector<K> &r_order) {
+
+	r_order.resize(p_map.size());
+	for (typename M::Element *E = p_map.front(); E; E = E->next()) {
+		r_order.write[E->get()] = E->key();
+	}
+}
+
+// Parses the children of the owner in parallel and merges the subtrees in
+// child order. Every table index is handed out in first-use order, so
+// replaying each subtree's tables in the order it filled them reproduces
+// the indices of the serial pack exactly. Returns ERR_SKIP when a subtree
+// needs the serial pack.
+Error SceneState::_parse_children_parallel(Node *p_owner, int p_parent_idx, NameMap &name_map, VariantMap &variant_map, NodeMap &node_map, Map<Node *, int> &nodepath_map) {
+
+	int count = p_owner->get_child_count();
+
+	Vector<SubtreePack> subtrees;
+	subtrees.resize(count);
+
+	Mutex *lock = Mutex::create();
+
+	for (int i = 0; i < count; i++) {
+		SubtreePack &sp = subtrees.write[i];
+		sp.node = p_owner->get_child(i);
+		sp.state.instance();
+		sp.state->pack_lock = lock;
+		sp.error = OK;
+	}
+
+	// script getters run on the calling thread, the script languages keep
+	// their call stacks per language, not per thread
+	Vector<uint32_t> threaded;
+	Vector<uint32_t> scripted;
+	for (int i = 0; i < count; i++) {
+		if (_has_script_instance(subtrees[i].node))
+			scripted.push_back(i);
+		else
+			threaded.push_back(i);
+	}
+
+	ParallelPack pack;
+	pack.owner = p_owner;
+	pack.parent = p_parent_idx;
+	pack.subtrees = subtrees.ptrw();
+	pack.threaded = threaded.ptrw();
+
+	thread_process_array(threaded.size(), this, &SceneState::_parse_subtree, &pack);
+
+	pack.threaded = NULL;
+	for (int i = 0; i < scripted.size(); i++) {
+		_parse_subtree(scripted[i], &pack);
+	}
+
+	memdelete(lock);
+
+	for (int i = 0; i < count; i++) {
+		if (subtrees[i].error != OK)
+			return subtrees[i].error;
+	}
+
+	for (int i = 0; i < count; i++) {
+
+		const SubtreePack &sp = subtrees[i];
+
+		Vector<StringName> sub_names;
+		_get_table_order(sp.name_map, sub_names);
+
+		Vector<int> name_remap;
+		name_remap.resize(sub_names.size());
+		for (int j = 0; j < sub_names.size(); j++) {
+			name_remap.write[j] = _nm_get_string(sub_names[j], name_map);
+		}
+
+		Vector<Variant> sub_variants;
+		sub_variants.resize(sp.variant_map.size());
+		const Variant *K = NULL;
+		while ((K = sp.variant_map.next(K))) {
+			sub_variants.write[*sp.variant_map.getptr(*K)] = *K;
+		}
+
+		Vector<int> variant_remap;
+		variant_remap.resize(sub_variants.size());
+		for (int j = 0; j < sub_variants.size(); j++) {
+			variant_remap.write[j] = _vm_get_variant(sub_variants[j], variant_map);
+		}
+
+		Vector<Node *> sub_paths;
+		_get_table_order(sp.nodepath_map, sub_paths);
+
+		Vector<int> path_remap;
+		path_remap.resize(sub_paths.size());
+		for (int j = 0; j < sub_paths.size(); j++) {
+			if (nodepath_map.has(sub_paths[j])) {
+				path_remap.write[j] = nodepath_map[sub_paths[j]];
+			} else {
+				int sidx = nodepath_map.size();
+				nodepath_map[sub_paths[j]] = sidx;
+				path_remap.write[j] = sidx;
+			}
+		}
+
+		// subtree node j lands at offset + j
+		int offset = nodes.size() - 1;
+		const Vector<NodeData> &sub_nodes = sp.state->nodes;
+
+		for (int j = 1; j < sub_nodes.size(); j++) {
+
+			NodeData nd = sub_nodes[j];
+
+			nd.name = name_remap[nd.name];
+			if (nd.type != TYPE_INSTANCED)
+				nd.type = name_remap[nd.type];
+			if (nd.instance >= 0)
+				nd.instance = variant_remap[nd.instance & FLAG_MASK] | (nd.instance & FLAG_INSTANCE_IS_PLACEHOLDER);
+
+			if (nd.parent & FLAG_ID_IS_PATH)
+				nd.parent = FLAG_ID_IS_PATH | path_remap[nd.parent & FLAG_MASK];
+			else if (nd.parent == 0)
+				nd.parent = p_parent_idx;
+			else
+				nd.parent += offset;
+
+			for (int k = 0; k < nd.properties.size(); k++) {
+				nd.properties.write[k].name = name_remap[nd.properties[k].name];
+				nd.properties.write[k].value = variant_remap[nd.properties[k].value];
+			}
+
+			for (int k = 0; k < nd.groups.size(); k++) {
+				nd.groups.write[k] = name_remap[nd.groups[k]];
+			}
+
+			nodes.push_back(nd);
+		}
+
+		for (const NodeMap::Element *E = sp.node_map.front(); E; E = E->next()) {
+			node_map[E->key()] = E->get() + offset;
+		}
+
+		const Vector<NodePath> &sub_editable = sp.state->editable_instances;
+		for (int j = 0; j < sub_editable.size(); j++) {
+			editable_instances.push_back(sub_editable[j]);
+		}
+	}
+
+	return OK;
+}
+
 Error SceneState::pack(Node *p_scene) {
 	ERR_FAIL_NULL_V(p_scene, ERR_INVALID_PARAMETER);
 
@@ -1236,7 +2263,33 @@ Error SceneState::pack(Node *p_scene) {
 	FUNCTION_PROFILER_END("SceneState::pack() - Init");
 
 	FUNCTION_PROFILER_BEGIN("SceneState::pack() - Node");
-	Error err = _parse_node(scene, scene, -1, name_map, variant_map, node_map, nodepath_map, nodesOutsideTree);
+	Error err = ERR_SKIP;
+
+	if (parallel_pack && scene->get_child_count() > 1) {
+
+		VariantMap base_variant_map = variant_map;
+
+		err = _parse_node(scene, scene, -1, name_map, variant_map, node_map, nodepath_map, nodesOutsideTree, false);
+		if (err == OK) {
+			int parent = node_map.has(scene) ? node_map[scene] : int(NO_PARENT_SAVED);
+			err = _parse_children_parallel(scene, parent, name_map, variant_map, node_map, nodepath_map);
+		}
+
+		if (err == ERR_SKIP) {
+			// start over on the serial path
+			nodes.clear();
+			editable_instances.clear();
+			name_map.clear();
+			variant_map = base_variant_map;
+			node_map.clear();
+			nodepath_map.clear();
+			nodesOutsideTree.clear();
+		}
+	}
+
+	if (err == ERR_SKIP)
+		err = _parse_node(scene, scene, -1, name_map, variant_map, node_map, nodepath_map, nodesOutsideTree);
+
 	if (err) {
 		clear();
 		ERR_FAIL_V(err);
@@ -1413,6 +2466,20 @@ void SceneState::set_disable_placeholders(bool p_disable) {
 	disable_placeholders = p_disable;
 }
 
+bool SceneState::parallel_pack = false;
+
+// Packs the children of the scene root on worker threads. Property getters,
+// including script ones, then run off the main thread.
+void SceneState::set_parallel_pack(bool p_enable) {
+
+	parallel_pack = p_enable;
+}
+
+bool SceneState::is_parallel_pack() {
+
+	return parallel_pack;
+}
+
 bool SceneState::is_connection(int p_node, const StringName &p_signal, int p_to_node, const StringName &p_to_method) const {
 
 	ERR_FAIL_COND_V(p_node < 0, false);
@@ -1981,6 +3048,704 @@ void SceneState::add_editable_instance(const NodePath &p_path) {
 	editable_instances.push_back(p_path);
 }
 
+void SceneState::_get_node_keys(Vector<String> &r_keys) const {
+
+	// a key identifies a node across snapshots of the same tree, it is the
+	// path of the node inside the packed state (parents are always packed first)
+	r_keys.resize(nodes.size());
+
+	for (int i = 0; i < nodes.size(); i++) {
+
+		const NodeData &nd = nodes[i];
+		String name = names[nd.name];
+
+		if (nd.parent < 0) {
+			//root or node outside of the tree
+			r_keys.write[i] = name;
+		} else if (nd.parent & FLAG_ID_IS_PATH) {
+			r_keys.write[i] = "@" + String(node_paths[nd.parent & FLAG_MASK]) + "/" + name;
+		} else if (nd.parent < i) {
+			r_keys.write[i] = r_keys[nd.parent] + "/" + name;
+		} else {
+			r_keys.write[i] = "#" + itos(i) + "/" + name;
+		}
+	}
+}
+
+// Built-in resources can be edited in place, so the same object says nothing
+// about its contents. Values holding one are always written to the delta.
+static bool _has_built_in_resource(const Variant &p_value) {
+
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			Resource *res = Object::cast_to<Resource>(p_value);
+			return res && (res->get_path() == "" || res->get_path().find("::") != -1);
+		}
+		case Variant::ARRAY: {
+			Array array = p_value;
+			for (int i = 0; i < array.size(); i++) {
+				if (_has_built_in_resource(array[i]))
+					return true;
+			}
+			return false;
+		}
+		case Variant::DICTIONARY: {
+			Dictionary dict = p_value;
+			List<Variant> keys;
+			dict.get_key_list(&keys);
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				if (_has_built_in_resource(E->get()) || _has_built_in_resource(dict[E->get()]))
+					return true;
+			}
+			return false;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+bool SceneState::_is_node_header_equal(const NodeData &p_node, const SceneState &p_base, const NodeData &p_base_node, const Vector<int> &p_base_to_new) const {
+
+	// nodes referenced by path are always written in full, the path table is not diffed
+	if ((p_node.parent >= 0 && (p_node.parent & FLAG_ID_IS_PATH)) || (p_base_node.parent >= 0 && (p_base_node.parent & FLAG_ID_IS_PATH)))
+		return false;
+	if ((p_node.owner >= 0 && (p_node.owner & FLAG_ID_IS_PATH)) || (p_base_node.owner >= 0 && (p_base_node.owner & FLAG_ID_IS_PATH)))
+		return false;
+
+	if (p_base_node.parent < 0 || p_node.parent < 0) {
+		if (p_base_node.parent != p_node.parent)
+			return false;
+	} else if (p_base_to_new[p_base_node.parent] != p_node.parent) {
+		return false;
+	}
+
+	if (p_base_node.owner < 0 || p_node.owner < 0) {
+		if (p_base_node.owner != p_node.owner)
+			return false;
+	} else if (p_base_to_new[p_base_node.owner] != p_node.owner) {
+		return false;
+	}
+
+	if (p_base_node.type == TYPE_INSTANCED || p_node.type == TYPE_INSTANCED) {
+		if (p_base_node.type != p_node.type)
+			return false;
+	} else if (p_base.names[p_base_node.type] != names[p_node.type]) {
+		return false;
+	}
+
+	if (p_base.names[p_base_node.name] != names[p_node.name] || p_base_node.index != p_node.index)
+		return false;
+
+	if (p_base_node.instance < 0 || p_node.instance < 0)
+		return p_base_node.instance == p_node.instance;
+
+	if ((p_base_node.instance & FLAG_INSTANCE_IS_PLACEHOLDER) != (p_node.instance & FLAG_INSTANCE_IS_PLACEHOLDER))
+		return false;
+
+	return p_base.variants[p_base_node.instance & FLAG_MASK].hash_compare(variants[p_node.instance & FLAG_MASK]);
+}
+
+Dictionary SceneState::get_delta(const Ref<SceneState> &p_base) const {
+
+	// the delta stores, for every node of this state, the node of the base it
+	// comes from plus whatever changed since. unchanged properties and groups
+	// are not stored at all. names and values get their own (small) tables
+
+	ERR_FAIL_COND_V(p_base.is_null(), Dictionary());
+
+	const SceneState &base = *p_base.ptr();
+
+	Vector<String> keys;
+	_get_node_keys(keys);
+	Vector<String> base_keys;
+	base._get_node_keys(base_keys);
+
+	HashMap<String, int> base_key_map;
+	for (int i = 0; i < base_keys.size(); i++) {
+		base_key_map[base_keys[i]] = i;
+	}
+
+	Vector<int> new_to_base;
+	new_to_base.resize(nodes.size());
+	Vector<int> base_to_new;
+	base_to_new.resize(base.nodes.size());
+	for (int i = 0; i < base_to_new.size(); i++) {
+		base_to_new.write[i] = -1;
+	}
+
+	for (int i = 0; i < nodes.size(); i++) {
+
+		const int *bidx = base_key_map.getptr(keys[i]);
+		if (bidx && base_to_new[*bidx] == -1) {
+			new_to_base.write[i] = *bidx;
+			base_to_new.write[*bidx] = i;
+		} else {
+			new_to_base.write[i] = -1;
+		}
+	}
+
+	NameMap name_map;
+	VariantMap variant_map;
+	Vector<int> rnodes;
+
+	for (int i = 0; i < nodes.size(); i++) {
+
+		const NodeData &nd = nodes[i];
+		int bidx = new_to_base[i];
+		const NodeData *bnd = bidx >= 0 ? &base.nodes[bidx] : NULL;
+
+		int flags = 0;
+
+		if (!bnd || !_is_node_header_equal(nd, base, *bnd, base_to_new)) {
+			flags |= DELTA_HEADER;
+		}
+
+		if (!bnd || bnd->groups.size() != nd.groups.size()) {
+			flags |= DELTA_GROUPS;
+		} else {
+			for (int j = 0; j < nd.groups.size(); j++) {
+				if (base.names[bnd->groups[j]] != names[nd.groups[j]]) {
+					flags |= DELTA_GROUPS;
+					break;
+				}
+			}
+		}
+
+		rnodes.push_back(bidx);
+		rnodes.push_back(flags);
+
+		if (flags & DELTA_HEADER) {
+			rnodes.push_back(nd.parent);
+			rnodes.push_back(nd.owner);
+			rnodes.push_back(nd.type == TYPE_INSTANCED ? int(TYPE_INSTANCED) : _nm_get_string(names[nd.type], name_map));
+			rnodes.push_back(_nm_get_string(names[nd.name], name_map));
+			if (nd.instance >= 0) {
+				rnodes.push_back(_vm_get_variant(variants[nd.instance & FLAG_MASK], variant_map) | (nd.instance & FLAG_INSTANCE_IS_PLACEHOLDER));
+			} else {
+				rnodes.push_back(nd.instance);
+			}
+			rnodes.push_back(nd.index);
+		}
+
+		if (flags & DELTA_GROUPS) {
+			rnodes.push_back(nd.groups.size());
+			for (int j = 0; j < nd.groups.size(); j++) {
+				rnodes.push_back(_nm_get_string(names[nd.groups[j]], name_map));
+			}
+		}
+
+		// changed or added properties
+		int count_pos = rnodes.size();
+		int changed = 0;
+		rnodes.push_back(0);
+
+		for (int j = 0; j < nd.properties.size(); j++) {
+
+			const StringName &pname = names[nd.properties[j].name];
+			const Variant &pvalue = variants[nd.properties[j].value];
+
+			if (bnd && !_has_built_in_resource(pvalue)) {
+				bool same = false;
+				for (int k = 0; k < bnd->properties.size(); k++) {
+					if (base.names[bnd->properties[k].name] == pname) {
+						same = base.variants[bnd->properties[k].value].hash_compare(pvalue);
+						break;
+					}
+				}
+				if (same)
+					continue;
+			}
+
+			rnodes.push_back(_nm_get_string(pname, name_map));
+			rnodes.push_back(_vm_get_variant(pvalue, variant_map));
+			changed++;
+		}
+		rnodes.write[count_pos] = changed;
+
+		// properties that went back to their defaults
+		count_pos = rnodes.size();
+		int removed = 0;
+		rnodes.push_back(0);
+
+		if (bnd) {
+			for (int k = 0; k < bnd->properties.size(); k++) {
+
+				const StringName &pname = base.names[bnd->properties[k].name];
+				bool found = false;
+				for (int j = 0; j < nd.properties.size(); j++) {
+					if (names[nd.properties[j].name] == pname) {
+						found = true;
+						break;
+					}
+				}
+				if (found)
+					continue;
+
+				rnodes.push_back(_nm_get_string(pname, name_map));
+				removed++;
+			}
+		}
+		rnodes.write[count_pos] = removed;
+	}
+
+	// connections are small and get stored whole
+	Vector<int> rconns;
+	for (int i = 0; i < connections.size(); i++) {
+
+		const ConnectionData &cd = connections[i];
+		rconns.push_back(cd.from);
+		rconns.push_back(cd.to);
+		rconns.push_back(_nm_get_string(names[cd.signal], name_map));
+		rconns.push_back(_nm_get_string(names[cd.method], name_map));
+		rconns.push_back(cd.flags);
+		rconns.push_back(cd.binds.size());
+		for (int j = 0; j < cd.binds.size(); j++)
+			rconns.push_back(_vm_get_variant(variants[cd.binds[j]], variant_map));
+	}
+
+	Dictionary d;
+
+	if (base_scene_idx >= 0) {
+		d["base_scene"] = _vm_get_variant(variants[base_scene_idx], variant_map);
+	}
+
+	PoolVector<String> rnames;
+	rnames.resize(name_map.size());
+	if (name_map.size()) {
+		PoolVector<String>::Write w = rnames.write();
+		for (NameMap::Element *E = name_map.front(); E; E = E->next()) {
+			w[E->get()] = E->key();
+		}
+	}
+
+	Array rvariants;
+	rvariants.resize(variant_map.size());
+	const Variant *K = NULL;
+	while ((K = variant_map.next(K))) {
+		rvariants[variant_map[*K]] = *K;
+	}
+
+	Array rnode_paths;
+	rnode_paths.resize(node_paths.size());
+	for (int i = 0; i < node_paths.size(); i++) {
+		rnode_paths[i] = node_paths[i];
+	}
+
+	Array reditable_instances;
+	reditable_instances.resize(editable_instances.size());
+	for (int i = 0; i < editable_instances.size(); i++) {
+		reditable_instances[i] = editable_instances[i];
+	}
+
+	d["names"] = rnames;
+	d["variants"] = rvariants;
+	d["node_count"] = nodes.size();
+	d["nodes"] = rnodes;
+	d["conn_count"] = connections.size();
+	d["conns"] = rconns;
+	d["node_paths"] = rnode_paths;
+	d["editable_instances"] = reditable_instances;
+	d["version"] = DELTA_VERSION;
+
+	return d;
+}
+
+Error SceneState::apply_delta(const Ref<SceneState> &p_base, const Dictionary &p_delta) {
+
+	ERR_FAIL_COND_V(p_base.is_null(), ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(!p_delta.has("names"), ERR_INVALID_DATA);
+	ERR_FAIL_COND_V(!p_delta.has("variants"), ERR_INVALID_DATA);
+	ERR_FAIL_COND_V(!p_delta.has("node_count"), ERR_INVALID_DATA);
+	ERR_FAIL_COND_V(!p_delta.has("nodes"), ERR_INVALID_DATA);
+	ERR_FAIL_COND_V(!p_delta.has("conn_count"), ERR_INVALID_DATA);
+	ERR_FAIL_COND_V(!p_delta.has("conns"), ERR_INVALID_DATA);
+
+	int version = p_delta.has("version") ? int(p_delta["version"]) : 1;
+	ERR_FAIL_COND_V_MSG(version > DELTA_VERSION, ERR_FILE_UNRECOGNIZED, "Delta format version too new.");
+
+	const SceneState &base = *p_base.ptr();
+
+	clear();
+
+	// base tables are reused as they are (copy on write), delta tables go after them
+	names = base.names;
+	variants = base.variants;
+	const int name_ofs = names.size();
+	const int variant_ofs = variants.size();
+
+	PoolVector<String> dnames = p_delta["names"];
+	if (dnames.size()) {
+		PoolVector<String>::Read r = dnames.read();
+		for (int i = 0; i < dnames.size(); i++)
+			names.push_back(r[i]);
+	}
+
+	Array dvariants = p_delta["variants"];
+	for (int i = 0; i < dvariants.size(); i++) {
+		variants.push_back(dvariants[i]);
+	}
+
+	const int node_count = p_delta["node_count"];
+	const PoolVector<int> dnodes = p_delta["nodes"];
+	// DELTA_READ bounds reads by read_len, set for each stream
+	int read_len = dnodes.size();
+
+#define DELTA_READ(m_var)                                     \
+	if (idx >= read_len) {                                    \
+		clear();                                              \
+		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Delta truncated."); \
+	}                                                         \
+	m_var = r[idx++];
+
+	Vector<int> base_to_new;
+	base_to_new.resize(base.nodes.size());
+	for (int i = 0; i < base_to_new.size(); i++) {
+		base_to_new.write[i] = -1;
+	}
+
+	nodes.resize(node_count);
+	if (node_count) {
+		PoolVector<int>::Read r = dnodes.read();
+		int idx = 0;
+
+		for (int i = 0; i < node_count; i++) {
+
+			NodeData &nd = nodes.write[i];
+			int bidx, flags;
+			DELTA_READ(bidx);
+			DELTA_READ(flags);
+
+			if (bidx >= 0) {
+				if (bidx >= base.nodes.size()) {
+					clear();
+					ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Delta references a node missing from its base.");
+				}
+				const NodeData &bnd = base.nodes[bidx];
+				nd = bnd;
+				base_to_new.write[bidx] = i;
+
+				if (!(flags & DELTA_HEADER)) {
+					// parents and owners come before their children, so they are mapped already
+					if (bnd.parent >= 0)
+						nd.parent = base_to_new[bnd.parent];
+					if (bnd.owner >= 0)
+						nd.owner = base_to_new[bnd.owner];
+				}
+			} else if (!(flags & DELTA_HEADER)) {
+				clear();
+				ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Delta adds a node without header.");
+			}
+
+			if (flags & DELTA_HEADER) {
+				DELTA_READ(nd.parent);
+				DELTA_READ(nd.owner);
+				DELTA_READ(nd.type);
+				if (nd.type != TYPE_INSTANCED)
+					nd.type += name_ofs;
+				DELTA_READ(nd.name);
+				nd.name += name_ofs;
+				DELTA_READ(nd.instance);
+				if (nd.instance >= 0)
+					nd.instance = ((nd.instance & FLAG_MASK) + variant_ofs) | (nd.instance & FLAG_INSTANCE_IS_PLACEHOLDER);
+				DELTA_READ(nd.index);
+			}
+
+			if (flags & DELTA_GROUPS) {
+				int gc;
+				DELTA_READ(gc);
+				nd.groups.resize(gc);
+				for (int j = 0; j < gc; j++) {
+					DELTA_READ(nd.groups.write[j]);
+					nd.groups.write[j] += name_ofs;
+				}
+			}
+
+			int changed;
+			DELTA_READ(changed);
+			for (int j = 0; j < changed; j++) {
+
+				NodeData::Property prop;
+				DELTA_READ(prop.name);
+				DELTA_READ(prop.value);
+				prop.name += name_ofs;
+				prop.value += variant_ofs;
+
+				bool found = false;
+				for (int k = 0; k < nd.properties.size(); k++) {
+					if (names[nd.properties[k].name] == names[prop.name]) {
+						nd.properties.write[k].value = prop.value;
+						found = true;
+						break;
+					}
+				}
+				if (!found)
+					nd.properties.push_back(prop);
+			}
+
+			int removed;
+			DELTA_READ(removed);
+			for (int j = 0; j < removed; j++) {
+
+				int rname;
+				DELTA_READ(rname);
+				rname += name_ofs;
+
+				for (int k = 0; k < nd.properties.size(); k++) {
+					if (names[nd.properties[k].name] == names[rname]) {
+						nd.properties.remove(k);
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	const int conn_count = p_delta["conn_count"];
+	const PoolVector<int> dconns = p_delta["conns"];
+
+	connections.resize(conn_count);
+	if (conn_count) {
+		PoolVector<int>::Read r = dconns.read();
+		read_len = dconns.size();
+		int idx = 0;
+
+		for (int i = 0; i < conn_count; i++) {
+
+			ConnectionData &cd = connections.write[i];
+			DELTA_READ(cd.from);
+			DELTA_READ(cd.to);
+			DELTA_READ(cd.signal);
+			DELTA_READ(cd.method);
+			DELTA_READ(cd.flags);
+			cd.signal += name_ofs;
+			cd.method += name_ofs;
+
+			int bc;
+			DELTA_READ(bc);
+			cd.binds.resize(bc);
+			for (int j = 0; j < bc; j++) {
+				DELTA_READ(cd.binds.write[j]);
+				cd.binds.write[j] += variant_ofs;
+			}
+		}
+	}
+
+#undef DELTA_READ
+
+	Array np = p_delta.has("node_paths") ? Array(p_delta["node_paths"]) : Array();
+	node_paths.resize(np.size());
+	for (int i = 0; i < np.size(); i++) {
+		node_paths.write[i] = np[i];
+	}
+
+	Array ei = p_delta.has("editable_instances") ? Array(p_delta["editable_instances"]) : Array();
+	editable_instances.resize(ei.size());
+	for (int i = 0; i < ei.size(); i++) {
+		editable_instances.write[i] = ei[i];
+	}
+
+	if (p_delta.has("base_scene")) {
+		base_scene_idx = int(p_delta["base_scene"]) + variant_ofs;
+	}
+
+	path = base.path;
+
+	return OK;
+}
+
+// Copies the built-in resources in p_value, with the containers holding
+// them. Each resource is copied once, so shared ones stay shared.
+Variant SceneState::_capture_built_in_resources(const Variant &p_value, Map<Ref<Resource>, Ref<Resource> > &r_captured) {
+
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			RES res = p_value;
+			if (res.is_null() || (res->get_path() != "" && res->get_path().find("::") == -1))
+				return p_value;
+			if (Object::cast_to<Script>(res.ptr()))
+				return p_value; // built-in scripts don't change at run time
+
+			Map<Ref<Resource>, Ref<Resource> >::Element *C = r_captured.find(res);
+			if (C)
+				return C->get();
+
+			RES previous;
+			if (captured_copies) {
+				RWLockRead r(property_cache_lock);
+				const Ref<Resource> *copy = captured_copies->getptr(res->get_instance_id());
+				if (copy)
+					previous = *copy;
+			}
+
+			if (previous.is_valid()) {
+				r_captured[res] = previous; // before its sub-resources, so cycles end here
+				if (_is_capture_current(res, previous, r_captured))
+					return previous;
+			}
+
+			RES copy = res->duplicate();
+			r_captured[res] = copy;
+
+			List<PropertyInfo> plist;
+			copy->get_property_list(&plist);
+			for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next()) {
+
+				if (!(E->get().usage & PROPERTY_USAGE_STORAGE))
+					continue;
+				Variant::Type type = E->get().type;
+				if (type == Variant::OBJECT || type == Variant::ARRAY || type == Variant::DICTIONARY || type == Variant::NIL)
+					copy->set(E->get().name, _capture_built_in_resources(copy->get(E->get().name), r_captured));
+			}
+
+			if (captured_copies) {
+				RWLockWrite w(property_cache_lock);
+				(*captured_copies)[res->get_instance_id()] = copy;
+				(*captured_sources)[copy->get_instance_id()] = res->get_instance_id();
+				_prune_captured_copies();
+			}
+			return copy;
+		}
+		case Variant::ARRAY: {
+			Array array = p_value;
+			Array copy;
+			copy.resize(array.size());
+			for (int i = 0; i < array.size(); i++)
+				copy[i] = _capture_built_in_resources(array[i], r_captured);
+			return copy;
+		}
+		case Variant::DICTIONARY: {
+			Dictionary dict = p_value;
+			Dictionary copy;
+			for (int i = 0; i < dict.size(); i++)
+				copy[_capture_built_in_resources(dict.get_key_at_index(i), r_captured)] = _capture_built_in_resources(dict.get_value_at_index(i), r_captured);
+			return copy;
+		}
+		default: {
+			return p_value;
+		}
+	}
+}
+
+// Whether the copy an earlier capture made of p_resource still has its
+// content, with sub-resources compared by what they are captured as now.
+bool SceneState::_is_capture_current(const Ref<Resource> &p_resource, const Ref<Resource> &p_copy, Map<Ref<Resource>, Ref<Resource> > &r_captured) {
+
+	if (p_resource->get_class_name() != p_copy->get_class_name())
+		return false;
+
+	List<PropertyInfo> plist;
+	p_resource->get_property_list(&plist);
+	List<PropertyInfo> copy_plist;
+	p_copy->get_property_list(&copy_plist);
+	if (plist.size() != copy_plist.size())
+		return false;
+
+	for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next()) {
+
+		if (!(E->get().usage & PROPERTY_USAGE_STORAGE))
+			continue;
+
+		bool valid;
+		Variant copy = p_copy->get(E->get().name, &valid);
+		if (!valid || !_is_captured_value(p_resource->get(E->get().name), copy, r_captured))
+			return false;
+	}
+
+	return true;
+}
+
+bool SceneState::_is_captured_value(const Variant &p_value, const Variant &p_copy, Map<Ref<Resource>, Ref<Resource> > &r_captured) {
+
+	if (p_value.get_type() != p_copy.get_type())
+		return false;
+
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			return _capture_built_in_resources(p_value, r_captured).operator Object *() == p_copy.operator Object *();
+		}
+		case Variant::ARRAY: {
+			Array array = p_value;
+			Array copy = p_copy;
+			if (array.size() != copy.size())
+				return false;
+			for (int i = 0; i < array.size(); i++) {
+				if (!_is_captured_value(array[i], copy[i], r_captured))
+					return false;
+			}
+			return true;
+		}
+		case Variant::DICTIONARY: {
+			Dictionary dict = p_value;
+			Dictionary copy = p_copy;
+			if (dict.size() != copy.size())
+				return false;
+			for (int i = 0; i < dict.size(); i++) {
+				if (!_is_captured_value(dict.get_key_at_index(i), copy.get_key_at_index(i), r_captured) || !_is_captured_value(dict.get_value_at_index(i), copy.get_value_at_index(i), r_captured))
+					return false;
+			}
+			return true;
+		}
+		default: {
+			return p_value == p_copy;
+		}
+	}
+}
+
+// Copies of freed resources are never reused, sources are kept while their
+// copy is alive, the saver may still ask for them.
+void SceneState::_prune_captured_copies() {
+
+	if (captured_copies->size() + captured_sources->size() < captured_prune_size)
+		return;
+
+	List<ObjectID> freed;
+	const ObjectID *K = NULL;
+	while ((K = captured_copies->next(K))) {
+		if (!ObjectDB::get_instance(*K))
+			freed.push_back(*K);
+	}
+	for (List<ObjectID>::Element *E = freed.front(); E; E = E->next())
+		captured_copies->erase(E->get());
+
+	freed.clear();
+	K = NULL;
+	while ((K = captured_sources->next(K))) {
+		if (!ObjectDB::get_instance(*K))
+			freed.push_back(*K);
+	}
+	for (List<ObjectID>::Element *E = freed.front(); E; E = E->next())
+		captured_sources->erase(E->get());
+
+	captured_prune_size = MAX(1024u, (captured_copies->size() + captured_sources->size()) * 2);
+}
+
+ObjectID SceneState::get_captured_source(ObjectID p_copy) {
+
+	if (!captured_sources)
+		return p_copy;
+
+	RWLockRead r(property_cache_lock);
+	const ObjectID *source = captured_sources->getptr(p_copy);
+	return source ? *source : p_copy;
+}
+
+void SceneState::make_variants_unique() {
+
+	// arrays, dictionaries and built-in resources are shared with the nodes
+	// they were packed from, copy them so the state can be serialized while
+	// the tree keeps changing. Resources unchanged since an earlier capture
+	// share the copy taken then.
+	Map<Ref<Resource>, Ref<Resource> > captured;
+	for (int i = 0; i < variants.size(); i++) {
+
+		Variant::Type type = variants[i].get_type();
+		if (type == Variant::ARRAY || type == Variant::DICTIONARY || type == Variant::OBJECT) {
+			variants.write[i] = _capture_built_in_resources(variants[i], captured);
+		}
+	}
+}
+
 PoolVector<String> SceneState::_get_node_groups(int p_idx) const {
 
 	Vector<StringName> groups = get_node_groups(p_idx);
@@ -2026,6 +3791,7 @@ SceneState::SceneState() {
 
 	base_scene_idx = -1;
 	last_modified_time = 0;
+	pack_lock = NULL;
 }
 
 ////////////////
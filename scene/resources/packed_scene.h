@@ -31,6 +31,7 @@
 #ifndef PACKED_SCENE_H
 #define PACKED_SCENE_H
 
+#include "core/os/rw_lock.h"
 #include "core/resource.h"
 #include "scene/main/node.h"
 
@@ -96,12 +97,85 @@ class SceneState : public Reference {
 
 	Vector<ConnectionData> connections;
 
-	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, NameMap &name_map, VariantMap &variant_map, NodeMap &node_map, Map<Node *, int> &nodepath_map, Set<Node *> &externalNodes);
+	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, NameMap &name_map, VariantMap &variant_map, NodeMap &node_map, Map<Node *, int> &nodepath_map, Set<Node *> &externalNodes, bool p_children = true);
 	Error _parse_connections(Node *p_owner, Node *p_node, NameMap &name_map, VariantMap &variant_map, NodeMap &node_map, Map<Node *, int> &nodepath_map);
 
 	Error _parse_external_node(Node *node, const String &varName, Variant &nodeValue, bool isWeakRef, Set<Node *> &externalNodes, NameMap &name_map, VariantMap &variant_map, NodeMap &node_map);
-	bool is_property_to_be_saved(Node *node, const PropertyInfo &propertyInfo, String &name, Variant &value, bool &isExternal, bool &isWeakRef);
-	bool is_default_value(const StringName &type, Node *node, const Variant &value, const String &name);
+	// storable property names and their defaults, so packing does not intern
+	// names and query ClassDB and the script for every property of every node
+	struct PropertyDefault {
+		StringName name;
+		Variant value;
+		bool valid;
+		PropertyDefault() { valid = false; }
+	};
+
+	static RWLock *property_cache_lock;
+	static HashMap<StringName, HashMap<String, PropertyDefault> > *class_property_cache;
+	static HashMap<ObjectID, HashMap<StringName, PropertyDefault> > *script_property_cache;
+
+	// how a restore applies a property, resolved once per class
+	struct RestoreSetter {
+		enum Mode {
+			SET_OBJECT, // Object::set, for anything ClassDB has no setter for
+			SET_BIND,
+			SET_NONE, // read-only, Object::set would ignore it too
+		};
+
+		Mode mode;
+		MethodBind *method;
+		int index;
+	};
+
+	static HashMap<StringName, HashMap<StringName, RestoreSetter> > *restore_setter_cache;
+
+	// what the last pack saved for a node with change tracking enabled,
+	// reused as long as the node's change version stays the same
+	// What the last pack of a change tracked node read for one of its
+	// properties, in property list order.
+	struct TrackedProperty {
+		StringName property;
+		bool script_variable;
+		bool saved;
+		bool reread; // node paths, and script containers changed in place
+		Variant value;
+	};
+
+	struct TrackedNodeProperties {
+		uint64_t version;
+		ObjectID script;
+		bool saving; // packs while saving keep more script variables
+		bool reread;
+		Vector<TrackedProperty> properties;
+	};
+
+	static HashMap<ObjectID, TrackedNodeProperties> *tracked_node_cache;
+	static uint32_t tracked_node_prune_size;
+
+	static bool _get_tracked_node_properties(Node *p_node, TrackedNodeProperties &r_properties);
+	static void _set_tracked_node_properties(Node *p_node, const TrackedNodeProperties &p_properties);
+
+	// copies of the built-in resources of states written on another thread,
+	// by the id of the resource they were copied from. A later capture reuses
+	// a copy while its resource still has the copied content.
+	static HashMap<ObjectID, Ref<Resource> > *captured_copies;
+	static HashMap<ObjectID, ObjectID> *captured_sources; // copy id to resource id
+	static uint32_t captured_prune_size;
+
+	static Variant _capture_built_in_resources(const Variant &p_value, Map<Ref<Resource>, Ref<Resource> > &r_captured);
+	static bool _is_capture_current(const Ref<Resource> &p_resource, const Ref<Resource> &p_copy, Map<Ref<Resource>, Ref<Resource> > &r_captured);
+	static bool _is_captured_value(const Variant &p_value, const Variant &p_copy, Map<Ref<Resource>, Ref<Resource> > &r_captured);
+	static void _prune_captured_copies();
+
+	static RestoreSetter _get_restore_setter(const StringName &p_class, const StringName &p_property);
+	static void _restore_property(Node *p_node, const StringName &p_property, const Variant &p_value);
+
+	static PropertyDefault _get_class_property_default(const StringName &p_type, const String &p_name);
+	static PropertyDefault _get_script_property_default(const Ref<Script> &p_script, const StringName &p_name);
+	void _reset_unsaved_properties(Node *p_node, const NodeData &p_data) const;
+
+	bool is_property_to_be_saved(Node *node, const PropertyInfo &propertyInfo, const StringName &propertyName, String &name, Variant &value, bool &isExternal, bool &isWeakRef);
+	bool is_default_value(const PropertyDefault &classDefault, Node *node, const Variant &value);
 	bool is_property_value_to_be_saved(List<PackState>& pack_state_stack, const PropertyInfo &propertyInfo, const Variant &value, bool isDefault);
 
 	String path;
@@ -111,12 +185,47 @@ class SceneState : public Reference {
 	_FORCE_INLINE_ Ref<SceneState> _get_base_scene_state() const;
 
 	static bool disable_placeholders;
+	static bool parallel_pack;
+
+	// A child subtree of the packed root, parsed into its own state and
+	// tables. Its node 0 stands in for the root.
+	struct SubtreePack {
+		Node *node;
+		Ref<SceneState> state;
+		NameMap name_map;
+		VariantMap variant_map;
+		NodeMap node_map;
+		Map<Node *, int> nodepath_map;
+		Error error;
+	};
+
+	struct ParallelPack {
+		Node *owner;
+		int parent;
+		SubtreePack *subtrees;
+		const uint32_t *threaded; // the subtrees without scripts, by thread index
+	};
+
+	Mutex *pack_lock; // shared by the subtree states of a parallel pack
+
+	void _parse_subtree(uint32_t p_index, ParallelPack *p_pack);
+	Error _parse_children_parallel(Node *p_owner, int p_parent_idx, NameMap &name_map, VariantMap &variant_map, NodeMap &node_map, Map<Node *, int> &nodepath_map);
 
 	PoolVector<String> _get_node_groups(int p_idx) const;
 
 	int _find_base_scene_node_remap_key(int p_idx) const;
 
-	void injectTichRefProperty(Variant &retVariant, String path, const Vector<Node *> &externalNodes, const Node *root) const;
+	void injectTichRefProperty(Variant &retVariant, String path, const Vector<Node *> &externalNodes, const Node *root, const Map<String, Node *> *detachedNodes = NULL) const;
+	Variant _resolve_tich_refs(const Variant &p_value, const Vector<Node *> &externalNodes, const Node *root, const Map<String, Node *> *detachedNodes = NULL) const;
+
+	enum {
+		DELTA_VERSION = 1,
+		DELTA_HEADER = 1,
+		DELTA_GROUPS = 2,
+	};
+
+	void _get_node_keys(Vector<String> &r_keys) const;
+	bool _is_node_header_equal(const NodeData &p_node, const SceneState &p_base, const NodeData &p_base_node, const Vector<int> &p_base_to_new) const;
 
 protected:
 	static void _bind_methods();
@@ -137,6 +246,13 @@ public:
 
 	static void set_disable_placeholders(bool p_disable);
 
+	static void set_parallel_pack(bool p_enable);
+	static bool is_parallel_pack();
+
+	static void init_property_cache();
+	static void finish_property_cache();
+	static void clear_property_cache();
+
 	int find_node_by_path(const NodePath &p_node) const;
 	Variant get_property_value(int p_node, const StringName &p_property, bool &found) const;
 	bool is_node_in_group(int p_node, const StringName &p_group) const;
@@ -155,6 +271,9 @@ public:
 	bool can_instance() const;
 	Node *instance(GenEditState p_edit_state) const;
 
+	bool can_restore_in_place(const Node *p_root) const;
+	Error restore_in_place(Node *p_root) const;
+
 	//unbuild API
 
 	int get_node_count() const;
@@ -197,6 +316,16 @@ public:
 	void add_connection(int p_from, int p_to, int p_signal, int p_method, int p_flags, const Vector<int> &p_binds);
 	void add_editable_instance(const NodePath &p_path);
 
+	//delta API, used for incremental snapshots
+
+	Dictionary get_delta(const Ref<SceneState> &p_base) const;
+	Error apply_delta(const Ref<SceneState> &p_base, const Dictionary &p_delta);
+
+	void make_variants_unique();
+	// The resource a built-in resource of a state made unique was copied
+	// from, or p_copy itself.
+	static ObjectID get_captured_source(ObjectID p_copy);
+
 	virtual void set_last_modified_time(uint64_t p_time) { last_modified_time = p_time; }
 	uint64_t get_last_modified_time() const { return last_modified_time; }
 